@@ -0,0 +1,147 @@
+#include "asset_archive.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+    uint64_t alignUp(uint64_t value) {
+        return (value + ASSET_ARCHIVE_ALIGNMENT - 1) & ~(ASSET_ARCHIVE_ALIGNMENT - 1);
+    }
+}
+
+bool AssetArchive::open(const std::string& path, const std::string& rootDir) {
+    close();
+    if (!m_file.open(path)) {
+        return false;
+    }
+
+    const uint8_t* file = m_file.data();
+    const uint64_t fileSize = m_file.size();
+    AssetArchiveHeader header{};
+    if (fileSize < sizeof(header)) {
+        close();
+        return false;
+    }
+    memcpy(&header, file, sizeof(header));
+    const uint64_t namesOffset = sizeof(header) + uint64_t(header.entryCount) * sizeof(AssetArchiveEntry);
+    if (header.magic != ASSET_ARCHIVE_MAGIC || header.version != ASSET_ARCHIVE_VERSION ||
+        namesOffset + header.nameTableSize > fileSize) {
+        close();
+        return false;
+    }
+
+    m_entries.resize(header.entryCount);
+    memcpy(m_entries.data(), file + sizeof(header), sizeof(AssetArchiveEntry) * m_entries.size());
+    for (const AssetArchiveEntry& entry : m_entries) {
+        if (uint64_t(entry.nameOffset) + entry.nameSize > header.nameTableSize ||
+            entry.offset > fileSize || entry.size > fileSize - entry.offset) {
+            close();
+            return false;
+        }
+    }
+    m_names = reinterpret_cast<const char*>(file + namesOffset);
+    m_rootDir = rootDir;
+    return true;
+}
+
+void AssetArchive::close() {
+    m_entries.clear();
+    m_names = nullptr;
+    m_rootDir.clear();
+    m_file.close();
+}
+
+bool AssetArchive::find(const std::string& path, AssetData& asset) const {
+    if (!isOpen()) {
+        return false;
+    }
+    std::string_view name = path;
+    if (!m_rootDir.empty() && name.size() > m_rootDir.size() && name.compare(0, m_rootDir.size(), m_rootDir) == 0 &&
+        (name[m_rootDir.size()] == '/' || name[m_rootDir.size()] == '\\')) {
+        name.remove_prefix(m_rootDir.size() + 1);
+    }
+
+    // 索引表按名称排序，二分查找
+    auto entryName = [this](const AssetArchiveEntry& entry) { return std::string_view(m_names + entry.nameOffset, entry.nameSize); };
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), name,
+        [&](const AssetArchiveEntry& entry, std::string_view value) { return entryName(entry) < value; });
+    if (it == m_entries.end() || entryName(*it) != name) {
+        return false;
+    }
+    asset.data = m_file.data() + it->offset;
+    asset.size = static_cast<size_t>(it->size);
+    asset.storage.clear();
+    return true;
+}
+
+void AssetArchive::load(const std::string& path, AssetData& asset) const {
+    if (find(path, asset)) {
+        return;
+    }
+    std::ifstream file(path, std::ios::ate | std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file!");
+    }
+    asset.storage.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(asset.storage.data()), asset.storage.size());
+    asset.data = asset.storage.data();
+    asset.size = asset.storage.size();
+}
+
+void AssetArchiveWriter::addEntry(const std::string& name, const void* data, uint64_t size) {
+    for (PendingEntry& entry : m_entries) {
+        if (entry.name == name) {
+            entry.data = data;
+            entry.size = size;
+            return;
+        }
+    }
+    m_entries.push_back({ name, data, size });
+}
+
+bool AssetArchiveWriter::write(const std::string& path) const {
+    std::vector<const PendingEntry*> sorted;
+    for (const PendingEntry& entry : m_entries) {
+        sorted.push_back(&entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const PendingEntry* a, const PendingEntry* b) { return a->name < b->name; });
+
+    std::string names;
+    std::vector<AssetArchiveEntry> table(sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        table[i].nameOffset = static_cast<uint32_t>(names.size());
+        table[i].nameSize = static_cast<uint32_t>(sorted[i]->name.size());
+        names += sorted[i]->name;
+    }
+
+    AssetArchiveHeader header{};
+    header.magic = ASSET_ARCHIVE_MAGIC;
+    header.version = ASSET_ARCHIVE_VERSION;
+    header.entryCount = static_cast<uint32_t>(table.size());
+    header.nameTableSize = static_cast<uint32_t>(names.size());
+
+    uint64_t offset = alignUp(sizeof(header) + sizeof(AssetArchiveEntry) * table.size() + names.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        table[i].offset = offset;
+        table[i].size = sorted[i]->size;
+        offset = alignUp(offset + sorted[i]->size);
+    }
+
+    // 归档只由离线工具生成，整个文件先在内存中拼好再一次写出
+    std::vector<uint8_t> archive(static_cast<size_t>(offset), 0);
+    memcpy(archive.data(), &header, sizeof(header));
+    if (!table.empty()) {
+        memcpy(archive.data() + sizeof(header), table.data(), sizeof(AssetArchiveEntry) * table.size());
+    }
+    memcpy(archive.data() + sizeof(header) + sizeof(AssetArchiveEntry) * table.size(), names.data(), names.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        if (sorted[i]->size != 0) {
+            memcpy(archive.data() + table[i].offset, sorted[i]->data, static_cast<size_t>(sorted[i]->size));
+        }
+    }
+    return writeFileAtomically(path, archive.data(), archive.size());
+}
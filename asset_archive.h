@@ -0,0 +1,78 @@
+#ifndef ASSET_ARCHIVE_H
+#define ASSET_ARCHIVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mesh_cache.h"
+
+// 资源归档文件布局：
+//   AssetArchiveHeader | AssetArchiveEntry[entryCount]（按名称排序） | 名称表 | 按 ASSET_ARCHIVE_ALIGNMENT 对齐的数据块...
+// 名称是相对资源根目录的路径（如 shaders/frag.spv），由asset_baker离线打包。
+// 运行时映射整个归档，查找结果直接指向映射内存，不做任何拷贝
+constexpr uint32_t ASSET_ARCHIVE_MAGIC = makeFourCC('K', 'V', 'A', 'A');
+constexpr uint32_t ASSET_ARCHIVE_VERSION = 1;
+constexpr uint64_t ASSET_ARCHIVE_ALIGNMENT = 64;
+
+struct AssetArchiveHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t nameTableSize;
+};
+
+struct AssetArchiveEntry {
+    uint32_t nameOffset; // 相对名称表起点
+    uint32_t nameSize;
+    uint64_t offset;     // 相对文件起点
+    uint64_t size;
+};
+
+// 一个资源的内容：指向映射的归档，或者指向storage中从散文件读入的数据
+struct AssetData {
+    const uint8_t*       data { nullptr };
+    size_t               size { 0 };
+    std::vector<uint8_t> storage;
+};
+
+class AssetArchive {
+public:
+    // 映射归档并校验魔数、版本与索引表；rootDir用于把完整路径转换为归档中的名称
+    bool open(const std::string& path, const std::string& rootDir);
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+    size_t entryCount() const { return m_entries.size(); }
+
+    // path可以是名称，也可以是rootDir下的完整路径。找到时asset指向映射内存
+    bool find(const std::string& path, AssetData& asset) const;
+    // 先在归档中查找，找不到（或归档未打开）时把散文件读入asset.storage，文件不存在时抛出异常
+    void load(const std::string& path, AssetData& asset) const;
+
+private:
+    std::string                    m_rootDir;
+    MappedFile                     m_file;
+    const char*                    m_names { nullptr };
+    std::vector<AssetArchiveEntry> m_entries;
+};
+
+class AssetArchiveWriter {
+public:
+    // 数据在write()之前必须保持有效，同名资源只保留最后一次添加的
+    void addEntry(const std::string& name, const void* data, uint64_t size);
+
+    // 先写入临时文件再重命名
+    bool write(const std::string& path) const;
+
+private:
+    struct PendingEntry {
+        std::string name;
+        const void* data;
+        uint64_t    size;
+    };
+    std::vector<PendingEntry> m_entries;
+};
+
+#endif // ASSET_ARCHIVE_H
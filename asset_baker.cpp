@@ -0,0 +1,87 @@
+// 资源打包工具：把编译好的SPIR-V、烘焙好的网格缓存与KTX2纹理打包为一个资源归档。
+// 用法：asset_baker <归档路径> <资源根目录>
+// 网格缓存与KTX2纹理由main首次运行时烘焙（缓存未命中时生成），打包前需要先运行一次main
+// 缓存文件头部记录了烘焙时源文件与烘焙选项的哈希，原样打包后运行时据此判断归档中的条目是否过期
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "asset_archive.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    // 资源根目录下各子目录中需要打包的文件扩展名
+    struct AssetSource {
+        const char* directory;
+        const char* extension;
+    };
+    constexpr AssetSource ASSET_SOURCES[] = {
+        { "shaders",  ".spv" },
+        { "models",   ".meshcache" },
+        { "textures", ".ktx2" },
+    };
+}
+
+int main(int argc, const char* argv[]) {
+    if (argc != 3) {
+        fmt::println("usage: asset_baker <archive> <asset root>");
+        return EXIT_FAILURE;
+    }
+    const std::string archivePath = argv[1];
+    const fs::path root = argv[2];
+
+    try {
+        std::vector<std::string> names;
+        for (const AssetSource& source : ASSET_SOURCES) {
+            const fs::path directory = root / source.directory;
+            size_t found = 0;
+            if (fs::is_directory(directory)) {
+                for (const fs::directory_entry& entry : fs::directory_iterator(directory)) {
+                    if (entry.is_regular_file() && entry.path().extension() == source.extension) {
+                        // 归档中的名称统一使用'/'分隔
+                        names.push_back(entry.path().lexically_relative(root).generic_string());
+                        ++found;
+                    }
+                }
+            }
+            if (found == 0) {
+                fmt::println("warning: no {} files under {}", source.extension, directory.string());
+            }
+        }
+        std::sort(names.begin(), names.end());
+
+        // 映射文件在写出归档之前保持打开
+        std::vector<MappedFile> files(names.size());
+        AssetArchiveWriter writer;
+        size_t entryCount = 0;
+        uint64_t totalSize = 0;
+        for (size_t i = 0; i < names.size(); ++i) {
+            const std::string path = (root / names[i]).string();
+            if (!files[i].open(path)) {
+                fmt::println("warning: failed to read {}, skipped", path);
+                continue;
+            }
+            writer.addEntry(names[i], files[i].data(), files[i].size());
+            ++entryCount;
+            totalSize += files[i].size();
+            fmt::println("  {:<48} {:>10} bytes", names[i], files[i].size());
+        }
+
+        if (!writer.write(archivePath)) {
+            fmt::println("failed to write asset archive: {}", archivePath);
+            return EXIT_FAILURE;
+        }
+        fmt::println("asset archive {}: {} entries, {} bytes", archivePath, entryCount, totalSize);
+    }
+    catch (const std::exception& e) {
+        fmt::println("{}", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,8 +1,8 @@
+#include <chrono>
 #include <cmath>
 #include <cstdlib>
 #include <cstring>
 #include <cstdint>
-#include <fstream>
 #include <random>
 #include <stdexcept>
 #include <algorithm>
@@ -17,6 +17,13 @@
 #include <GLFW/glfw3.h>
 #include <fmt/format.h>
 #include "glm_api.h" // IWYU pragma: keep
+#include "asset_archive.h"
+#include "cpu_profiler.h"
+#include "frame_benchmark.h"
+#include "gpu_profiler.h"
+#include "memory_telemetry.h"
+#include "pipeline_cache.h"
+#include "upload_context.h"
 
 constexpr uint32_t WIDTH = 800;
 constexpr uint32_t HEIGHT = 600;
@@ -25,10 +32,24 @@ constexpr uint32_t PARTICLE_COUNT = 8192;
 const std::string COMPUTE_SHADER_PATH = PROJECT_ROOT_DIR "/shaders/compute_shader_comp.spv";
 const std::string VERTEX_SHADER_PATH = PROJECT_ROOT_DIR "/shaders/compute_shader_vert.spv";
 const std::string FRAGMENT_SHADER_PATH = PROJECT_ROOT_DIR "/shaders/compute_shader_frag.spv";
+const std::string PIPELINE_CACHE_PATH = PROJECT_ROOT_DIR "/shaders/compute_main.pipelinecache";
+const std::string ASSET_ARCHIVE_PATH = PROJECT_ROOT_DIR "/assets.pak"; // 由asset_baker打包，不存在时读取散文件
 
 constexpr std::uint32_t MAX_FRAMES_IN_FLIGHT = 2; // 并行帧数量
+constexpr VkDeviceSize STAGING_RING_SIZE = 4 * 1024 * 1024; // 上传用的持久映射暂存环形缓冲大小
+constexpr uint32_t GPU_PROFILER_MAX_SCOPES = 8; // 每帧最多的GPU计时范围数
 constexpr std::uint32_t EXPECTED_SWAPCHAIN_IMAGE_COUNT = 3; // 期望的交换链图像数量
 
+// 批量模拟（--batch）：只创建计算设备，对一组粒子数分别连续执行若干步模拟并报告吞吐量
+constexpr uint32_t BATCH_MIN_PARTICLES = 8 * 1024;
+constexpr uint32_t BATCH_MAX_PARTICLES = 64 * 1024 * 1024;
+constexpr uint32_t BATCH_PARTICLE_GROWTH = 8;           // 相邻两档粒子数的倍数
+constexpr uint32_t BATCH_TILE_PARTICLES = 8 * 1024;     // 只上传这么多初始粒子，再在GPU上复制铺满整个缓冲
+constexpr uint32_t BATCH_WARMUP_STEPS = 8;
+constexpr uint32_t BATCH_RANDOM_SEED = 1;               // 固定种子，每次运行的初始粒子完全相同
+constexpr float BATCH_DELTA_TIME = 2.0f * 1000.0f / 60.0f; // 与窗口模式60fps时的deltaTime一致
+const char* const BATCH_SCOPE = "particle batch";
+
 const std::vector<const char*> g_validationLayers = {
     "VK_LAYER_KHRONOS_validation"
 };
@@ -80,6 +101,15 @@ struct SwapChainSupportDetails {
     std::vector<VkPresentModeKHR> presentModes;
 };
 
+struct BatchOptions {
+    uint32_t    stepCount { 100 };
+    uint32_t    minParticles { BATCH_MIN_PARTICLES };
+    uint32_t    maxParticles { BATCH_MAX_PARTICLES };
+    std::string baselinePath;       // 与该基准比较，出现退化时以失败退出
+    std::string saveBaselinePath;   // 把本次结果写为新的基准
+    double      tolerance { 0.10 }; // 允许超出基准的比例
+};
+
 struct UniformBufferObject
 {
     float deltaTime = 1.0f;
@@ -117,6 +147,9 @@ struct Particle
     }
 };
 
+// 每步模拟每个粒子读取并写回position与velocity，color不被计算着色器访问，带宽按这部分有效数据计算
+constexpr VkDeviceSize BATCH_BYTES_PER_UPDATE = 2 * offsetof(Particle, color);
+
 class ComputeShaderApplication
 {
 public:
@@ -127,6 +160,21 @@ public:
         cleanup();
     }
 
+    // 只创建计算设备，不创建窗口、surface与交换链，也不创建图形管线。
+    // 依次对每档粒子数执行stepCount步模拟，报告每秒粒子更新数与达到的带宽。返回false表示相对基准出现性能退化
+    bool runBatch(const BatchOptions& options) {
+        m_batch = true;
+        initVulkan();
+        const bool passed = benchmarkBatch(options);
+        cleanup();
+        return passed;
+    }
+
+    // 退出时把CPU与GPU时间线写为Chrome trace
+    void setTracePath(const std::string& path) {
+        m_tracePath = path;
+    }
+
 private:
     void initWindow() {
         glfwInit();
@@ -144,25 +192,51 @@ private:
     }
 
     void initVulkan() {
+        CpuZone initZone("initVulkan");
+        // 着色器优先从映射的资源归档中读取
+        if (m_assetArchive.open(ASSET_ARCHIVE_PATH, PROJECT_ROOT_DIR)) {
+            fmt::println("asset archive: {} entries from {}", m_assetArchive.entryCount(), ASSET_ARCHIVE_PATH);
+        }
         createInstance();
         setupDebugMessenger();
-        createSurface();
+        if (!m_batch) {
+            createSurface();
+        }
         pickPhysicalDevice();
         createLogicalDevice();
         createVMA();
+        m_uploadContext.create(m_device, m_deviceTable, m_allocator, m_queueFamilyIdx, m_queue, m_queueFamilyIdx, m_queue,
+            STAGING_RING_SIZE);
+        m_memoryTelemetry.track(m_uploadContext.stagingAllocation(), MemoryCategory::Staging, "staging ring");
         createCommandPool();
         createCommandBuffers();
         createComputeCommandBuffers();
-        createSwapChain();
-        createImageViews();
+        if (!m_batch) {
+            createSwapChain();
+            createImageViews();
+        }
         createComputeDescriptorSetLayout();
-        createGraphicsPipeline();
+        m_pipelineCache.create(m_physicalDevice, m_device, m_deviceTable, PIPELINE_CACHE_PATH);
+        if (!m_batch) {
+            createGraphicsPipeline();
+        }
         createComputePipeline();
-        createShaderStorageBuffers();
+        // 批量模式按每档粒子数分别创建粒子缓冲与描述符集
+        if (!m_batch) {
+            createShaderStorageBuffers();
+        }
         createUniformBuffers();
         createDescriptorPool();
-        createComputeDescriptorSets();
+        if (!m_batch) {
+            createComputeDescriptorSets();
+        }
         createSyncObjects();
+        m_gpuProfiler.create(m_physicalDevice, m_device, m_deviceTable, m_queueFamilyIdx, m_batch ? 1 : MAX_FRAMES_IN_FLIGHT,
+            GPU_PROFILER_MAX_SCOPES, m_calibratedTimestamps);
+
+        // 粒子数据在一次提交中上传，第一帧的计算提交之前等待它完成
+        CpuZone zone("waitForUploads");
+        m_uploadContext.wait(m_uploadContext.flush());
     }
 
     void mainLoop() {
@@ -178,6 +252,254 @@ private:
         m_deviceTable.vkDeviceWaitIdle(m_device);
     }
 
+    bool benchmarkBatch(const BatchOptions& options) {
+        VkPhysicalDeviceVulkan13Properties vk13Properties{};
+        vk13Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_PROPERTIES;
+        VkPhysicalDeviceVulkan11Properties vk11Properties{};
+        vk11Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES;
+        vk11Properties.pNext = &vk13Properties;
+        VkPhysicalDeviceProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties.pNext = &vk11Properties;
+        vkGetPhysicalDeviceProperties2(m_physicalDevice, &properties);
+        const VkPhysicalDeviceLimits& limits = properties.properties.limits;
+        // 单个粒子缓冲同时受存储缓冲绑定范围、单次分配与缓冲大小的限制
+        const VkDeviceSize maxBufferSize = std::min({ VkDeviceSize(limits.maxStorageBufferRange),
+            vk11Properties.maxMemoryAllocationSize, vk13Properties.maxBufferSize });
+
+        fmt::println("batch: {}, {} warmup steps, {} measured steps per particle count",
+            properties.properties.deviceName, BATCH_WARMUP_STEPS, options.stepCount);
+
+        UniformBufferObject ubo{};
+        ubo.deltaTime = BATCH_DELTA_TIME;
+        memcpy(m_uniformBufferAllocationInfo[0].pMappedData, &ubo, sizeof(ubo));
+
+        BenchmarkMetrics metrics;
+        fmt::println("{:>10} {:>13} {:>13} {:>16} {:>9}", "particles", "gpu ms/step", "cpu ms/step", "updates/s", "GB/s");
+        for (uint32_t particleCount : batchParticleCounts(options.minParticles, options.maxParticles)) {
+            const VkDeviceSize bufferSize = VkDeviceSize(sizeof(Particle)) * particleCount;
+            if (bufferSize > maxBufferSize) {
+                fmt::println("{:>10} skipped: {} byte buffer exceeds the device limit of {} bytes", particleCount, bufferSize, maxBufferSize);
+                continue;
+            }
+            double gpuMs = 0.0;
+            double cpuMs = 0.0;
+            if (!simulateBatch(particleCount, options.stepCount, limits.maxComputeWorkGroupCount[0], gpuMs, cpuMs)) {
+                fmt::println("{:>10} skipped: out of device memory", particleCount);
+                continue;
+            }
+
+            // 队列族不支持时间戳时用CPU等待提交完成的时间计算吞吐量
+            const double stepMs = (gpuMs > 0.0 ? gpuMs : cpuMs) / options.stepCount;
+            const double updatesPerSecond = particleCount / (stepMs / 1000.0);
+            fmt::println("{:>10} {:>13.4f} {:>13.4f} {:>16.4e} {:>9.2f}", particleCount, gpuMs / options.stepCount,
+                cpuMs / options.stepCount, updatesPerSecond, updatesPerSecond * BATCH_BYTES_PER_UPDATE / 1e9);
+
+            metrics[fmt::format("cpu_{}_step_ms", particleCount)] = cpuMs / options.stepCount;
+            if (gpuMs > 0.0) {
+                metrics[fmt::format("gpu_{}_step_ms", particleCount)] = gpuMs / options.stepCount;
+            }
+        }
+
+        if (!options.saveBaselinePath.empty()) {
+            if (writeBenchmarkBaseline(options.saveBaselinePath, metrics)) {
+                fmt::println("baseline written to {}", options.saveBaselinePath);
+            } else {
+                fmt::println("failed to write baseline: {}", options.saveBaselinePath);
+            }
+        }
+        if (options.baselinePath.empty()) {
+            return true;
+        }
+        BenchmarkMetrics baseline;
+        if (!readBenchmarkBaseline(options.baselinePath, baseline)) {
+            throw std::runtime_error("failed to read benchmark baseline!");
+        }
+        const bool passed = compareWithBaseline(metrics, baseline, options.tolerance);
+        fmt::println("baseline {}: {}", options.baselinePath, passed ? "passed" : "regression");
+        return passed;
+    }
+
+    // 从minParticles开始按BATCH_PARTICLE_GROWTH倍递增，最后一档是maxParticles。
+    // 粒子数取BATCH_TILE_PARTICLES的整数倍，也就是工作组大小的整数倍（着色器不做越界检查）
+    static std::vector<uint32_t> batchParticleCounts(uint32_t minParticles, uint32_t maxParticles) {
+        auto roundToTile = [](uint32_t count) {
+            return std::max(BATCH_TILE_PARTICLES, count / BATCH_TILE_PARTICLES * BATCH_TILE_PARTICLES);
+        };
+        const uint64_t lastCount = roundToTile(maxParticles);
+        std::vector<uint32_t> counts;
+        for (uint64_t count = roundToTile(minParticles); count < lastCount; count *= BATCH_PARTICLE_GROWTH) {
+            counts.push_back(static_cast<uint32_t>(count));
+        }
+        counts.push_back(static_cast<uint32_t>(lastCount));
+        return counts;
+    }
+
+    // 创建一对粒子缓冲并填充初始粒子，预热后在一次提交中执行stepCount步模拟。
+    // gpuMs是这些步的GPU耗时（没有时间戳时为0），cpuMs是从提交到栅栏signal的时间。分配失败时返回false
+    bool simulateBatch(uint32_t particleCount, uint32_t stepCount, uint32_t maxGroupCount, double& gpuMs, double& cpuMs) {
+        const VkDeviceSize bufferSize = VkDeviceSize(sizeof(Particle)) * particleCount;
+
+        VkBufferCreateInfo bufferInfo{};
+        bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+        bufferInfo.size = bufferSize;
+        bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        VmaAllocationCreateInfo allocInfo{};
+        allocInfo.flags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+        allocInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+        std::array<VkBuffer, 2> buffers{};
+        std::array<VmaAllocation, 2> allocations{};
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            if (vmaCreateBuffer(m_allocator, &bufferInfo, &allocInfo, &buffers[i], &allocations[i], nullptr) != VK_SUCCESS) {
+                for (size_t j = 0; j < i; ++j) {
+                    m_memoryTelemetry.untrack(allocations[j]);
+                    vmaDestroyBuffer(m_allocator, buffers[j], allocations[j]);
+                }
+                return false;
+            }
+            m_memoryTelemetry.track(allocations[i], MemoryCategory::Storage, fmt::format("batch particle buffer {}", i));
+        }
+        // 每个粒子数只采样一次，记录峰值并在接近预算时警告
+        m_memoryTelemetry.sample();
+
+        // 两个描述符集交替读写这对缓冲：第0个从buffers[0]读、写入buffers[1]，第1个相反
+        std::array<VkDescriptorSetLayout, 2> layouts;
+        layouts.fill(m_computeDescriptorSetLayout);
+        VkDescriptorSetAllocateInfo setAllocInfo{};
+        setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        setAllocInfo.descriptorPool = m_descriptorPool;
+        setAllocInfo.descriptorSetCount = static_cast<uint32_t>(layouts.size());
+        setAllocInfo.pSetLayouts = layouts.data();
+        std::array<VkDescriptorSet, 2> descriptorSets{};
+        if (m_deviceTable.vkAllocateDescriptorSets(m_device, &setAllocInfo, descriptorSets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate descriptor sets!");
+        }
+        for (size_t i = 0; i < descriptorSets.size(); ++i) {
+            VkDescriptorBufferInfo uniformBufferInfo{ m_uniformBuffers[0], 0, sizeof(UniformBufferObject) };
+            VkDescriptorBufferInfo storageBufferIn{ buffers[i], 0, bufferSize };
+            VkDescriptorBufferInfo storageBufferOut{ buffers[1 - i], 0, bufferSize };
+
+            std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
+            for (uint32_t binding = 0; binding < descriptorWrites.size(); ++binding) {
+                descriptorWrites[binding].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+                descriptorWrites[binding].dstSet = descriptorSets[i];
+                descriptorWrites[binding].dstBinding = binding;
+                descriptorWrites[binding].descriptorCount = 1;
+                descriptorWrites[binding].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            }
+            descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            descriptorWrites[0].pBufferInfo = &uniformBufferInfo;
+            descriptorWrites[1].pBufferInfo = &storageBufferIn;
+            descriptorWrites[2].pBufferInfo = &storageBufferOut;
+            m_deviceTable.vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+        }
+
+        // 只上传一块初始粒子，GPU上按倍增复制铺满buffers[0]，避免大粒子数时经过暂存缓冲上传GB级数据
+        std::default_random_engine rndEngine(BATCH_RANDOM_SEED);
+        const std::vector<Particle> tile = generateParticles(BATCH_TILE_PARTICLES, rndEngine);
+        m_uploadContext.uploadBuffer(buffers[0], 0, tile.data(), sizeof(Particle) * tile.size(),
+            VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
+            VK_ACCESS_2_TRANSFER_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+        m_uploadContext.wait(m_uploadContext.flush());
+
+        VkCommandBuffer commandBuffer = m_computeCommandBuffers[0];
+        VkCommandBufferBeginInfo beginInfo{};
+        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+        m_deviceTable.vkResetCommandBuffer(commandBuffer, 0);
+        m_deviceTable.vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        VkMemoryBarrier2 copyBarrier{};
+        copyBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        copyBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        copyBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        copyBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        copyBarrier.dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+        VkDependencyInfo copyDependency{};
+        copyDependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        copyDependency.memoryBarrierCount = 1;
+        copyDependency.pMemoryBarriers = &copyBarrier;
+        for (VkDeviceSize filled = sizeof(Particle) * tile.size(); filled < bufferSize; filled *= 2) {
+            VkBufferCopy region{ 0, filled, std::min(filled, bufferSize - filled) };
+            m_deviceTable.vkCmdCopyBuffer(commandBuffer, buffers[0], buffers[0], 1, &region);
+            m_deviceTable.vkCmdPipelineBarrier2(commandBuffer, &copyDependency);
+        }
+        recordBatchSteps(commandBuffer, descriptorSets, particleCount, BATCH_WARMUP_STEPS, maxGroupCount);
+        m_deviceTable.vkEndCommandBuffer(commandBuffer);
+        submitBatch(commandBuffer);
+
+        // 预热步数为偶数，计时的第一步仍从buffers[0]读取
+        m_deviceTable.vkResetCommandBuffer(commandBuffer, 0);
+        m_deviceTable.vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        m_gpuProfiler.beginFrame(commandBuffer, 0);
+        const uint32_t batchScope = m_gpuProfiler.beginScope(commandBuffer, BATCH_SCOPE);
+        recordBatchSteps(commandBuffer, descriptorSets, particleCount, stepCount, maxGroupCount);
+        m_gpuProfiler.endScope(commandBuffer, batchScope);
+        m_deviceTable.vkEndCommandBuffer(commandBuffer);
+
+        const auto submitStart = std::chrono::high_resolution_clock::now();
+        {
+            CpuZone zone(BATCH_SCOPE);
+            submitBatch(commandBuffer);
+        }
+        cpuMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - submitStart).count();
+
+        m_gpuProfiler.collect();
+        const std::vector<double> gpuDurations = m_gpuProfiler.scopeDurationsMs(BATCH_SCOPE);
+        gpuMs = m_gpuProfiler.isEnabled() && !gpuDurations.empty() ? gpuDurations.back() : 0.0;
+
+        m_deviceTable.vkFreeDescriptorSets(m_device, m_descriptorPool, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data());
+        for (size_t i = 0; i < buffers.size(); ++i) {
+            m_memoryTelemetry.untrack(allocations[i]);
+            vmaDestroyBuffer(m_allocator, buffers[i], allocations[i]);
+        }
+        return true;
+    }
+
+    // 录制stepCount步模拟，第i步使用descriptorSets[i % 2]。
+    // 每步之前的屏障让上一步（或初始化拷贝）的写入对本步可见，同时保证本步覆盖的缓冲已经被上一步读完
+    void recordBatchSteps(VkCommandBuffer commandBuffer, const std::array<VkDescriptorSet, 2>& descriptorSets,
+                          uint32_t particleCount, uint32_t stepCount, uint32_t maxGroupCount) {
+        VkMemoryBarrier2 barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        barrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+        VkDependencyInfo dependencyInfo{};
+        dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        dependencyInfo.memoryBarrierCount = 1;
+        dependencyInfo.pMemoryBarriers = &barrier;
+
+        // 64M粒子需要262144个工作组，超过maxComputeWorkGroupCount[0]的最低保证65535，用vkCmdDispatchBase分段派发
+        const uint32_t groupCount = particleCount / 256;
+        m_deviceTable.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
+        for (uint32_t step = 0; step < stepCount; ++step) {
+            m_deviceTable.vkCmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+            m_deviceTable.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipelineLayout, 0, 1,
+                &descriptorSets[step % 2], 0, nullptr);
+            for (uint32_t baseGroup = 0; baseGroup < groupCount; baseGroup += maxGroupCount) {
+                m_deviceTable.vkCmdDispatchBase(commandBuffer, baseGroup, 0, 0, std::min(maxGroupCount, groupCount - baseGroup), 1, 1);
+            }
+        }
+    }
+
+    void submitBatch(VkCommandBuffer commandBuffer) {
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = &commandBuffer;
+        if (m_deviceTable.vkQueueSubmit(m_queue, 1, &submitInfo, m_inFlightFences[0]) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit batch command buffer!");
+        }
+        if (m_deviceTable.vkWaitForFences(m_device, 1, &m_inFlightFences[0], VK_TRUE, UINT64_MAX) != VK_SUCCESS) {
+            throw std::runtime_error("failed to wait for fences!");
+        }
+        m_deviceTable.vkResetFences(m_device, 1, &m_inFlightFences[0]);
+    }
+
     void cleanupSwapChain() {
         for (auto imageView : m_swapChainImageViews) {
             m_deviceTable.vkDestroyImageView(m_device, imageView, nullptr);
@@ -189,6 +511,18 @@ private:
     }
 
     void cleanup() {
+        CpuProfiler::printSummary();
+        m_gpuProfiler.printSummary();
+        if (!m_tracePath.empty()) {
+            if (m_gpuProfiler.writeChromeTrace(m_tracePath)) {
+                fmt::println("trace written to {}", m_tracePath);
+            } else {
+                fmt::println("failed to write trace: {}", m_tracePath);
+            }
+        }
+        m_gpuProfiler.destroy();
+        m_memoryTelemetry.printSummary();
+
         for (auto fence : m_inFlightFences) {
             m_deviceTable.vkDestroyFence(m_device, fence, nullptr);
         }
@@ -213,12 +547,14 @@ private:
         m_descriptorPool = VK_NULL_HANDLE;
 
         for (size_t i = 0; i < m_uniformBuffers.size(); i++) {
+            m_memoryTelemetry.untrack(m_uniformBufferAllocations[i]);
             vmaDestroyBuffer(m_allocator, m_uniformBuffers[i], m_uniformBufferAllocations[i]);
         }
         m_uniformBuffers.clear();
         m_uniformBufferAllocations.clear();
 
         for (size_t i = 0; i < m_shaderStorageBuffers.size(); i++) {
+            m_memoryTelemetry.untrack(m_shaderStorageBufferAllocations[i]);
             vmaDestroyBuffer(m_allocator, m_shaderStorageBuffers[i], m_shaderStorageBufferAllocations[i]);
         }
         m_shaderStorageBuffers.clear();
@@ -240,8 +576,19 @@ private:
         m_deviceTable.vkDestroyDescriptorSetLayout(m_device, m_computeDescriptorSetLayout, nullptr);
         m_computeDescriptorSetLayout = VK_NULL_HANDLE;
 
-        cleanupSwapChain();
+        // 写回磁盘，下次启动时管线创建命中缓存
+        m_pipelineCache.destroy();
+        m_assetArchive.close();
+
+        if (!m_batch) {
+            cleanupSwapChain();
+        }
 
+        m_memoryTelemetry.untrack(m_uploadContext.stagingAllocation());
+        m_uploadContext.destroy();
+
+        // 此时所有分配都应已释放，剩下的打印为泄漏
+        m_memoryTelemetry.destroy();
         vmaDestroyAllocator(m_allocator);
         m_allocator = VK_NULL_HANDLE;
 
@@ -254,14 +601,19 @@ private:
             m_debugMessenger = VK_NULL_HANDLE;
         }
 
-        vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
-        m_surface = VK_NULL_HANDLE;
+        if (!m_batch) {
+            vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+            m_surface = VK_NULL_HANDLE;
+        }
 
         vkDestroyInstance(m_instance, nullptr);
         m_instance = VK_NULL_HANDLE;
 
         volkFinalize();
 
+        if (m_batch) {
+            return;
+        }
         glfwDestroyWindow(m_window);
 
         glfwTerminate();
@@ -284,6 +636,7 @@ private:
     }
 
     void createInstance() {
+        CpuZone zone("createInstance");
         VkResult result = volkInitialize();
         if (result != VK_SUCCESS) {
             throw std::runtime_error("failed to initialize volk, error code: " + std::to_string(result));
@@ -309,7 +662,7 @@ private:
         appInfo.apiVersion = VK_API_VERSION_1_3;
 
         uint32_t glfwInstanceExtensionCount = 0;
-        const char** glfwInstanceExtensions = glfwGetRequiredInstanceExtensions(&glfwInstanceExtensionCount);
+        const char** glfwInstanceExtensions = m_batch ? nullptr : glfwGetRequiredInstanceExtensions(&glfwInstanceExtensionCount);
         fmt::println("{} glfw required instance extensions;", glfwInstanceExtensionCount);
         for (uint32_t i = 0; i < glfwInstanceExtensionCount; ++i) {
             fmt::println("\t{}", glfwInstanceExtensions[i]);
@@ -376,6 +729,7 @@ private:
     }
 
     void setupDebugMessenger() {
+        CpuZone zone("setupDebugMessenger");
         if (!g_enableValidationLayers) {
             return;
         }
@@ -389,6 +743,7 @@ private:
     }
 
     void createSurface() {
+        CpuZone zone("createSurface");
         // 手动创建surface
         /*VkWin32SurfaceCreateInfoKHR createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
@@ -406,6 +761,7 @@ private:
     }
 
     void pickPhysicalDevice() {
+        CpuZone zone("pickPhysicalDevice");
         uint32_t deviceCount = 0;
         vkEnumeratePhysicalDevices(m_instance, &deviceCount, nullptr);
         if (deviceCount == 0) {
@@ -426,6 +782,7 @@ private:
     }
 
     void createLogicalDevice() {
+        CpuZone zone("createLogicalDevice");
         auto queueFamilyIndex = findQueueFamilies(m_physicalDevice);
         if (queueFamilyIndex.has_value()) {
             fmt::println("queueFamilyIndex: {}", queueFamilyIndex.value());
@@ -441,10 +798,11 @@ private:
         queueCreateInfo.queueCount = 1;
         queueCreateInfo.pQueuePriorities = &queuePriority;
 
+        // 批量模式只创建计算设备，不启用图形相关的功能与扩展
         VkPhysicalDeviceFeatures2 deviceFeatures2{};
         deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
-        deviceFeatures2.features.samplerAnisotropy = VK_TRUE;
-        deviceFeatures2.features.sampleRateShading = VK_TRUE;
+        deviceFeatures2.features.samplerAnisotropy = m_batch ? VK_FALSE : VK_TRUE;
+        deviceFeatures2.features.sampleRateShading = m_batch ? VK_FALSE : VK_TRUE;
 
         // 启用VK_KHR_buffer_device_address扩展
         VkPhysicalDeviceVulkan12Features vk12Features{};
@@ -456,7 +814,7 @@ private:
         VkPhysicalDeviceVulkan13Features vk13Features{};
         vk13Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
         vk13Features.synchronization2 = VK_TRUE;
-        vk13Features.dynamicRendering = VK_TRUE;
+        vk13Features.dynamicRendering = m_batch ? VK_FALSE : VK_TRUE;
         vk13Features.maintenance4 = VK_TRUE;
 
         // 启用VK_EXT_extended_dynamic_state扩展
@@ -466,9 +824,9 @@ private:
 
         deviceFeatures2.pNext = &vk12Features;
         vk12Features.pNext = &vk13Features;
-        vk13Features.pNext = &extendedDynamicStateFeatures;
+        vk13Features.pNext = m_batch ? nullptr : &extendedDynamicStateFeatures;
 
-        std::vector<const char*> deviceExtensions = g_deviceExtensions;
+        std::vector<const char*> deviceExtensions = m_batch ? std::vector<const char*>() : g_deviceExtensions;
         uint32_t propertiesCount = 0;
         vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &propertiesCount, nullptr);
         std::vector<VkExtensionProperties> properties(propertiesCount);
@@ -487,6 +845,12 @@ private:
         }
 #endif
 
+        // GPU分析器用它把GPU时间戳对齐到CPU时间轴
+        m_calibratedTimestamps = IsExtensionAvailable(m_availableDeviceExtensions, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+        if (m_calibratedTimestamps) {
+            deviceExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+        }
+
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
         createInfo.pNext = &deviceFeatures2;
@@ -506,6 +870,7 @@ private:
     }
 
     void createVMA() {
+        CpuZone zone("createVMA");
         VmaAllocatorCreateInfo allocatorCreateInfo{};
         allocatorCreateInfo.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT |
                                     VMA_ALLOCATOR_CREATE_KHR_MAINTENANCE4_BIT;
@@ -536,9 +901,11 @@ private:
         if (vmaCreateAllocator(&allocatorCreateInfo, &m_allocator) != VK_SUCCESS) {
             throw std::runtime_error("failed to create vulkan memory allocator!");
         }
+        m_memoryTelemetry.create(m_allocator);
     }
 
     void createCommandPool() {
+        CpuZone zone("createCommandPool");
         VkCommandPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
         poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
@@ -550,6 +917,7 @@ private:
     }
 
     void createCommandBuffers() {
+        CpuZone zone("createCommandBuffers");
         m_commandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
         VkCommandBufferAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -563,6 +931,7 @@ private:
     }
 
     void createComputeCommandBuffers() {
+        CpuZone zone("createComputeCommandBuffers");
         m_computeCommandBuffers.resize(MAX_FRAMES_IN_FLIGHT);
         VkCommandBufferAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -576,6 +945,7 @@ private:
     }
 
     void createSwapChain() {
+        CpuZone zone("createSwapChain");
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(m_physicalDevice);
         printSwapChainSupportDetails(swapChainSupport);
         VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
@@ -632,6 +1002,7 @@ private:
     }
 
     void createImageViews() {
+        CpuZone zone("createImageViews");
         m_swapChainImageViews.resize(m_swapChainImages.size());
 
         for (size_t i = 0; i < m_swapChainImages.size(); ++i) {
@@ -640,6 +1011,7 @@ private:
     }
 
     void createComputeDescriptorSetLayout() {
+        CpuZone zone("createComputeDescriptorSetLayout");
         std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
 
         bindings[0].binding = 0;
@@ -671,8 +1043,10 @@ private:
     }
 
     void createGraphicsPipeline() {
-        auto vertShaderCode = readFile(VERTEX_SHADER_PATH);
-        auto fragShaderCode = readFile(FRAGMENT_SHADER_PATH);
+        CpuZone zone("createGraphicsPipeline");
+        AssetData vertShaderCode, fragShaderCode;
+        m_assetArchive.load(VERTEX_SHADER_PATH, vertShaderCode);
+        m_assetArchive.load(FRAGMENT_SHADER_PATH, fragShaderCode);
         VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
         VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
 
@@ -771,9 +1145,11 @@ private:
         pipelineRenderingInfo.depthAttachmentFormat = VK_FORMAT_UNDEFINED;
         pipelineRenderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
 
+        PipelineCreationFeedback feedback(sizeof(shaderStages) / sizeof(shaderStages[0]));
+
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.pNext = &pipelineRenderingInfo;
+        pipelineInfo.pNext = feedback.chain(&pipelineRenderingInfo);
         pipelineInfo.stageCount = sizeof(shaderStages) / sizeof(shaderStages[0]);
         pipelineInfo.pStages = shaderStages;
         pipelineInfo.pVertexInputState = &vertexInputInfo;
@@ -788,15 +1164,17 @@ private:
         pipelineInfo.renderPass = nullptr; // 使用动态渲染，所以这里设为nullptr
         pipelineInfo.subpass = 0; // pipelineInfo.renderPass中subpass的索引
 
-        if (m_deviceTable.vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
+        if (m_deviceTable.vkCreateGraphicsPipelines(m_device, m_pipelineCache.handle(), 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
             throw std::runtime_error("failed to create graphics pipeline!");
         }
+        feedback.print("graphics");
 
         m_deviceTable.vkDestroyShaderModule(m_device, fragShaderModule, nullptr);
         m_deviceTable.vkDestroyShaderModule(m_device, vertShaderModule, nullptr);
     }
 
     void createComputePipeline() {
+        CpuZone zone("createComputePipeline");
         VkPipelineLayoutCreateInfo computePipelineLayoutInfo{};
         computePipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
         computePipelineLayoutInfo.setLayoutCount = 1;
@@ -808,7 +1186,8 @@ private:
             throw std::runtime_error("failed to create compute pipeline layout!");
         }
 
-        auto computeShaderCode = readFile(COMPUTE_SHADER_PATH);
+        AssetData computeShaderCode;
+        m_assetArchive.load(COMPUTE_SHADER_PATH, computeShaderCode);
         VkShaderModule computeShaderModule = createShaderModule(computeShaderCode);
 
         VkPipelineShaderStageCreateInfo computeShaderStageInfo{};
@@ -817,26 +1196,30 @@ private:
         computeShaderStageInfo.module = computeShaderModule;
         computeShaderStageInfo.pName = "main";
 
+        PipelineCreationFeedback feedback(1);
+
         VkComputePipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.pNext = feedback.chain(nullptr);
+        // 批量模式的大粒子数超过单次派发的工作组数上限，用vkCmdDispatchBase分段派发
+        pipelineInfo.flags = m_batch ? VK_PIPELINE_CREATE_DISPATCH_BASE_BIT : 0;
         pipelineInfo.stage = computeShaderStageInfo;
         pipelineInfo.layout = m_computePipelineLayout;
 
-        VkResult result = m_deviceTable.vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_computePipeline);
+        VkResult result = m_deviceTable.vkCreateComputePipelines(m_device, m_pipelineCache.handle(), 1, &pipelineInfo, nullptr, &m_computePipeline);
         m_deviceTable.vkDestroyShaderModule(m_device, computeShaderModule, nullptr);
 
         if (result != VK_SUCCESS) {
             throw std::runtime_error("failed to create compute pipeline!");
         }
+        feedback.print("compute");
     }
 
-    void createShaderStorageBuffers() {
-        // Initialize particles
-        std::default_random_engine rndEngine(static_cast<uint64_t>(time(nullptr)));
+    // Initial particle positions on a circle
+    static std::vector<Particle> generateParticles(uint32_t count, std::default_random_engine& rndEngine) {
         std::uniform_real_distribution rndDist(0.0f, 1.0f);
 
-        // Initial particle positions on a circle
-        std::vector<Particle> particles(PARTICLE_COUNT);
+        std::vector<Particle> particles(count);
         for (auto &particle : particles) {
             float r = 0.25f * sqrtf(rndDist(rndEngine));
             float theta = rndDist(rndEngine) * 2.0f * 3.14159265358979323846f;
@@ -846,12 +1229,16 @@ private:
             particle.velocity = normalize(glm::vec2(x, y)) * 0.00025f;
             particle.color = glm::vec4(rndDist(rndEngine), rndDist(rndEngine), rndDist(rndEngine), 1.0f);
         }
+        return particles;
+    }
+
+    void createShaderStorageBuffers() {
+        CpuZone zone("createShaderStorageBuffers");
+        // Initialize particles
+        std::default_random_engine rndEngine(static_cast<uint64_t>(time(nullptr)));
+        const std::vector<Particle> particles = generateParticles(PARTICLE_COUNT, rndEngine);
 
         VkDeviceSize bufferSize = sizeof(Particle) * PARTICLE_COUNT;
-        VkBuffer stagingBuffer{};
-        VmaAllocation stagingBufferAllocation{};
-        createBufferWithVMA(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, 0, stagingBuffer, stagingBufferAllocation);
-        vmaCopyMemoryToAllocation(m_allocator, particles.data(), stagingBufferAllocation, 0, bufferSize);
 
         m_shaderStorageBuffers.clear();
         m_shaderStorageBufferAllocations.clear();
@@ -864,16 +1251,17 @@ private:
                 0, 0, 0,
                 shaderStorageBuffer,
                 shaderStorageBufferAllocation);
-            copyBuffer(stagingBuffer, shaderStorageBuffer, bufferSize);
+            m_memoryTelemetry.track(shaderStorageBufferAllocation, MemoryCategory::Storage, fmt::format("particle buffer {}", i));
+            m_uploadContext.uploadBuffer(shaderStorageBuffer, 0, particles.data(), bufferSize,
+                VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT,
+                VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT);
             m_shaderStorageBuffers.push_back(shaderStorageBuffer);
             m_shaderStorageBufferAllocations.push_back(shaderStorageBufferAllocation);
         }
-
-        // 释放stagingBuffer
-        vmaDestroyBuffer(m_allocator, stagingBuffer, stagingBufferAllocation);
     }
 
     void createUniformBuffers() {
+        CpuZone zone("createUniformBuffers");
         m_uniformBuffers.clear();
         m_uniformBufferAllocations.clear();
         m_uniformBufferAllocationInfo.clear();
@@ -889,6 +1277,7 @@ private:
                 VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT,
                 0, 0,
                 buffer, bufferAllocation, &bufferAllocationInfo);
+            m_memoryTelemetry.track(bufferAllocation, MemoryCategory::Uniform, fmt::format("uniform buffer {}", i));
             m_uniformBuffers.push_back(buffer);
             m_uniformBufferAllocations.push_back(bufferAllocation);
             m_uniformBufferAllocationInfo.push_back(bufferAllocationInfo);
@@ -896,6 +1285,7 @@ private:
     }
 
     void createDescriptorPool() {
+        CpuZone zone("createDescriptorPool");
         std::array<VkDescriptorPoolSize, 2> poolSizes{};
         poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
         poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
@@ -916,6 +1306,7 @@ private:
     }
 
     void createComputeDescriptorSets() {
+        CpuZone zone("createComputeDescriptorSets");
         std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, m_computeDescriptorSetLayout);
         VkDescriptorSetAllocateInfo allocInfo{};
         allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
@@ -975,6 +1366,7 @@ private:
     }
 
     void createSyncObjects() {
+        CpuZone zone("createSyncObjects");
         // 创建一个timeline semaphore用于图形/计算命令缓冲区之间的同步
         VkSemaphoreTypeCreateInfo timelineCreateInfo{};
         timelineCreateInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
@@ -1009,8 +1401,14 @@ private:
     }
 
     void drawFrame() {
+        CpuZone frameZone("drawFrame");
+        m_memoryTelemetry.update();
         uint32_t imageIndex = -1;
-        VkResult result = m_deviceTable.vkAcquireNextImageKHR(m_device, m_swapChain, UINT64_MAX, VK_NULL_HANDLE, m_inFlightFences[m_frameIndex], &imageIndex);
+        VkResult result = VK_SUCCESS;
+        {
+            CpuZone zone("vkAcquireNextImageKHR");
+            result = m_deviceTable.vkAcquireNextImageKHR(m_device, m_swapChain, UINT64_MAX, VK_NULL_HANDLE, m_inFlightFences[m_frameIndex], &imageIndex);
+        }
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
             recreateSwapChain();
             return;
@@ -1018,7 +1416,11 @@ private:
             throw std::runtime_error("failed to acquire swap chain image!");
         }
 
-        VkResult fenceResult = m_deviceTable.vkWaitForFences(m_device, 1, &m_inFlightFences[m_frameIndex], VK_TRUE, UINT64_MAX);
+        VkResult fenceResult = VK_SUCCESS;
+        {
+            CpuZone zone("vkWaitForFences");
+            fenceResult = m_deviceTable.vkWaitForFences(m_device, 1, &m_inFlightFences[m_frameIndex], VK_TRUE, UINT64_MAX);
+        }
         if (fenceResult != VK_SUCCESS) {
             throw std::runtime_error("failed to wait for fences!");
         }
@@ -1056,6 +1458,7 @@ private:
             computeSubmitInfo.signalSemaphoreCount = 1;
             computeSubmitInfo.pSignalSemaphores = &m_semaphore;
 
+            CpuZone zone("vkQueueSubmit compute");
             if (m_deviceTable.vkQueueSubmit(m_queue, 1, &computeSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
                 throw std::runtime_error("failed to submit compute command buffer!");
             }
@@ -1085,7 +1488,12 @@ private:
             graphicsSubmitInfo.signalSemaphoreCount = 1;
             graphicsSubmitInfo.pSignalSemaphores = &m_semaphore;
 
-            if (m_deviceTable.vkQueueSubmit(m_queue, 1, &graphicsSubmitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            VkResult submitResult = VK_SUCCESS;
+            {
+                CpuZone zone("vkQueueSubmit graphics");
+                submitResult = m_deviceTable.vkQueueSubmit(m_queue, 1, &graphicsSubmitInfo, VK_NULL_HANDLE);
+            }
+            if (submitResult != VK_SUCCESS) {
                 throw std::runtime_error("failed to submit graphics command buffer!");
             }
 
@@ -1097,7 +1505,11 @@ private:
             waitInfo.pValues = &graphicsSignalValue;
 
             // wait for the graphics work to finish before presenting
-            VkResult waitResult = m_deviceTable.vkWaitSemaphores(m_device, &waitInfo, UINT64_MAX);
+            VkResult waitResult = VK_SUCCESS;
+            {
+                CpuZone zone("vkWaitSemaphores");
+                waitResult = m_deviceTable.vkWaitSemaphores(m_device, &waitInfo, UINT64_MAX);
+            }
             if (waitResult != VK_SUCCESS) {
                 throw std::runtime_error("failed to wait for semaphores!");
             }
@@ -1110,7 +1522,11 @@ private:
             presentInfo.pSwapchains = &m_swapChain;
             presentInfo.pImageIndices = &imageIndex;
 
-            VkResult presentResult = m_deviceTable.vkQueuePresentKHR(m_queue, &presentInfo);
+            VkResult presentResult = VK_SUCCESS;
+            {
+                CpuZone zone("vkQueuePresentKHR");
+                presentResult = m_deviceTable.vkQueuePresentKHR(m_queue, &presentInfo);
+            }
             if (presentResult == VK_ERROR_OUT_OF_DATE_KHR || presentResult == VK_SUBOPTIMAL_KHR || m_framebufferResized) {
                 m_framebufferResized = false;
                 recreateSwapChain();
@@ -1123,19 +1539,25 @@ private:
     }
 
     void recordComputeCommandBuffer() {
+        CpuZone zone("recordComputeCommandBuffer");
         auto &commandBuffer = m_computeCommandBuffers[m_frameIndex];
 
         m_deviceTable.vkResetCommandBuffer(commandBuffer, 0);
         VkCommandBufferBeginInfo commandBufferBeginInfo{};
         commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
         m_deviceTable.vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo);
+        // 计算命令缓冲区先于图形命令缓冲区提交，在这里读回并重置该帧的查询池，两个命令缓冲区共用它
+        m_gpuProfiler.beginFrame(commandBuffer, m_frameIndex);
+        const uint32_t dispatchScope = m_gpuProfiler.beginScope(commandBuffer, "particle dispatch");
         m_deviceTable.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipeline);
         m_deviceTable.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_computePipelineLayout, 0, 1, &m_computeDescriptorSets[m_frameIndex], 0, nullptr);
         m_deviceTable.vkCmdDispatch(commandBuffer, PARTICLE_COUNT / 256, 1, 1);
+        m_gpuProfiler.endScope(commandBuffer, dispatchScope);
         m_deviceTable.vkEndCommandBuffer(commandBuffer);
     }
 
     void recordCommandBuffer(uint32_t imageIndex) {
+        CpuZone zone("recordCommandBuffer");
         auto &commandBuffer = m_commandBuffers[m_frameIndex];
 
         m_deviceTable.vkResetCommandBuffer(commandBuffer, 0);
@@ -1206,6 +1628,7 @@ private:
         renderingInfo.pDepthAttachment = nullptr;
         renderingInfo.pStencilAttachment = nullptr;
 
+        const uint32_t renderScope = m_gpuProfiler.beginScope(commandBuffer, "particle rendering");
         m_deviceTable.vkCmdBeginRendering(commandBuffer, &renderingInfo);
         m_deviceTable.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
 
@@ -1230,6 +1653,7 @@ private:
         m_deviceTable.vkCmdDraw(commandBuffer, PARTICLE_COUNT, 1, 0, 0);
 
         m_deviceTable.vkCmdEndRendering(commandBuffer);
+        m_gpuProfiler.endScope(commandBuffer, renderScope);
 
         // After rendering, transition the swapchain image to PRESENT_SRC
         transitionImageLayout2(
@@ -1311,11 +1735,12 @@ private:
         return false;
     }
 
-    VkShaderModule createShaderModule(const std::vector<char>& code) {
+    // 归档中的数据块按64字节对齐，满足pCode的4字节对齐要求
+    VkShaderModule createShaderModule(const AssetData& code) {
         VkShaderModuleCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = code.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+        createInfo.codeSize = code.size;
+        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data);
 
         VkShaderModule shaderModule;
         if (m_deviceTable.vkCreateShaderModule(m_device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
@@ -1421,8 +1846,9 @@ private:
 
         bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-        bool swapChainAdequate = false;
-        if (extensionsSupported) {
+        // 批量模式不需要交换链与图形功能，软件实现（如lavapipe）也可以使用
+        bool swapChainAdequate = m_batch;
+        if (extensionsSupported && !m_batch) {
             SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
             swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
         }
@@ -1431,7 +1857,7 @@ private:
         vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
         return physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_3 && queueFamilyIdx.has_value() && extensionsSupported
-            && swapChainAdequate && (supportedFeatures.samplerAnisotropy == VK_TRUE);
+            && swapChainAdequate && (m_batch || supportedFeatures.samplerAnisotropy == VK_TRUE);
     }
 
     bool checkDeviceExtensionSupport(VkPhysicalDevice device) {
@@ -1440,7 +1866,10 @@ private:
         std::vector<VkExtensionProperties> availableExtensions(extensionCount);
         vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-        std::set<std::string> requiredExtensions(g_deviceExtensions.begin(), g_deviceExtensions.end());
+        std::set<std::string> requiredExtensions;
+        if (!m_batch) {
+            requiredExtensions.insert(g_deviceExtensions.begin(), g_deviceExtensions.end());
+        }
 
         for (const auto& extension : availableExtensions) {
             requiredExtensions.erase(extension.extensionName);
@@ -1455,6 +1884,23 @@ private:
         std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
         vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
 
+        // 批量模式只需要计算队列，优先选择支持时间戳的队列族
+        if (m_batch) {
+            std::optional<uint32_t> computeFamily;
+            for (uint32_t i = 0; i < queueFamilyCount; ++i) {
+                if ((queueFamilies[i].queueFlags & VK_QUEUE_COMPUTE_BIT) == 0) {
+                    continue;
+                }
+                if (queueFamilies[i].timestampValidBits > 0) {
+                    return i;
+                }
+                if (!computeFamily.has_value()) {
+                    computeFamily = i;
+                }
+            }
+            return computeFamily;
+        }
+
         uint32_t i = 0;
         for (const auto& queueFamily : queueFamilies) {
             VkBool32 presentSupport = VK_FALSE;
@@ -1494,22 +1940,6 @@ private:
         return true;
     }
 
-    static std::vector<char> readFile(const std::string& filename) {
-        std::ifstream file(filename, std::ios::ate | std::ios::binary);
-        if (!file.is_open()) {
-            throw std::runtime_error("failed to open file!");
-        }
-
-        size_t fileSize = static_cast<size_t>(file.tellg());
-        std::vector<char> buffer(fileSize);
-
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-
-        file.close();
-        return buffer;
-    }
-
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
         VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
         VkDebugUtilsMessageTypeFlagsEXT messageType,
@@ -1564,50 +1994,6 @@ private:
         return flags;
     }
 
-    VkCommandBuffer beginSingleTimeCommands() {
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool = m_commandPool;
-        allocInfo.commandBufferCount = 1;
-
-        VkCommandBuffer commandBuffer;
-        m_deviceTable.vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer);
-
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-        m_deviceTable.vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-        return commandBuffer;
-    }
-
-    void endSingleTimeCommands(VkCommandBuffer commandBuffer) {
-        m_deviceTable.vkEndCommandBuffer(commandBuffer);
-
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-
-        m_deviceTable.vkQueueSubmit(m_queue, 1, &submitInfo, VK_NULL_HANDLE);
-        m_deviceTable.vkQueueWaitIdle(m_queue);
-
-        m_deviceTable.vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
-    }
-
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkBufferCopy copyRegion{};
-        copyRegion.srcOffset = 0; // Optional
-        copyRegion.dstOffset = 0; // Optional
-        copyRegion.size = size;
-        m_deviceTable.vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-        endSingleTimeCommands(commandBuffer);
-    }
 private:
     GLFWwindow* m_window{ nullptr };
 
@@ -1615,22 +2001,28 @@ private:
 
     VkInstance                   m_instance;
     VkDebugUtilsMessengerEXT     m_debugMessenger;
-    VkSurfaceKHR                 m_surface;
+    VkSurfaceKHR                 m_surface { VK_NULL_HANDLE };
 
     VkPhysicalDevice             m_physicalDevice { VK_NULL_HANDLE };
     VkDevice                     m_device;
     std::vector<VkExtensionProperties> m_availableDeviceExtensions;
+    bool                         m_calibratedTimestamps { false }; // 已启用VK_EXT_calibrated_timestamps
 
     VolkDeviceTable              m_deviceTable;
     VmaAllocator                 m_allocator;
 
     uint32_t                     m_queueFamilyIdx;
     VkQueue                      m_queue;
+    UploadContext                m_uploadContext;
+    MemoryTelemetry              m_memoryTelemetry;
 
     VkCommandPool                m_commandPool;
     std::vector<VkCommandBuffer> m_commandBuffers;
     std::vector<VkCommandBuffer> m_computeCommandBuffers;
 
+    GpuProfiler                  m_gpuProfiler;
+    std::string                  m_tracePath;              // 为空时不导出trace
+
     VkSwapchainKHR               m_swapChain;
     uint32_t                     m_swapChainImageCount { 0 };
     std::vector<VkImage>         m_swapChainImages;
@@ -1638,8 +2030,10 @@ private:
     VkExtent2D                   m_swapChainExtent;
     std::vector<VkImageView>     m_swapChainImageViews;
 
-    VkPipelineLayout             m_pipelineLayout;
-    VkPipeline                   m_graphicsPipeline;
+    AssetArchive                 m_assetArchive;
+    PipelineCache                m_pipelineCache;
+    VkPipelineLayout             m_pipelineLayout { VK_NULL_HANDLE };
+    VkPipeline                   m_graphicsPipeline { VK_NULL_HANDLE };
 
     VkDescriptorSetLayout        m_computeDescriptorSetLayout;
     VkPipelineLayout             m_computePipelineLayout;
@@ -1663,16 +2057,62 @@ private:
     double                       m_lastFrameTime { 0.0 };
 
     bool                         m_framebufferResized { false };
+    bool                         m_batch { false };        // 只做计算的批量模拟，没有窗口、surface与交换链
 
     double                       m_lastTime { 0.0 };
 
 };
 
+// 选项argv[i]的值；选项在最后、缺少值时抛出异常，与未知选项一样以失败退出
+const char* optionValue(int argc, const char* argv[], int i) {
+    if (i + 1 >= argc) {
+        throw std::runtime_error(fmt::format("missing value for option: {}", argv[i]));
+    }
+    return argv[i + 1];
+}
+
 int main(int argc, const char* argv[]) {
     fmt::println("hello vulkan compute shader");
+    CpuProfiler::setThreadName("main");
+    CpuProfiler::setThreadRingCapacity(CpuProfiler::MAIN_THREAD_RING_CAPACITY);
 
     try {
         ComputeShaderApplication app;
+        if (argc > 1 && strcmp(argv[1], "--batch") == 0) {
+            // --batch [--steps N] [--min-particles N] [--max-particles N] [--baseline path] [--save-baseline path]
+            //         [--tolerance x] [--trace path]
+            BatchOptions options;
+            for (int i = 2; i < argc; i += 2) {
+                if (strcmp(argv[i], "--steps") == 0) {
+                    options.stepCount = static_cast<uint32_t>(std::max(1, atoi(optionValue(argc, argv, i))));
+                } else if (strcmp(argv[i], "--min-particles") == 0) {
+                    options.minParticles = static_cast<uint32_t>(std::max(1, atoi(optionValue(argc, argv, i))));
+                } else if (strcmp(argv[i], "--max-particles") == 0) {
+                    options.maxParticles = static_cast<uint32_t>(std::max(1, atoi(optionValue(argc, argv, i))));
+                } else if (strcmp(argv[i], "--baseline") == 0) {
+                    options.baselinePath = optionValue(argc, argv, i);
+                } else if (strcmp(argv[i], "--save-baseline") == 0) {
+                    options.saveBaselinePath = optionValue(argc, argv, i);
+                } else if (strcmp(argv[i], "--tolerance") == 0) {
+                    options.tolerance = atof(optionValue(argc, argv, i));
+                } else if (strcmp(argv[i], "--trace") == 0) {
+                    app.setTracePath(optionValue(argc, argv, i));
+                } else {
+                    fmt::println("unknown option: {}", argv[i]);
+                    return EXIT_FAILURE;
+                }
+            }
+            return app.runBatch(options) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        // [--trace path]
+        for (int i = 1; i < argc; i += 2) {
+            if (strcmp(argv[i], "--trace") == 0) {
+                app.setTracePath(optionValue(argc, argv, i));
+            } else {
+                fmt::println("unknown option: {}", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
         app.run();
     } catch (const std::exception& e) {
         fmt::println("error: {}", e.what());
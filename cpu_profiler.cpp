@@ -0,0 +1,166 @@
+#include "cpu_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <set>
+
+#include <fmt/format.h>
+
+namespace {
+    static_assert((CpuProfiler::RING_CAPACITY & (CpuProfiler::RING_CAPACITY - 1)) == 0, "ring capacity must be a power of two");
+    static_assert((CpuProfiler::MAIN_THREAD_RING_CAPACITY & (CpuProfiler::MAIN_THREAD_RING_CAPACITY - 1)) == 0,
+        "ring capacity must be a power of two");
+
+    struct RawZone {
+        const char* name;
+        uint64_t    begin;
+        uint64_t    end;
+    };
+
+    // 只有所属线程写入：先写记录再以release递增head，读取方以acquire读取head。zones在第一次记录时分配
+    struct ThreadRing {
+        std::unique_ptr<RawZone[]> zones;
+        uint32_t                   capacity { CpuProfiler::RING_CAPACITY };
+        std::atomic<uint64_t>      head { 0 };
+        std::string                name;
+    };
+
+    // 计数器读数与steady_clock纳秒数的对应点
+    struct ClockSample {
+        uint64_t ticks;
+        int64_t  ns;
+    };
+
+    ClockSample sampleClock() {
+        const uint64_t ticks = CpuProfiler::now();
+        const int64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+        return { ticks, ns };
+    }
+
+    struct Registry {
+        std::mutex                               mutex;
+        std::vector<std::unique_ptr<ThreadRing>> rings; // 线程结束后缓冲仍然保留，退出前还要导出
+        std::set<std::string>                    names;
+        ClockSample                              start { sampleClock() };
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    thread_local ThreadRing* t_ring = nullptr;
+
+    ThreadRing& threadRing() {
+        if (t_ring == nullptr) {
+            Registry& reg = registry();
+            std::lock_guard<std::mutex> lock(reg.mutex);
+            reg.rings.push_back(std::make_unique<ThreadRing>());
+            t_ring = reg.rings.back().get();
+        }
+        return *t_ring;
+    }
+
+    // 在注册表的锁内替换，读取方不会看到分配到一半的缓冲
+    void allocateZones(ThreadRing& ring, uint32_t capacity) {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        ring.zones = std::make_unique<RawZone[]>(capacity);
+        ring.capacity = capacity;
+        ring.head.store(0, std::memory_order_release);
+    }
+}
+
+void CpuProfiler::record(const char* name, uint64_t begin, uint64_t end) {
+    ThreadRing& ring = threadRing();
+    if (!ring.zones) {
+        allocateZones(ring, ring.capacity);
+    }
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    ring.zones[head & (ring.capacity - 1)] = { name, begin, end };
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void CpuProfiler::setThreadName(const std::string& name) {
+    ThreadRing& ring = threadRing();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    ring.name = name;
+}
+
+void CpuProfiler::setThreadRingCapacity(uint32_t capacity) {
+    uint32_t rounded = 1;
+    while (rounded < capacity && rounded < (1u << 31)) {
+        rounded <<= 1;
+    }
+    allocateZones(threadRing(), rounded);
+}
+
+const char* CpuProfiler::internName(const std::string& name) {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.names.insert(name).first->c_str();
+}
+
+std::vector<CpuZoneEvent> CpuProfiler::events() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+
+    // 计数器频率用程序启动到现在的两个对应点估计，rdtsc在现代x86上频率恒定
+    const ClockSample now = sampleClock();
+    const double nsPerTick = now.ticks > reg.start.ticks ?
+        static_cast<double>(now.ns - reg.start.ns) / static_cast<double>(now.ticks - reg.start.ticks) : 1.0;
+    auto toNs = [&](uint64_t ticks) {
+        return reg.start.ns + static_cast<int64_t>(static_cast<double>(static_cast<int64_t>(ticks - reg.start.ticks)) * nsPerTick);
+    };
+
+    std::vector<CpuZoneEvent> events;
+    for (uint32_t thread = 0; thread < reg.rings.size(); ++thread) {
+        const ThreadRing& ring = *reg.rings[thread];
+        const uint64_t head = ring.head.load(std::memory_order_acquire);
+        for (uint64_t i = head - std::min<uint64_t>(head, ring.capacity); i < head; ++i) {
+            const RawZone& zone = ring.zones[i & (ring.capacity - 1)];
+            events.push_back({ zone.name, thread, toNs(zone.begin), toNs(zone.end) });
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const CpuZoneEvent& a, const CpuZoneEvent& b) { return a.beginNs < b.beginNs; });
+    return events;
+}
+
+std::vector<std::string> CpuProfiler::threadNames() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::vector<std::string> names;
+    for (size_t i = 0; i < reg.rings.size(); ++i) {
+        names.push_back(reg.rings[i]->name.empty() ? fmt::format("thread {}", i) : reg.rings[i]->name);
+    }
+    return names;
+}
+
+void CpuProfiler::printSummary() {
+    struct Stats {
+        const char* name;
+        uint64_t    count;
+        int64_t     totalNs;
+        int64_t     maxNs;
+    };
+    // 名称可能来自不同的字面量副本，按内容合并
+    std::vector<Stats> stats;
+    for (const CpuZoneEvent& event : events()) {
+        auto it = std::find_if(stats.begin(), stats.end(), [&](const Stats& s) { return strcmp(s.name, event.name) == 0; });
+        if (it == stats.end()) {
+            stats.push_back({ event.name, 0, 0, 0 });
+            it = stats.end() - 1;
+        }
+        const int64_t duration = event.endNs - event.beginNs;
+        ++it->count;
+        it->totalNs += duration;
+        it->maxNs = std::max(it->maxNs, duration);
+    }
+    for (const Stats& s : stats) {
+        fmt::println("cpu {:<24} avg {:.3f} ms, max {:.3f} ms, {} samples", s.name, s.totalNs / 1e6 / s.count, s.maxNs / 1e6, s.count);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef CPU_PROFILER_H
+#define CPU_PROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define CPU_PROFILER_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CPU_PROFILER_RDTSC 1
+#else
+#include <chrono>
+#endif
+
+// 一段已结束的CPU分区，时间是steady_clock的纳秒数，与GpuProfiler的时间轴一致
+struct CpuZoneEvent {
+    const char* name;
+    uint32_t    thread;  // 线程的注册顺序，0是第一个记录分区的线程
+    int64_t     beginNs;
+    int64_t     endNs;
+};
+
+// CPU分区计时：CpuZone构造与析构时各读一次时间戳计数器（x86上是rdtsc，其他平台是steady_clock），
+// 结束时把(名称, 开始, 结束)写入当前线程的环形缓冲。每个线程第一次记录时加锁注册并分配自己的缓冲
+// （只调用setThreadName()的线程不分配），之后只有该线程写入，不加锁也不分配内存；缓冲满后覆盖最早的记录。
+// events()/printSummary()只应在各线程不再记录分区时调用（例如退出前），读取时把计数器换算到steady_clock
+class CpuProfiler {
+public:
+    static constexpr uint32_t RING_CAPACITY = 1 << 12;             // 每个线程默认保留的最近分区数（约96KB），必须是2的幂
+    static constexpr uint32_t MAIN_THREAD_RING_CAPACITY = 1 << 15; // 主线程每帧记录的分区最多，保留更长的历史
+
+    static uint64_t now() {
+#ifdef CPU_PROFILER_RDTSC
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+    // name必须在程序结束前有效
+    static void record(const char* name, uint64_t begin, uint64_t end);
+
+    // 当前线程在trace中显示的名称
+    static void setThreadName(const std::string& name);
+    // 当前线程的缓冲容量，向上取整到2的幂。应在该线程记录第一个分区前调用，之后调用会丢弃已有的记录
+    static void setThreadRingCapacity(uint32_t capacity);
+    // 运行时拼出的名称（如启动任务名）复制一份，相同的名称返回同一个指针，在程序结束前有效
+    static const char* internName(const std::string& name);
+
+    // 所有线程的分区，按开始时间排序
+    static std::vector<CpuZoneEvent> events();
+    // 按注册顺序，没有命名的线程为"thread N"
+    static std::vector<std::string> threadNames();
+
+    // 每个分区名的次数、平均与最大耗时
+    static void printSummary();
+};
+
+// 作用域计时，name必须在程序结束前有效（通常是字符串字面量）
+class CpuZone {
+public:
+    explicit CpuZone(const char* name) : m_name(name), m_begin(CpuProfiler::now()) {}
+    ~CpuZone() { CpuProfiler::record(m_name, m_begin, CpuProfiler::now()); }
+
+    CpuZone(const CpuZone&) = delete;
+    CpuZone& operator=(const CpuZone&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t    m_begin;
+};
+
+#endif // CPU_PROFILER_H
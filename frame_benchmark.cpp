@@ -0,0 +1,133 @@
+#include "frame_benchmark.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include <fmt/format.h>
+
+#include "mesh_cache.h"
+
+namespace {
+    double percentile(const std::vector<double>& sorted, double p) {
+        const size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+
+    bool endsWith(const std::string& value, const char* suffix) {
+        const size_t length = strlen(suffix);
+        return value.size() >= length && value.compare(value.size() - length, length, suffix) == 0;
+    }
+
+    void skipSpaces(const char*& p) {
+        while (isspace(static_cast<unsigned char>(*p))) {
+            ++p;
+        }
+    }
+}
+
+FrameTimeStats computeFrameTimeStats(std::vector<double> samples) {
+    FrameTimeStats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+    std::sort(samples.begin(), samples.end());
+    double total = 0.0;
+    for (double sample : samples) {
+        total += sample;
+    }
+    stats.count = static_cast<uint32_t>(samples.size());
+    stats.avg = total / samples.size();
+    stats.p50 = percentile(samples, 0.50);
+    stats.p99 = percentile(samples, 0.99);
+    stats.max = samples.back();
+    return stats;
+}
+
+void addFrameTimeMetrics(const std::string& prefix, const FrameTimeStats& stats, BenchmarkMetrics& metrics) {
+    metrics[prefix + "_avg_ms"] = stats.avg;
+    metrics[prefix + "_p50_ms"] = stats.p50;
+    metrics[prefix + "_p99_ms"] = stats.p99;
+    metrics[prefix + "_max_ms"] = stats.max;
+}
+
+bool writeBenchmarkBaseline(const std::string& path, const BenchmarkMetrics& metrics) {
+    std::string json = "{";
+    for (const auto& [name, value] : metrics) {
+        json += fmt::format("{}\n  \"{}\": {:.6f}", json.size() > 1 ? "," : "", name, value);
+    }
+    json += "\n}\n";
+    return writeFileAtomically(path, json.data(), json.size());
+}
+
+bool readBenchmarkBaseline(const std::string& path, BenchmarkMetrics& metrics) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    metrics.clear();
+    const char* p = text.c_str();
+    skipSpaces(p);
+    if (*p++ != '{') {
+        return false;
+    }
+    skipSpaces(p);
+    if (*p == '}') {
+        return true;
+    }
+    for (;;) {
+        skipSpaces(p);
+        if (*p++ != '"') {
+            return false;
+        }
+        const char* nameEnd = strchr(p, '"');
+        if (nameEnd == nullptr) {
+            return false;
+        }
+        std::string name(p, nameEnd);
+        p = nameEnd + 1;
+        skipSpaces(p);
+        if (*p++ != ':') {
+            return false;
+        }
+        char* valueEnd = nullptr;
+        const double value = strtod(p, &valueEnd);
+        if (valueEnd == p) {
+            return false;
+        }
+        metrics[name] = value;
+        p = valueEnd;
+        skipSpaces(p);
+        if (*p == '}') {
+            return true;
+        }
+        if (*p++ != ',') {
+            return false;
+        }
+    }
+}
+
+bool compareWithBaseline(const BenchmarkMetrics& metrics, const BenchmarkMetrics& baseline, double tolerance) {
+    bool passed = true;
+    fmt::println("{:<16} {:>12} {:>12} {:>9}", "metric", "current", "baseline", "change");
+    for (const auto& [name, value] : metrics) {
+        auto it = baseline.find(name);
+        if (it == baseline.end()) {
+            fmt::println("{:<16} {:>12.3f} {:>12} {:>9}", name, value, "-", "-");
+            continue;
+        }
+        const double reference = it->second;
+        const double change = reference > 0.0 ? (value - reference) / reference : 0.0;
+        const bool regressed = !endsWith(name, "_max_ms") && value > reference * (1.0 + tolerance);
+        passed = passed && !regressed;
+        fmt::println("{:<16} {:>12.3f} {:>12.3f} {:>+8.1f}%{}", name, value, reference, change * 100.0,
+            regressed ? "  REGRESSION" : "");
+    }
+    return passed;
+}
@@ -0,0 +1,33 @@
+#ifndef FRAME_BENCHMARK_H
+#define FRAME_BENCHMARK_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// 一组帧时间（毫秒）的统计，百分位数取最近秩
+struct FrameTimeStats {
+    uint32_t count { 0 };
+    double   avg { 0.0 };
+    double   p50 { 0.0 };
+    double   p99 { 0.0 };
+    double   max { 0.0 };
+};
+
+FrameTimeStats computeFrameTimeStats(std::vector<double> samples);
+
+// 基准指标按名称保存，例如cpu_avg_ms、gpu_p99_ms
+using BenchmarkMetrics = std::map<std::string, double>;
+
+void addFrameTimeMetrics(const std::string& prefix, const FrameTimeStats& stats, BenchmarkMetrics& metrics);
+
+// 基准文件是一个只含数字值的平铺JSON对象，读取时只支持这种格式
+bool writeBenchmarkBaseline(const std::string& path, const BenchmarkMetrics& metrics);
+bool readBenchmarkBaseline(const std::string& path, BenchmarkMetrics& metrics);
+
+// 打印每个指标与基准的差异。两边都有的指标中，除_max_ms（单帧抖动太大）外，
+// 任何一个超过基准的(1 + tolerance)倍即视为性能退化，返回false
+bool compareWithBaseline(const BenchmarkMetrics& metrics, const BenchmarkMetrics& baseline, double tolerance);
+
+#endif // FRAME_BENCHMARK_H
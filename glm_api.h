@@ -6,6 +6,7 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtx/hash.hpp>
+#include <glm/gtc/packing.hpp>
 
 namespace glm
 {
@@ -0,0 +1,284 @@
+#include "gpu_profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "cpu_profiler.h"
+#include "mesh_cache.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace {
+    // 超过后不再记录，约为60帧/秒下半小时的事件量
+    constexpr size_t MAX_TRACE_EVENTS = size_t(1) << 20;
+
+    // steady_clock在Windows上基于QueryPerformanceCounter，在Linux/macOS上基于CLOCK_MONOTONIC
+#ifdef _WIN32
+    constexpr VkTimeDomainEXT HOST_TIME_DOMAIN = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+#else
+    constexpr VkTimeDomainEXT HOST_TIME_DOMAIN = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+#endif
+}
+
+void GpuProfiler::create(VkPhysicalDevice physicalDevice, VkDevice device, const VolkDeviceTable& deviceTable, uint32_t queueFamilyIdx,
+    uint32_t frameCount, uint32_t maxScopesPerFrame, bool calibratedTimestamps) {
+    m_device = device;
+    m_deviceTable = &deviceTable;
+    m_startNs = toNs(Clock::now());
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+    const uint32_t validBits = queueFamilyIdx < queueFamilyCount ? queueFamilies[queueFamilyIdx].timestampValidBits : 0;
+    if (validBits == 0 || properties.limits.timestampPeriod <= 0.0f) {
+        fmt::println("gpu profiler: queue family {} has no timestamp support, disabled", queueFamilyIdx);
+        return;
+    }
+    m_timestampPeriod = properties.limits.timestampPeriod;
+    m_timestampMask = validBits >= 64 ? UINT64_MAX : (uint64_t(1) << validBits) - 1;
+
+    if (calibratedTimestamps) {
+        uint32_t domainCount = 0;
+        vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(physicalDevice, &domainCount, nullptr);
+        std::vector<VkTimeDomainEXT> domains(domainCount);
+        vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(physicalDevice, &domainCount, domains.data());
+        const bool hasDevice = std::find(domains.begin(), domains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != domains.end();
+        const bool hasHost = std::find(domains.begin(), domains.end(), HOST_TIME_DOMAIN) != domains.end();
+        if (hasDevice && hasHost) {
+            m_hostDomain = HOST_TIME_DOMAIN;
+        }
+    }
+
+    m_maxQueries = maxScopesPerFrame * 2;
+    m_frames.resize(frameCount);
+    for (Frame& frame : m_frames) {
+        VkQueryPoolCreateInfo createInfo{};
+        createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        createInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        createInfo.queryCount = m_maxQueries;
+        if (m_deviceTable->vkCreateQueryPool(m_device, &createInfo, nullptr, &frame.queryPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create timestamp query pool!");
+        }
+        frame.scopes.reserve(maxScopesPerFrame);
+    }
+    m_results.resize(size_t(m_maxQueries) * 2);
+
+    fmt::println("gpu profiler: {} valid timestamp bits, {:.3f} ns per tick, {}", validBits, m_timestampPeriod,
+        m_hostDomain != VK_TIME_DOMAIN_DEVICE_EXT ? "calibrated timestamps" : "approximate CPU alignment");
+}
+
+void GpuProfiler::destroy() {
+    for (Frame& frame : m_frames) {
+        m_deviceTable->vkDestroyQueryPool(m_device, frame.queryPool, nullptr);
+    }
+    m_frames.clear();
+    m_results.clear();
+    m_currentFrame = nullptr;
+    m_device = VK_NULL_HANDLE;
+    m_deviceTable = nullptr;
+}
+
+void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex) {
+    if (!isEnabled()) {
+        return;
+    }
+    Frame& frame = m_frames[frameIndex];
+    readback(frame);
+
+    // 查询在重新写入之前必须重置，vkCmdResetQueryPool不能在渲染过程中录制
+    m_deviceTable->vkCmdResetQueryPool(commandBuffer, frame.queryPool, 0, m_maxQueries);
+    frame.queryCount = 0;
+    frame.scopes.clear();
+    frame.recordCpuNs = toNs(Clock::now());
+    m_currentFrame = &frame;
+}
+
+uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char* name) {
+    if (m_currentFrame == nullptr || m_currentFrame->queryCount + 2 > m_maxQueries) {
+        return INVALID_SCOPE;
+    }
+    Frame& frame = *m_currentFrame;
+    const Scope scope { name, frame.queryCount, frame.queryCount + 1 };
+    frame.queryCount += 2;
+    // ALL_COMMANDS：之前录制的命令全部执行完才写入，相邻范围首尾衔接，不会把上一段的尾巴算进来
+    m_deviceTable->vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, frame.queryPool, scope.beginQuery);
+    frame.scopes.push_back(scope);
+    return static_cast<uint32_t>(frame.scopes.size() - 1);
+}
+
+void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t scope) {
+    if (m_currentFrame == nullptr || scope >= m_currentFrame->scopes.size()) {
+        return;
+    }
+    m_deviceTable->vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT,
+        m_currentFrame->queryPool, m_currentFrame->scopes[scope].endQuery);
+}
+
+void GpuProfiler::collect() {
+    for (Frame& frame : m_frames) {
+        readback(frame);
+        frame.queryCount = 0;
+        frame.scopes.clear();
+    }
+}
+
+std::vector<double> GpuProfiler::scopeDurationsMs(const char* name) const {
+    std::vector<double> durations;
+    for (const TraceEvent& event : m_events) {
+        if (strcmp(event.name, name) == 0) {
+            durations.push_back((event.endNs - event.beginNs) / 1e6);
+        }
+    }
+    return durations;
+}
+
+void GpuProfiler::readback(Frame& frame) {
+    if (frame.queryCount == 0) {
+        return;
+    }
+    // 不带WAIT标志，未完成的查询可用性为0，对应的范围直接丢弃而不是阻塞
+    VkResult result = m_deviceTable->vkGetQueryPoolResults(m_device, frame.queryPool, 0, frame.queryCount,
+        sizeof(uint64_t) * 2 * frame.queryCount, m_results.data(), sizeof(uint64_t) * 2,
+        VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (result != VK_SUCCESS && result != VK_NOT_READY) {
+        return;
+    }
+
+    // GPU与CPU时钟会漂移，每次读回都重新校准
+    if (m_hostDomain != VK_TIME_DOMAIN_DEVICE_EXT) {
+        calibrate();
+    }
+    for (const Scope& scope : frame.scopes) {
+        const uint64_t* begin = &m_results[size_t(scope.beginQuery) * 2];
+        const uint64_t* end = &m_results[size_t(scope.endQuery) * 2];
+        if (begin[1] == 0 || end[1] == 0) {
+            continue;
+        }
+        if (!m_calibrated) {
+            // 没有校准扩展：GPU最早在录制开始之后执行，把第一个时间戳对齐到那一刻
+            m_calibrationTimestamp = begin[0];
+            m_calibrationCpuNs = frame.recordCpuNs;
+            m_calibrated = true;
+        }
+        addEvent(scope.name, gpuToCpuNs(begin[0]), gpuToCpuNs(end[0]));
+    }
+}
+
+bool GpuProfiler::calibrate() {
+    VkCalibratedTimestampInfoEXT infos[2]{};
+    infos[0].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+    infos[1].sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+    infos[1].timeDomain = m_hostDomain;
+    uint64_t timestamps[2] = {};
+    uint64_t maxDeviation = 0;
+    if (m_deviceTable->vkGetCalibratedTimestampsEXT(m_device, 2, infos, timestamps, &maxDeviation) != VK_SUCCESS) {
+        return false;
+    }
+    m_calibrationTimestamp = timestamps[0];
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    QueryPerformanceFrequency(&frequency);
+    const uint64_t ticksPerSecond = static_cast<uint64_t>(frequency.QuadPart);
+    m_calibrationCpuNs = static_cast<int64_t>(timestamps[1] / ticksPerSecond * 1000000000 +
+        timestamps[1] % ticksPerSecond * 1000000000 / ticksPerSecond);
+#else
+    m_calibrationCpuNs = static_cast<int64_t>(timestamps[1]);
+#endif
+    m_calibrated = true;
+    return true;
+}
+
+int64_t GpuProfiler::gpuToCpuNs(uint64_t timestamp) const {
+    const uint64_t delta = (timestamp - m_calibrationTimestamp) & m_timestampMask;
+    int64_t ticks = static_cast<int64_t>(delta);
+    if (m_timestampMask != UINT64_MAX && delta > (m_timestampMask >> 1)) {
+        ticks -= static_cast<int64_t>(m_timestampMask) + 1;
+    }
+    return m_calibrationCpuNs + static_cast<int64_t>(static_cast<double>(ticks) * m_timestampPeriod);
+}
+
+void GpuProfiler::addEvent(const char* name, int64_t beginNs, int64_t endNs) {
+    if (m_events.size() >= MAX_TRACE_EVENTS) {
+        ++m_droppedEvents;
+        return;
+    }
+    m_events.push_back({ name, beginNs, endNs });
+}
+
+int64_t GpuProfiler::toNs(Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+void GpuProfiler::printSummary() const {
+    struct Stats {
+        const char* name;
+        uint64_t    count;
+        int64_t     totalNs;
+        int64_t     maxNs;
+    };
+    std::vector<Stats> stats;
+    for (const TraceEvent& event : m_events) {
+        auto it = std::find_if(stats.begin(), stats.end(), [&](const Stats& s) {
+            return strcmp(s.name, event.name) == 0;
+        });
+        if (it == stats.end()) {
+            stats.push_back({ event.name, 0, 0, 0 });
+            it = stats.end() - 1;
+        }
+        const int64_t duration = event.endNs - event.beginNs;
+        ++it->count;
+        it->totalNs += duration;
+        it->maxNs = std::max(it->maxNs, duration);
+    }
+    for (const Stats& s : stats) {
+        fmt::println("gpu {:<24} avg {:.3f} ms, max {:.3f} ms, {} samples", s.name,
+            s.totalNs / 1e6 / s.count, s.maxNs / 1e6, s.count);
+    }
+    if (m_droppedEvents > 0) {
+        fmt::println("gpu profiler: {} events dropped after the first {}", m_droppedEvents, MAX_TRACE_EVENTS);
+    }
+}
+
+bool GpuProfiler::writeChromeTrace(const std::string& path) const {
+    const std::vector<CpuZoneEvent> cpuZones = CpuProfiler::events();
+    const std::vector<std::string> threadNames = CpuProfiler::threadNames();
+    // 启动阶段的CPU分区早于分析器创建，时间轴从最早的事件开始
+    int64_t startNs = m_startNs;
+    if (!cpuZones.empty()) {
+        startNs = std::min(startNs, cpuZones.front().beginNs);
+    }
+
+    // Trace Event Format：ph为X的完整事件，ts与dur以微秒为单位。GPU是第一条时间线，每个CPU线程一条。
+    // 名称都是代码中的字符串或启动任务名，不含需要转义的字符
+    constexpr uint32_t GPU_TID = 1;
+    constexpr uint32_t FIRST_CPU_TID = 2;
+    std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    json += fmt::format("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"GPU\"}}}}", GPU_TID);
+    for (uint32_t thread = 0; thread < threadNames.size(); ++thread) {
+        json += fmt::format(",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}",
+            FIRST_CPU_TID + thread, threadNames[thread]);
+    }
+    auto writeEvent = [&](const char* name, uint32_t tid, int64_t beginNs, int64_t endNs) {
+        json += fmt::format(",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+            name, tid, (beginNs - startNs) / 1e3, (endNs - beginNs) / 1e3);
+    };
+    for (const TraceEvent& event : m_events) {
+        writeEvent(event.name, GPU_TID, event.beginNs, event.endNs);
+    }
+    for (const CpuZoneEvent& zone : cpuZones) {
+        writeEvent(zone.name, FIRST_CPU_TID + zone.thread, zone.beginNs, zone.endNs);
+    }
+    json += "\n]}\n";
+    return writeFileAtomically(path, json.data(), json.size());
+}
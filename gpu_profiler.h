@@ -0,0 +1,87 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vk_api.h>
+
+// GPU计时：每个并行帧一个时间戳查询池，在命名范围的两端用vkCmdWriteTimestamp2写入时间戳。
+// 同一帧槽位下一次开始录制时（调用方已经等待过该槽位的栅栏）才读回结果，不等待GPU，结果晚MAX_FRAMES_IN_FLIGHT帧。
+// GPU时间戳换算到CPU的steady_clock时间轴：支持VK_EXT_calibrated_timestamps时每次读回前校准，
+// 否则把第一次读回的第一个时间戳近似对齐到该帧开始录制的CPU时间。
+// GPU范围与CpuProfiler记录的各线程CPU分区一起导出为Chrome trace（chrome://tracing或ui.perfetto.dev打开），时间线并排显示。
+// 除create()外所有函数只在录制命令的线程上调用
+class GpuProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr uint32_t INVALID_SCOPE = UINT32_MAX;
+
+    // calibratedTimestamps表示设备创建时已启用VK_EXT_calibrated_timestamps。
+    // 队列族不支持时间戳时分析器保持禁用，其余调用都是空操作
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, const VolkDeviceTable& deviceTable, uint32_t queueFamilyIdx,
+        uint32_t frameCount, uint32_t maxScopesPerFrame, bool calibratedTimestamps);
+    void destroy();
+
+    bool isEnabled() const { return !m_frames.empty(); }
+
+    // 在该帧第一个命令缓冲区的开头、任何渲染之外调用：读回该槽位上一次的结果并重置查询池
+    void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+    // name必须是静态字符串；查询用完时返回INVALID_SCOPE，endScope忽略它
+    uint32_t beginScope(VkCommandBuffer commandBuffer, const char* name);
+    void endScope(VkCommandBuffer commandBuffer, uint32_t scope);
+
+    // 设备空闲后调用，读回所有尚未读回的帧
+    void collect();
+    // 按时间顺序返回名为name的GPU范围的耗时（毫秒）
+    std::vector<double> scopeDurationsMs(const char* name) const;
+
+    // 每个GPU范围的平均与最大耗时
+    void printSummary() const;
+    bool writeChromeTrace(const std::string& path) const;
+
+private:
+    struct Scope {
+        const char* name;
+        uint32_t    beginQuery;
+        uint32_t    endQuery;
+    };
+    struct Frame {
+        VkQueryPool        queryPool { VK_NULL_HANDLE };
+        uint32_t           queryCount { 0 };
+        int64_t            recordCpuNs { 0 }; // beginFrame时的CPU时间，没有校准扩展时用于近似对齐
+        std::vector<Scope> scopes;
+    };
+    struct TraceEvent {
+        const char* name;
+        int64_t     beginNs;
+        int64_t     endNs;
+    };
+
+    void readback(Frame& frame);
+    bool calibrate();
+    // 时间戳只有m_timestampMask内的位有效并会回绕，先求相对校准点的有符号差值再换算
+    int64_t gpuToCpuNs(uint64_t timestamp) const;
+    void addEvent(const char* name, int64_t beginNs, int64_t endNs);
+    static int64_t toNs(Clock::time_point time);
+
+    VkDevice               m_device { VK_NULL_HANDLE };
+    const VolkDeviceTable* m_deviceTable { nullptr };
+    std::vector<Frame>     m_frames;
+    std::vector<uint64_t>  m_results;                 // 读回用，每个查询一对（时间戳, 可用性）
+    Frame*                 m_currentFrame { nullptr };
+    uint32_t               m_maxQueries { 0 };
+    double                 m_timestampPeriod { 1.0 }; // 每个时间戳计数的纳秒数
+    uint64_t               m_timestampMask { 0 };
+    VkTimeDomainEXT        m_hostDomain { VK_TIME_DOMAIN_DEVICE_EXT }; // 与steady_clock一致的主机时间域，DEVICE表示不可用
+    bool                   m_calibrated { false };
+    uint64_t               m_calibrationTimestamp { 0 };
+    int64_t                m_calibrationCpuNs { 0 };
+    int64_t                m_startNs { 0 };
+    std::vector<TraceEvent> m_events;
+    uint64_t               m_droppedEvents { 0 };
+};
+
+#endif // GPU_PROFILER_H
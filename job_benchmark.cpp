@@ -0,0 +1,222 @@
+// 任务系统微基准：窃取与唤醒延迟、spawn开销，以及不同线程数下fan-out/fan-in的吞吐量与扩展性。
+// 用法：job_benchmark [--threads N] [--items N] [--baseline path] [--save-baseline path] [--tolerance x]
+// 所有指标都是越小越好，基准文件格式与frame_benchmark相同；与基准比较时只检查fanout_*_ns_per_item
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "cpu_profiler.h"
+#include "frame_benchmark.h"
+#include "job_system.h"
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t LATENCY_SAMPLES = 10000;     // 连续提交，工作线程处于自旋状态
+    constexpr uint32_t WAKE_SAMPLES = 200;          // 每次提交前等工作线程休眠
+    constexpr auto     WAKE_IDLE_TIME = std::chrono::milliseconds(2);
+    constexpr uint32_t SPAWN_JOB_COUNT = 1 << 18;   // 空任务数
+    constexpr uint32_t FANOUT_GRAIN = 256;          // fan-out每个任务处理的元素数
+    constexpr uint32_t FANOUT_REPEATS = 8;
+    constexpr uint32_t ITEM_WORK_ROUNDS = 64;       // 每个元素的计算量，约几十纳秒
+
+    struct Options {
+        uint32_t    maxThreads { std::max(1u, std::thread::hardware_concurrency()) };
+        uint32_t    itemCount { 1 << 20 };
+        std::string baselinePath;
+        std::string saveBaselinePath;
+        double      tolerance { 0.10 };
+    };
+
+    double elapsedNs(Clock::time_point begin, Clock::time_point end) {
+        return std::chrono::duration<double, std::nano>(end - begin).count();
+    }
+
+    // 主线程提交一个空任务后只自旋不参与执行，任务只能被工作线程窃取；测量从提交到任务开始执行的时间（微秒）
+    std::vector<double> measureStealLatency(JobSystem& jobs, uint32_t sampleCount, Clock::duration idleTime) {
+        std::vector<double> samples;
+        samples.reserve(sampleCount);
+        for (uint32_t i = 0; i < sampleCount; ++i) {
+            if (idleTime > Clock::duration::zero()) {
+                std::this_thread::sleep_for(idleTime);
+            }
+            std::atomic<int64_t> startNs { 0 };
+            JobCounter counter;
+            const Clock::time_point begin = Clock::now();
+            jobs.spawn([&startNs]() { startNs.store(Clock::now().time_since_epoch().count(), std::memory_order_release); }, &counter);
+            // 线程数多于核心数时让出核心，否则自旋的主线程会推迟工作线程
+            while (startNs.load(std::memory_order_acquire) == 0) {
+                std::this_thread::yield();
+            }
+            jobs.wait(counter);
+            const Clock::time_point start { Clock::duration(startNs.load()) };
+            samples.push_back(elapsedNs(begin, start) / 1000.0);
+        }
+        return samples;
+    }
+
+    // 从主线程提交大量空任务后等待，平均每个任务的提交、调度与执行开销（纳秒）
+    double measureSpawnCost(JobSystem& jobs) {
+        JobCounter counter;
+        const Clock::time_point begin = Clock::now();
+        for (uint32_t i = 0; i < SPAWN_JOB_COUNT; ++i) {
+            jobs.spawn([]() {}, &counter);
+        }
+        jobs.wait(counter);
+        return elapsedNs(begin, Clock::now()) / SPAWN_JOB_COUNT;
+    }
+
+    // parallelFor拆分成itemCount / FANOUT_GRAIN个任务，每个元素做固定的整数运算，等全部完成；返回每个元素的耗时（纳秒）
+    double measureFanOut(JobSystem& jobs, uint32_t itemCount, uint64_t& checksum) {
+        std::vector<uint64_t> results(itemCount);
+        double bestNs = 0.0;
+        for (uint32_t repeat = 0; repeat < FANOUT_REPEATS; ++repeat) {
+            JobCounter counter;
+            const Clock::time_point begin = Clock::now();
+            jobs.parallelFor(itemCount, FANOUT_GRAIN, [&results](uint32_t first, uint32_t count) {
+                for (uint32_t i = first; i < first + count; ++i) {
+                    uint64_t x = i + 1;
+                    for (uint32_t round = 0; round < ITEM_WORK_ROUNDS; ++round) {
+                        x ^= x << 13;
+                        x ^= x >> 7;
+                        x ^= x << 17;
+                    }
+                    results[i] = x;
+                }
+            }, counter);
+            jobs.wait(counter);
+            const double ns = elapsedNs(begin, Clock::now());
+            bestNs = repeat == 0 ? ns : std::min(bestNs, ns);
+        }
+        // 结果参与校验和，避免计算被优化掉，同时检查每个元素都恰好处理过
+        for (uint64_t result : results) {
+            checksum += result;
+        }
+        return bestNs / itemCount;
+    }
+
+    // 1, 2, 4, ... 直到maxThreads，最后一档是maxThreads
+    std::vector<uint32_t> threadCounts(uint32_t maxThreads) {
+        std::vector<uint32_t> counts;
+        for (uint32_t count = 1; count < maxThreads; count *= 2) {
+            counts.push_back(count);
+        }
+        counts.push_back(maxThreads);
+        return counts;
+    }
+
+    // 选项argv[i]的值；选项在最后、缺少值时抛出异常，与未知选项一样以失败退出
+    const char* optionValue(int argc, const char* argv[], int i) {
+        if (i + 1 >= argc) {
+            throw std::runtime_error(fmt::format("missing value for option: {}", argv[i]));
+        }
+        return argv[i + 1];
+    }
+
+    bool runBenchmarks(const Options& options) {
+        BenchmarkMetrics metrics;
+
+        JobSystem jobs;
+        jobs.create(options.maxThreads - 1);
+        if (jobs.workerCount() > 0) {
+            const FrameTimeStats hot = computeFrameTimeStats(measureStealLatency(jobs, LATENCY_SAMPLES, Clock::duration::zero()));
+            const FrameTimeStats cold = computeFrameTimeStats(measureStealLatency(jobs, WAKE_SAMPLES, WAKE_IDLE_TIME));
+            fmt::println("steal latency (spinning workers): avg {:.2f} us, p50 {:.2f} us, p99 {:.2f} us, max {:.2f} us",
+                hot.avg, hot.p50, hot.p99, hot.max);
+            fmt::println("wake latency (sleeping workers):  avg {:.2f} us, p50 {:.2f} us, p99 {:.2f} us, max {:.2f} us",
+                cold.avg, cold.p50, cold.p99, cold.max);
+            metrics["steal_p50_us"] = hot.p50;
+            metrics["steal_p99_us"] = hot.p99;
+            metrics["wake_p50_us"] = cold.p50;
+            metrics["wake_p99_us"] = cold.p99;
+        }
+        const double spawnNs = measureSpawnCost(jobs);
+        fmt::println("spawn + run of {} empty jobs: {:.1f} ns per job", SPAWN_JOB_COUNT, spawnNs);
+        metrics["spawn_ns_per_job"] = spawnNs;
+        jobs.destroy();
+
+        fmt::println("fan-out/fan-in over {} items, {} items per job", options.itemCount, FANOUT_GRAIN);
+        fmt::println("{:>8} {:>12} {:>12} {:>9} {:>11}", "threads", "ms", "ns/item", "speedup", "efficiency");
+        uint64_t referenceChecksum = 0;
+        double singleThreadNs = 0.0;
+        for (uint32_t threadCount : threadCounts(options.maxThreads)) {
+            jobs.create(threadCount - 1);
+            uint64_t checksum = 0;
+            const double itemNs = measureFanOut(jobs, options.itemCount, checksum);
+            jobs.destroy();
+
+            if (threadCount == 1) {
+                referenceChecksum = checksum;
+                singleThreadNs = itemNs;
+            } else if (checksum != referenceChecksum) {
+                throw std::runtime_error("fan-out results differ between thread counts!");
+            }
+            const double speedup = singleThreadNs / itemNs;
+            fmt::println("{:>8} {:>12.3f} {:>12.3f} {:>8.2f}x {:>10.1f}%", threadCount, itemNs * options.itemCount / 1e6, itemNs,
+                speedup, speedup / threadCount * 100.0);
+            metrics[fmt::format("fanout_{}t_ns_per_item", threadCount)] = itemNs;
+        }
+
+        if (!options.saveBaselinePath.empty()) {
+            if (writeBenchmarkBaseline(options.saveBaselinePath, metrics)) {
+                fmt::println("baseline written to {}", options.saveBaselinePath);
+            } else {
+                fmt::println("failed to write baseline: {}", options.saveBaselinePath);
+            }
+        }
+        if (options.baselinePath.empty()) {
+            return true;
+        }
+        BenchmarkMetrics baseline;
+        if (!readBenchmarkBaseline(options.baselinePath, baseline)) {
+            throw std::runtime_error("failed to read benchmark baseline!");
+        }
+        // 延迟与spawn开销受调度抖动影响太大，只写入基准供参考；回归判断只看fan-out吞吐量
+        BenchmarkMetrics gated;
+        for (const auto& [name, value] : metrics) {
+            if (name.compare(0, 7, "fanout_") == 0) {
+                gated[name] = value;
+            }
+        }
+        const bool passed = compareWithBaseline(gated, baseline, options.tolerance);
+        fmt::println("baseline {}: {}", options.baselinePath, passed ? "passed" : "regression");
+        return passed;
+    }
+}
+
+int main(int argc, const char* argv[]) {
+    CpuProfiler::setThreadName("main");
+
+    try {
+        Options options;
+        for (int i = 1; i < argc; i += 2) {
+            if (strcmp(argv[i], "--threads") == 0) {
+                options.maxThreads = static_cast<uint32_t>(std::max(1, atoi(optionValue(argc, argv, i))));
+            } else if (strcmp(argv[i], "--items") == 0) {
+                options.itemCount = static_cast<uint32_t>(std::max(1, atoi(optionValue(argc, argv, i))));
+            } else if (strcmp(argv[i], "--baseline") == 0) {
+                options.baselinePath = optionValue(argc, argv, i);
+            } else if (strcmp(argv[i], "--save-baseline") == 0) {
+                options.saveBaselinePath = optionValue(argc, argv, i);
+            } else if (strcmp(argv[i], "--tolerance") == 0) {
+                options.tolerance = atof(optionValue(argc, argv, i));
+            } else {
+                fmt::println("unknown option: {}", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
+        return runBenchmarks(options) ? EXIT_SUCCESS : EXIT_FAILURE;
+    } catch (const std::exception& e) {
+        fmt::println("error: {}", e.what());
+        return EXIT_FAILURE;
+    }
+}
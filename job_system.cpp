@@ -0,0 +1,282 @@
+#include "job_system.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "cpu_profiler.h"
+
+namespace {
+    // 当前线程所属的调度器与队列，不属于任何调度器的线程使用队列0
+    thread_local const JobSystem* t_system = nullptr;
+    thread_local uint32_t         t_queueIndex = 0;
+
+    uint32_t nextRandom(uint64_t& state) {
+        // xorshift64，只用于选择窃取目标
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return static_cast<uint32_t>(state >> 32);
+    }
+}
+
+JobSystem::~JobSystem() {
+    destroy();
+}
+
+void JobSystem::create(uint32_t workerCount) {
+    if (!m_queues.empty()) {
+        throw std::runtime_error("job system is already created!");
+    }
+    t_system = this;
+    t_queueIndex = 0;
+    m_stopping = false;
+    for (uint32_t i = 0; i <= workerCount; ++i) {
+        m_queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (uint32_t i = 1; i <= workerCount; ++i) {
+        m_workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+void JobSystem::destroy() {
+    if (m_queues.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    // 没有工作线程时剩余的任务在这里执行
+    uint64_t randomState = 0x9e3779b97f4a7c15ull;
+    while (tryRunOne(0, randomState)) {
+    }
+    m_queues.clear();
+    if (t_system == this) {
+        t_system = nullptr;
+    }
+}
+
+void JobSystem::spawn(Job job, JobCounter* counter) {
+    if (counter != nullptr) {
+        counter->m_value.fetch_add(1, std::memory_order_relaxed);
+    }
+    push({ std::move(job), counter });
+}
+
+void JobSystem::spawnAfter(JobCounter& dependency, Job job, JobCounter* counter) {
+    if (counter != nullptr) {
+        counter->m_value.fetch_add(1, std::memory_order_relaxed);
+    }
+    std::exception_ptr dependencyError;
+    {
+        // 与finish()中的归零在同一个锁下判断，不会漏掉后续任务
+        std::lock_guard<std::mutex> lock(dependency.m_mutex);
+        if (dependency.m_value.load(std::memory_order_acquire) != 0) {
+            dependency.m_continuations.push_back({ std::move(job), counter });
+            return;
+        }
+        dependencyError = dependency.m_error;
+    }
+    if (dependencyError) {
+        finish(counter, dependencyError);
+        return;
+    }
+    push({ std::move(job), counter });
+}
+
+void JobSystem::parallelFor(uint32_t count, uint32_t grainSize, const RangeBody& body, JobCounter& counter) {
+    if (count == 0) {
+        return;
+    }
+    auto sharedBody = std::make_shared<const RangeBody>(body);
+    spawn([this, count, grainSize = std::max(1u, grainSize), sharedBody, &counter]() {
+        splitRange(0, count, grainSize, sharedBody, counter);
+    }, &counter);
+}
+
+void JobSystem::splitRange(uint32_t first, uint32_t count, uint32_t grainSize, const std::shared_ptr<const RangeBody>& body,
+    JobCounter& counter) {
+    // 后一半交给其他线程窃取，前一半继续在当前线程上拆分
+    while (count > grainSize) {
+        const uint32_t half = count / 2;
+        spawn([this, first = first + half, count = count - half, grainSize, body, &counter]() {
+            splitRange(first, count, grainSize, body, counter);
+        }, &counter);
+        count = half;
+    }
+    (*body)(first, count);
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    const uint32_t queueIndex = currentQueue();
+    uint64_t randomState = 0x9e3779b97f4a7c15ull + queueIndex;
+    while (!counter.isDone()) {
+        if (!tryRunOne(queueIndex, randomState)) {
+            std::this_thread::yield();
+        }
+    }
+    // 最后一个任务在counter的锁内归零，等它释放锁之后调用方才可以销毁counter
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(counter.m_mutex);
+        error = std::exchange(counter.m_error, nullptr);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void JobSystem::push(Task task) {
+    // 先计数再入队，取出任务时计数不会下溢。与workerLoop中先增加m_sleepingCount再检查m_queuedCount的顺序配合，
+    // 两边至少有一边看到对方，不会在有任务时全部休眠
+    m_queuedCount.fetch_add(1);
+    WorkQueue& queue = *m_queues[currentQueue()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    if (m_sleepingCount.load() > 0) {
+        { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+        m_wake.notify_one();
+    }
+}
+
+bool JobSystem::tryRunOne(uint32_t queueIndex, uint64_t& randomState) {
+    Task task;
+    if (!pop(queueIndex, task) && !steal(queueIndex, randomState, task)) {
+        return false;
+    }
+    run(task);
+    return true;
+}
+
+bool JobSystem::pop(uint32_t queueIndex, Task& task) {
+    WorkQueue& queue = *m_queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty()) {
+        return false;
+    }
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool JobSystem::steal(uint32_t queueIndex, uint64_t& randomState, Task& task) {
+    const uint32_t queueCount = static_cast<uint32_t>(m_queues.size());
+    if (queueCount < 2 || m_queuedCount.load(std::memory_order_relaxed) == 0) {
+        return false;
+    }
+    const uint32_t start = nextRandom(randomState) % queueCount;
+    for (uint32_t i = 0; i < queueCount; ++i) {
+        const uint32_t victim = (start + i) % queueCount;
+        if (victim == queueIndex) {
+            continue;
+        }
+        WorkQueue& queue = *m_queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        m_queuedCount.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void JobSystem::run(Task& task) {
+    std::exception_ptr error;
+    try {
+        task.job();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    task.job = nullptr; // 在计数器归零前释放任务捕获的资源
+    if (error && task.counter == nullptr) {
+        try {
+            std::rethrow_exception(error);
+        } catch (const std::exception& e) {
+            fmt::println("job error: {}", e.what());
+        } catch (...) {
+            fmt::println("job error: unknown exception");
+        }
+    }
+    finish(task.counter, error);
+}
+
+void JobSystem::finish(JobCounter* counter, std::exception_ptr error) {
+    if (counter == nullptr) {
+        return;
+    }
+    if (error) {
+        std::lock_guard<std::mutex> lock(counter->m_mutex);
+        if (!counter->m_error) {
+            counter->m_error = error;
+        }
+    }
+    // 不是最后一个任务时只做原子减法，fan-in时大量任务结束不会争用计数器的锁
+    uint32_t value = counter->m_value.load(std::memory_order_relaxed);
+    while (value > 1) {
+        if (counter->m_value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel)) {
+            return;
+        }
+    }
+    std::vector<JobCounter::Continuation> continuations;
+    std::exception_ptr dependencyError;
+    {
+        std::lock_guard<std::mutex> lock(counter->m_mutex);
+        if (counter->m_value.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            continuations.swap(counter->m_continuations);
+            dependencyError = counter->m_error;
+        }
+    }
+    // 释放锁之后counter可能已被等待方销毁，后续任务只使用它们自己的计数器
+    for (JobCounter::Continuation& continuation : continuations) {
+        if (dependencyError) {
+            // 依赖出错时不执行后续任务，错误沿依赖链传递
+            finish(continuation.counter, dependencyError);
+        } else {
+            push({ std::move(continuation.job), continuation.counter });
+        }
+    }
+}
+
+void JobSystem::workerLoop(uint32_t queueIndex) {
+    t_system = this;
+    t_queueIndex = queueIndex;
+    CpuProfiler::setThreadName(fmt::format("job worker {}", queueIndex));
+    uint64_t randomState = 0x9e3779b97f4a7c15ull * (queueIndex + 1);
+    uint32_t idleCount = 0;
+    while (true) {
+        if (tryRunOne(queueIndex, randomState)) {
+            idleCount = 0;
+            continue;
+        }
+        if (++idleCount < IDLE_SPIN_COUNT && !m_stopping.load(std::memory_order_relaxed)) {
+            std::this_thread::yield();
+            continue;
+        }
+        idleCount = 0;
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_sleepingCount.fetch_add(1);
+        m_wake.wait(lock, [this]() { return m_stopping.load() || m_queuedCount.load() > 0; });
+        m_sleepingCount.fetch_sub(1);
+        if (m_stopping.load() && m_queuedCount.load() == 0) {
+            return;
+        }
+    }
+}
+
+uint32_t JobSystem::currentQueue() const {
+    return t_system == this ? t_queueIndex : 0;
+}
@@ -0,0 +1,110 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 任务计数器：spawn()时加一，任务结束时减一，归零表示这一组任务全部完成。
+// 归零时释放用spawnAfter()挂在它上面的后续任务。这一组任务抛出的第一个异常记录在计数器上，由wait()该计数器时重新抛出。
+// 计数器只能在wait()返回后重新使用或销毁，isDone()只用于轮询
+class JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool isDone() const { return m_value.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    struct Continuation {
+        std::function<void()> job;
+        JobCounter*           counter;
+    };
+
+    std::atomic<uint32_t>     m_value { 0 };
+    std::mutex                m_mutex;         // 保护m_continuations、m_error与归零时的释放
+    std::vector<Continuation> m_continuations;
+    std::exception_ptr        m_error;
+};
+
+// 工作窃取任务调度器：每个线程一个双端队列，线程在自己队列的尾部压入和取出任务（后进先出，缓存局部性好），
+// 空闲时从随机选择的其他队列头部窃取（先进先出，取走最早拆分出的大块工作）。
+// 队列0属于调用create()的线程（主线程），主线程不执行任务，只在wait()中边等待边执行任务；
+// 不属于调度器的线程spawn()时压入队列0。工作线程找不到任务时自旋一段时间后休眠，spawn()时唤醒。
+// 任务的异常只在wait()它的计数器时重新抛出；依赖的计数器出错时后续任务不执行，错误传给后续任务的计数器。
+// 没有计数器的任务抛出的异常无处传递，只打印
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+    using RangeBody = std::function<void(uint32_t first, uint32_t count)>;
+
+    JobSystem() = default;
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+    // 没有调用destroy()时（例如wait()抛出异常后）在这里停止工作线程
+    ~JobSystem();
+
+    // workerCount个工作线程加上主线程，workerCount为0时所有任务在wait()中由主线程执行。已经创建时抛出异常
+    void create(uint32_t workerCount);
+    // 等待所有已提交的任务执行完毕后停止工作线程
+    void destroy();
+
+    uint32_t workerCount() const { return static_cast<uint32_t>(m_workers.size()); }
+    // 当前线程的队列编号：0为调用create()的线程以及不属于调度器的线程，1..N为工作线程
+    uint32_t currentQueue() const;
+
+    // counter可以为空；不为空时在任务结束后减一
+    void spawn(Job job, JobCounter* counter = nullptr);
+    // dependency归零后再提交job，dependency已经归零时立即提交
+    void spawnAfter(JobCounter& dependency, Job job, JobCounter* counter = nullptr);
+    // 把[0, count)分成每块不超过grainSize的连续区间，每块一个任务。区间在任务中递归二分，
+    // 拆分出的任务分散在执行拆分的各个线程的队列中，不会都压在调用线程的队列里
+    void parallelFor(uint32_t count, uint32_t grainSize, const RangeBody& body, JobCounter& counter);
+
+    // 等待counter归零，期间在当前线程上执行任务（工作线程中嵌套等待也不会死锁）
+    void wait(JobCounter& counter);
+
+private:
+    static constexpr uint32_t IDLE_SPIN_COUNT = 256; // 工作线程休眠前尝试取任务的次数
+
+    struct Task {
+        Job         job;
+        JobCounter* counter;
+    };
+    // 队列单独分配并对齐到缓存行，避免相邻队列的锁之间伪共享
+    struct alignas(64) WorkQueue {
+        std::mutex       mutex;
+        std::deque<Task> tasks;
+    };
+
+    void splitRange(uint32_t first, uint32_t count, uint32_t grainSize, const std::shared_ptr<const RangeBody>& body, JobCounter& counter);
+    void push(Task task);
+    // 先取自己队列的任务，没有时窃取；执行了一个任务时返回true
+    bool tryRunOne(uint32_t queueIndex, uint64_t& randomState);
+    bool pop(uint32_t queueIndex, Task& task);
+    bool steal(uint32_t queueIndex, uint64_t& randomState, Task& task);
+    void run(Task& task);
+    // error不为空时表示任务没有执行或执行出错，记录到counter上
+    void finish(JobCounter* counter, std::exception_ptr error);
+    void workerLoop(uint32_t queueIndex);
+
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;  // 0为主线程，1..N为工作线程
+    std::vector<std::thread>                m_workers;
+    std::atomic<uint32_t>                   m_queuedCount { 0 };   // 所有队列中的任务数，休眠的线程据此判断是否有新任务
+    std::atomic<uint32_t>                   m_sleepingCount { 0 };
+    std::mutex                              m_sleepMutex;
+    std::condition_variable                 m_wake;
+    std::atomic<bool>                       m_stopping { false };
+};
+
+#endif // JOB_SYSTEM_H
@@ -1,7 +1,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <cstdint>
-#include <fstream>
+#include <cmath>
 #include <stdexcept>
 #include <algorithm>
 #include <chrono>
@@ -12,6 +12,8 @@
 #include <set>
 #include <map>
 #include <unordered_map>
+#include <thread>
+#include <random>
 
 #include <vk_api.h>
 #include <GLFW/glfw3.h>
@@ -19,15 +21,62 @@
 #include <tiny_obj_loader.h>
 #include <fmt/format.h>
 #include "glm_api.h" // IWYU pragma: keep
+#include "asset_archive.h"
+#include "cpu_profiler.h"
+#include "frame_benchmark.h"
+#include "gpu_profiler.h"
+#include "job_system.h"
+#include "mesh_builder.h"
+#include "mesh_cache.h"
+#include "mesh_optimizer.h"
+#include "mesh_split.h"
+#include "mesh_cluster.h"
+#include "mesh_simplify.h"
+#include "memory_telemetry.h"
+#include "parallel_recorder.h"
+#include "pipeline_cache.h"
+#include "startup_graph.h"
+#include "texture_cache.h"
+#include "texture_compress.h"
+#include "texture_stream.h"
+#include "uniform_ring.h"
+#include "upload_context.h"
+#include "vertex_layout.h"
 
 
 constexpr uint32_t WIDTH = 800;
 constexpr uint32_t HEIGHT = 600;
 
-const std::string VERTEX_SHADER_PATH = PROJECT_ROOT_DIR "/shaders/vert.spv";
 const std::string FRAGMENT_SHADER_PATH = PROJECT_ROOT_DIR "/shaders/frag.spv";
+const std::string MESHLET_CULL_SHADER_PATH = PROJECT_ROOT_DIR "/shaders/meshlet_cull_comp.spv";
+const std::string PIPELINE_CACHE_PATH = PROJECT_ROOT_DIR "/shaders/main.pipelinecache";
+const std::string MEMORY_SNAPSHOT_PATH = "memory_snapshot.json"; // 窗口模式下按F12写出到工作目录，不写入源码树
+const std::string ASSET_ARCHIVE_PATH = PROJECT_ROOT_DIR "/assets.pak"; // 由asset_baker打包，不存在时读取散文件
 const std::string MODEL_PATH = PROJECT_ROOT_DIR "/models/viking_room.obj";
 const std::string TEXTURE_PATH = PROJECT_ROOT_DIR "/textures/viking_room.png";
+const std::string MESH_CACHE_PATH = PROJECT_ROOT_DIR "/models/viking_room.obj.meshcache";
+constexpr bool OPTIMIZE_MESH = true; // 去重后重排索引与顶点以提高顶点缓存命中率、降低过度绘制
+constexpr bool GPU_MESHLET_CULLING = true; // 绘制前用计算着色器按簇剔除，关闭时每个16位块直接绘制
+constexpr VkDeviceSize MESHLET_DRAW_COMMANDS_OFFSET = 16; // 间接绘制缓冲区中绘制命令的起始偏移，前面是可见簇数量
+constexpr uint32_t MESHLET_CULL_GROUP_SIZE = 64; // 与meshlet_cull.comp的local_size_x一致
+constexpr uint32_t MESHLET_DRAW_CAPACITY_LIMIT = 1 << 20; // 每个间接绘制缓冲区最多的绘制命令数，超出的可见簇被丢弃
+constexpr uint32_t MAX_INSTANCE_COUNT = 65535; // 簇剔除每个实例一行工作组，不超过maxComputeWorkGroupCount[1]的最小保证值
+constexpr uint32_t INSTANCE_RANDOM_SEED = 1; // 实例朝向的随机种子，每次运行的场景相同
+constexpr float MESH_LOD_TARGET_ERROR = 0.02f; // 生成LOD时每级允许的最大几何误差，相对包围盒对角线长度
+constexpr float MESH_LOD_PIXEL_ERROR = 1.0f; // 选择投影到屏幕上的误差不超过该像素数的最粗LOD
+constexpr bool TEXTURE_BC1_FOR_OPAQUE = true; // 不透明纹理用BC1（4bpp）而不是BC7（8bpp）
+constexpr uint32_t TEXTURE_STREAM_TAIL_SIZE = 256; // 不超过该尺寸的mip尾在初始化时同步上传，更大的级别由后台线程流式加载
+constexpr size_t TEXTURE_STREAM_MAX_PENDING = 2;   // 后台线程最多预读的级别数
+constexpr VkDeviceSize STAGING_RING_SIZE = 16 * 1024 * 1024; // 上传用的持久映射暂存环形缓冲大小
+constexpr VkDeviceSize UNIFORM_RING_FRAME_SIZE = 64 * 1024; // 每个并行帧可分配的每帧常量大小
+constexpr uint32_t RECORD_MAX_THREADS = 16; // 录制二级命令缓冲区的最多段数，每段一个命令池
+constexpr uint32_t RECORD_MIN_DRAWS_PER_THREAD = 64; // 每段至少分到的绘制数，绘制少时只有一段，在主线程上直接录制
+constexpr uint32_t RECORD_BENCHMARK_ITERATIONS = 64; // 离屏基准中每个线程数录制绘制列表的次数
+constexpr uint32_t GPU_PROFILER_MAX_SCOPES = 16; // 每帧最多的GPU计时范围数
+constexpr const char* GPU_FRAME_SCOPE = "frame"; // 覆盖整个命令缓冲区的GPU计时范围
+constexpr VkFormat HEADLESS_COLOR_FORMAT = VK_FORMAT_B8G8R8A8_SRGB; // 离屏渲染目标的格式，与交换链首选格式一致
+constexpr uint32_t HEADLESS_WARMUP_FRAMES = 16; // 计时前至少渲染的帧数
+constexpr float HEADLESS_FRAME_TIME = 1.0f / 60.0f; // 离屏模式下每帧推进的动画时间（秒）
 
 constexpr std::uint32_t MAX_FRAMES_IN_FLIGHT = 2; // 并行帧数量
 constexpr std::uint32_t EXPECTED_SWAPCHAIN_IMAGE_COUNT = 3; // 期望的交换链图像数量
@@ -88,41 +137,130 @@ struct Vertex {
     glm::vec3 color;
     glm::vec2 texCoord;
 
-    static VkVertexInputBindingDescription getBindingDescription() {
-        VkVertexInputBindingDescription bindingDescription{};
-        bindingDescription.binding = 0; // 绑定点索引，vkCmdBindVertexBuffers调用时，会指定绑定的顶点缓冲区到哪个绑定点
-        bindingDescription.stride = sizeof(Vertex);
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+    bool operator==(const Vertex& other) const {
+        return pos == other.pos && color == other.color && texCoord == other.texCoord;
+    }
+};
 
-        return bindingDescription;
+// 网格的轴对齐包围盒，量化顶点的位置相对于它存储
+struct MeshBounds {
+    glm::vec3 min;
+    glm::vec3 extent;
+};
+
+MeshBounds computeMeshBounds(const std::vector<Vertex>& vertices) {
+    glm::vec3 lo(std::numeric_limits<float>::max());
+    glm::vec3 hi(std::numeric_limits<float>::lowest());
+    for (const auto& vertex : vertices) {
+        lo = glm::min(lo, vertex.pos);
+        hi = glm::max(hi, vertex.pos);
     }
+    if (vertices.empty()) {
+        lo = hi = glm::vec3(0.0f);
+    }
+    return { lo, hi - lo };
+}
 
-    static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
-        std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
+// 每种压缩格式烘焙到各自的KTX2文件，设备支持的格式变化时不会互相覆盖
+std::string textureCachePath(TextureCompression compression) {
+    return fmt::format("{}.{}.ktx2", TEXTURE_PATH, textureCompressionName(compression));
+}
 
-        attributeDescriptions[0].location = 0;
-        attributeDescriptions[0].binding = 0; // 绑定索引，与getBindingDescription中的binding一致
-        attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attributeDescriptions[0].offset = offsetof(Vertex, pos);
+VkFormat textureFormat(TextureCompression compression) {
+    switch (compression) {
+    case TextureCompression::BC1: return VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+    case TextureCompression::BC7: return VK_FORMAT_BC7_SRGB_BLOCK;
+    default: return VK_FORMAT_R8G8B8A8_SRGB;
+    }
+}
 
-        attributeDescriptions[1].location = 1;
-        attributeDescriptions[1].binding = 0;
-        attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attributeDescriptions[1].offset = offsetof(Vertex, color);
+// 一级LOD在块表与簇表中的范围，error为相对LOD0的几何误差（网格空间单位）
+struct MeshLod {
+    float    error;
+    uint32_t firstChunk;
+    uint32_t chunkCount;
+    uint32_t firstMeshlet;
+    uint32_t meshletCount;
+};
 
-        attributeDescriptions[2].location = 2;
-        attributeDescriptions[2].binding = 0;
-        attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-        attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
+// 按屏幕空间误差选择LOD：误差投影到屏幕上的像素数为 error * (proj[1][1] * height / 2) / distance，
+// distance取相机到网格包围球表面的距离。返回误差不超过maxPixelError的最粗一级
+uint32_t selectMeshLod(const MeshLod* lods, uint32_t lodCount, const MeshBounds& bounds, const glm::mat4& meshModel,
+                       const glm::vec3& eye, float projScale, float viewportHeight, float maxPixelError) {
+    const glm::vec3 center = glm::vec3(meshModel * glm::vec4(bounds.min + bounds.extent * 0.5f, 1.0f));
+    const float radius = glm::length(bounds.extent) * 0.5f;
+    const float distance = std::max(glm::length(center - eye) - radius, 1e-3f);
+    const float pixelsPerUnit = projScale * viewportHeight * 0.5f / distance;
 
-        return attributeDescriptions;
+    uint32_t selected = 0;
+    for (uint32_t i = 1; i < lodCount; ++i) {
+        if (lods[i].error * pixelsPerUnit <= maxPixelError) {
+            selected = i;
+        }
     }
+    return selected;
+}
 
-    bool operator==(const Vertex& other) const {
-        return pos == other.pos && color == other.color && texCoord == other.texCoord;
+// 原始的32字节顶点格式：float3位置 + float3颜色 + float2纹理坐标
+struct FloatVertexLayout {
+    using VertexType = Vertex;
+
+    static constexpr const char* VERTEX_SHADER_PATH = PROJECT_ROOT_DIR "/shaders/vert.spv";
+    static constexpr std::array<VertexAttribute, 3> ATTRIBUTES = { {
+        { 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, pos) },
+        { 1, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Vertex, color) },
+        { 2, VK_FORMAT_R32G32_SFLOAT, offsetof(Vertex, texCoord) },
+    } };
+
+    static VertexType pack(const Vertex& vertex, const MeshBounds&) {
+        return vertex;
+    }
+
+    static glm::mat4 dequantizeMatrix(const MeshBounds&) {
+        return glm::mat4(1.0f);
+    }
+};
+
+// 12字节的紧凑顶点：位置为相对包围盒的16位归一化整数，纹理坐标为半精度浮点，去掉恒为白色的颜色
+struct PackedVertex {
+    uint16_t pos[4]; // xyz + 填充，R16G16B16_UNORM作为顶点格式的支持度不如四分量
+    uint16_t texCoord[2];
+};
+static_assert(sizeof(PackedVertex) == 12, "unexpected PackedVertex size");
+
+struct PackedVertexLayout {
+    using VertexType = PackedVertex;
+
+    static constexpr const char* VERTEX_SHADER_PATH = PROJECT_ROOT_DIR "/shaders/vert_packed.spv";
+    static constexpr std::array<VertexAttribute, 2> ATTRIBUTES = { {
+        { 0, VK_FORMAT_R16G16B16A16_UNORM, offsetof(PackedVertex, pos) },
+        { 2, VK_FORMAT_R16G16_SFLOAT, offsetof(PackedVertex, texCoord) },
+    } };
+
+    static VertexType pack(const Vertex& vertex, const MeshBounds& bounds) {
+        const glm::vec3 normalized = glm::clamp(
+            (vertex.pos - bounds.min) / glm::max(bounds.extent, glm::vec3(std::numeric_limits<float>::min())),
+            glm::vec3(0.0f), glm::vec3(1.0f));
+        const uint64_t pos = glm::packUnorm4x16(glm::vec4(normalized, 1.0f));
+        const uint32_t texCoord = glm::packHalf2x16(vertex.texCoord);
+
+        VertexType packed{};
+        memcpy(packed.pos, &pos, sizeof(packed.pos));
+        memcpy(packed.texCoord, &texCoord, sizeof(packed.texCoord));
+        return packed;
+    }
+
+    // 反量化并入模型矩阵：着色器读到[0,1]的位置，乘以该矩阵还原到网格空间，顶点着色器无需额外计算
+    static glm::mat4 dequantizeMatrix(const MeshBounds& bounds) {
+        return glm::scale(glm::translate(glm::mat4(1.0f), bounds.min), bounds.extent);
     }
 };
 
+// 编译期选择顶点缓冲区使用的格式，去重/优化阶段始终使用Vertex，最后一步转换为MeshVertex
+using MeshVertexLayout = PackedVertexLayout;
+using MeshVertex = MeshVertexLayout::VertexType;
+
+// 原始的组合哈希，只在基准测试中作为std::unordered_map的对照组使用，顶点去重使用FloatVertexHash
 namespace std {
     template<> struct hash<Vertex> {
         size_t operator()(Vertex const& vertex) const {
@@ -133,23 +271,204 @@ namespace std {
     };
 }
 
+// OBJ中每个索引引用的位置/纹理坐标组合成一个完整顶点
+Vertex makeObjVertex(const tinyobj::attrib_t& attrib, const tinyobj::index_t& index) {
+    Vertex vertex{};
+
+    vertex.pos = {
+        attrib.vertices[3 * index.vertex_index + 0],
+        attrib.vertices[3 * index.vertex_index + 1],
+        attrib.vertices[3 * index.vertex_index + 2]
+    };
+
+    vertex.texCoord = {
+        attrib.texcoords[2 * index.texcoord_index + 0],
+        attrib.texcoords[2 * index.texcoord_index + 1]
+    };
+
+    vertex.color = { 1.0f, 1.0f, 1.0f };
+
+    return vertex;
+}
+
+// 把所有shape的索引拼接成一条索引流，只有一个shape时直接引用，避免拷贝
+const std::vector<tinyobj::index_t>& flattenObjIndices(const std::vector<tinyobj::shape_t>& shapes, std::vector<tinyobj::index_t>& storage) {
+    if (shapes.size() == 1) {
+        return shapes[0].mesh.indices;
+    }
+
+    size_t indexCount = 0;
+    for (const auto& shape : shapes) {
+        indexCount += shape.mesh.indices.size();
+    }
+    storage.clear();
+    storage.reserve(indexCount);
+    for (const auto& shape : shapes) {
+        storage.insert(storage.end(), shape.mesh.indices.begin(), shape.mesh.indices.end());
+    }
+    return storage;
+}
+
+// 网格优化：顶点缓存排序 -> 过度绘制排序 -> 顶点读取排序，每一步之后输出FIFO缓存模拟的ACMR/ATVR
+void optimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    if (vertices.empty() || indices.empty()) {
+        return;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    auto report = [&](const char* stage) {
+        const VertexCacheStats stats = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+        fmt::println("  {:<14} ACMR {:.3f}  ATVR {:.3f}  ({} vertex transforms)", stage, stats.acmr, stats.atvr, stats.vertexTransforms);
+    };
+
+    fmt::println("mesh optimization: {} vertices, {} triangles", vertices.size(), indices.size() / 3);
+    report("original");
+
+    std::vector<uint32_t> reordered(indices.size());
+    optimizeVertexCache(reordered.data(), indices.data(), indices.size(), vertices.size());
+    indices.swap(reordered);
+    report("vertex cache");
+
+    optimizeOverdraw(reordered.data(), indices.data(), indices.size(),
+        &vertices[0].pos.x, vertices.size(), sizeof(Vertex));
+    indices.swap(reordered);
+    report("overdraw");
+
+    optimizeVertexFetch(vertices, indices);
+    report("vertex fetch");
+
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+    fmt::println("mesh optimization: {:.3f} ms", elapsed);
+}
+
+// 每帧常量，从UniformRing分配，通过动态偏移绑定
 struct UniformBufferObject {
-    alignas(16) glm::mat4 model;
     alignas(16) glm::mat4 view;
     alignas(16) glm::mat4 proj;
 };
 
+// 每次绘制的push constant，与顶点着色器中的 DrawConstants 一致
+struct DrawConstants {
+    glm::mat4 model;
+};
+
+// 簇剔除的push constant，与 shaders/meshlet_cull.comp 中的 CullParams 一致
+struct MeshletCullParams {
+    glm::vec4 frustumPlanes[6];
+    glm::vec4 cameraPosition; // w为LOD选择系数
+    uint32_t  instanceCount;
+    uint32_t  lodCount;
+    uint32_t  maxDrawCount;
+    uint32_t  padding;
+};
+static_assert(sizeof(MeshletCullParams) <= 128, "push constants are only guaranteed to have 128 bytes");
+
+// 每个实例的模型矩阵，只含旋转和平移，与顶点着色器和 shaders/meshlet_cull.comp 中的 Instance 一致
+struct InstanceData {
+    glm::mat4 model;
+};
+
+// 簇剔除读取的LOD表项，跟在网格包围球（vec4）之后，与 shaders/meshlet_cull.comp 中的 MeshLod 一致
+struct GpuMeshLod {
+    float    error;
+    uint32_t firstMeshlet;
+    uint32_t meshletCount;
+    uint32_t padding;
+};
+
+// 从 proj * view * sceneModel 提取场景空间的六个视锥平面（Gribb-Hartmann，深度范围[0,1]），法线朝内并归一化。
+// sceneModel与各实例的模型矩阵只能包含旋转和平移，这样网格空间里的包围球半径仍然有效。
+// lodScale = proj[1][1] * 视口高度 / 2 / 允许的像素误差，与selectMeshLod的判据相同
+MeshletCullParams makeMeshletCullParams(const glm::mat4& proj, const glm::mat4& view, const glm::mat4& sceneModel,
+                                        const glm::vec3& eye, float lodScale, uint32_t instanceCount, uint32_t lodCount,
+                                        uint32_t maxDrawCount) {
+    const glm::mat4 clip = proj * view * sceneModel;
+    auto row = [&clip](int i) { return glm::vec4(clip[0][i], clip[1][i], clip[2][i], clip[3][i]); };
+
+    MeshletCullParams params{};
+    params.frustumPlanes[0] = row(3) + row(0); // left
+    params.frustumPlanes[1] = row(3) - row(0); // right
+    params.frustumPlanes[2] = row(3) + row(1); // bottom
+    params.frustumPlanes[3] = row(3) - row(1); // top
+    params.frustumPlanes[4] = row(2);          // near
+    params.frustumPlanes[5] = row(3) - row(2); // far
+    for (auto& plane : params.frustumPlanes) {
+        plane /= glm::length(glm::vec3(plane));
+    }
+    params.cameraPosition = glm::vec4(glm::vec3(glm::inverse(sceneModel) * glm::vec4(eye, 1.0f)), lodScale);
+    params.instanceCount = instanceCount;
+    params.lodCount = lodCount;
+    params.maxDrawCount = maxDrawCount;
+    return params;
+}
+
+// count个实例排成以原点为中心的方阵，间距spacing，各自绕Z轴随机旋转。只有一个实例时位于原点且不旋转，与单个模型相同
+std::vector<InstanceData> placeInstances(uint32_t count, float spacing) {
+    const uint32_t gridSize = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const float origin = (gridSize - 1) * spacing * 0.5f;
+    std::mt19937 rndEngine(INSTANCE_RANDOM_SEED);
+    std::uniform_real_distribution<float> rndAngle(0.0f, glm::radians(360.0f));
+
+    std::vector<InstanceData> instances(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const glm::vec3 position((i % gridSize) * spacing - origin, (i / gridSize) * spacing - origin, 0.0f);
+        const float angle = count > 1 ? rndAngle(rndEngine) : 0.0f;
+        instances[i].model = glm::rotate(glm::translate(glm::mat4(1.0f), position), angle, glm::vec3(0.0f, 0.0f, 1.0f));
+    }
+    return instances;
+}
+
+// --headless模式的参数
+struct HeadlessOptions {
+    uint32_t    frameCount { 1000 };
+    std::string baselinePath;       // 与该基准比较，出现退化时以失败退出
+    std::string saveBaselinePath;   // 把本次结果写为新的基准
+    double      tolerance { 0.10 }; // 允许超出基准的比例
+    std::string memorySnapshotPath; // 计时结束后写出显存快照
+};
+
 class HelloTriangleApplication {
 public:
     void run() {
-        initWindow();
         initVulkan();
         mainLoop();
         cleanup();
     }
 
+    // 不创建窗口与交换链，渲染到离屏图像，动画按固定的时间步推进。返回false表示相对基准出现性能退化
+    bool runHeadless(const HeadlessOptions& options) {
+        m_headless = true;
+        initVulkan();
+        const bool passed = benchmarkFrames(options);
+        cleanup();
+        return passed;
+    }
+
+    // 退出时把CPU与GPU时间线写为Chrome trace
+    void setTracePath(const std::string& path) {
+        m_tracePath = path;
+    }
+
+    // 窗口模式下按F12时写出显存快照的路径
+    void setMemorySnapshotPath(const std::string& path) {
+        m_memorySnapshotPath = path;
+    }
+
+    // 场景中放置的模型实例数，排成方阵
+    void setInstanceCount(uint32_t count) {
+        m_instanceCount = std::clamp(count, 1u, MAX_INSTANCE_COUNT);
+    }
+
+    // 不做簇剔除，每个实例的每个16位块各一次vkCmdDrawIndexed，绘制列表随实例数增长，用于多线程录制
+    void setPerInstanceDraws(bool perInstanceDraws) {
+        m_perInstanceDraws = perInstanceDraws;
+    }
+
 private:
     void initWindow() {
+        if (m_headless) {
+            return;
+        }
         glfwInit();
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
         glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
@@ -157,6 +476,7 @@ private:
         m_window = glfwCreateWindow(WIDTH, HEIGHT, "Vulkan", nullptr, nullptr);
         glfwSetWindowUserPointer(m_window, this);
         glfwSetFramebufferSizeCallback(m_window, framebufferResizeCallback);
+        glfwSetKeyCallback(m_window, keyCallback);
     }
 
     static void framebufferResizeCallback(GLFWwindow* window, int width, int height) {
@@ -164,52 +484,238 @@ private:
         app->m_framebufferResized = true;
     }
 
+    static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+        auto app = reinterpret_cast<HelloTriangleApplication*>(glfwGetWindowUserPointer(window));
+        if (key == GLFW_KEY_F12 && action == GLFW_PRESS) {
+            app->m_memorySnapshotRequested = true;
+        }
+    }
+
+    // 启动按依赖图执行：模型加载、着色器文件读取、纹理解码/烘焙等纯CPU任务和管线创建在工作线程上，
+    // 与实例、设备、交换链的创建重叠。窗口、Vulkan对象创建与上传录制只在主线程上按依赖顺序执行
     void initVulkan() {
-        createInstance();
-        setupDebugMessenger();
-        createSurface();
-        pickPhysicalDevice();
-        createLogicalDevice();
-        createVMA();
-        createCommandPool();
-        createCommandBuffers();
-        createSwapChain();
-        createImageViews();
-        createColorResources();
-        m_depthFormat = findDepthFormat();
-        createDepthResources();
-        createDescriptorSetLayout();
-        createGraphicsPipeline();
-        createTextureImage();
-        createTextureImageView();
-        createTextureSampler();
-        loadModel();
-        createVertexBuffer();
-        createIndexBuffer();
-        createUniformBuffers();
-        createDescriptorPool();
-        createDescriptorSets();
-        createSyncObjects();
+        // 启动任务、顶点去重、纹理压缩与每帧的二级命令缓冲区录制共用一个任务系统，主线程是它的队列0
+        m_jobs.create(std::max(2u, std::thread::hardware_concurrency()) - 1);
+
+        StartupGraph graph;
+        using TaskId = StartupGraph::TaskId;
+
+        // 不依赖设备的任务从启动时开始
+        const TaskId archive = graph.addTask("openAssetArchive", {}, [this]() { openAssetArchive(); });
+        const TaskId model = graph.addTask("loadModel", { archive }, [this]() { loadModel(); });
+        const TaskId shaders = graph.addTask("readShaderFiles", { archive }, [this]() { readShaderFiles(); });
+
+        // createInstance需要GLFW已初始化以查询所需的实例扩展
+        const TaskId window = graph.addMainThreadTask("initWindow", {}, [this]() { initWindow(); });
+        const TaskId instance = graph.addMainThreadTask("createInstance", { window }, [this]() { createInstance(); });
+        const TaskId debugMessenger = graph.addMainThreadTask("setupDebugMessenger", { instance }, [this]() { setupDebugMessenger(); });
+        const TaskId surface = graph.addMainThreadTask("createSurface", { instance }, [this]() { createSurface(); });
+        const TaskId physicalDevice = graph.addMainThreadTask("pickPhysicalDevice", { surface, debugMessenger }, [this]() {
+            pickPhysicalDevice();
+        });
+        // 纹理格式只取决于物理设备支持的格式，命中缓存时是映射文件，否则解码PNG、生成mip链并压缩
+        const TaskId textureData = graph.addTask("loadTextureData", { archive, physicalDevice }, [this]() { loadTextureData(); });
+        const TaskId device = graph.addMainThreadTask("createLogicalDevice", { physicalDevice }, [this]() { createLogicalDevice(); });
+        const TaskId vma = graph.addMainThreadTask("createVMA", { device }, [this]() { createVMA(); });
+        const TaskId upload = graph.addMainThreadTask("createUploadContext", { vma }, [this]() {
+            m_uploadContext.create(m_device, m_deviceTable, m_allocator, m_queueFamilyIdx, m_queue, m_transferQueueFamilyIdx, m_transferQueue,
+                STAGING_RING_SIZE);
+            m_memoryTelemetry.track(m_uploadContext.stagingAllocation(), MemoryCategory::Staging, "staging ring");
+        });
+        const TaskId commandPool = graph.addMainThreadTask("createCommandPool", { device }, [this]() { createCommandPool(); });
+        graph.addMainThreadTask("createCommandBuffers", { commandPool }, [this]() { createCommandBuffers(); });
+        graph.addMainThreadTask("createParallelRecorder", { device }, [this]() {
+            m_parallelRecorder.create(m_device, m_deviceTable, m_queueFamilyIdx, MAX_FRAMES_IN_FLIGHT, m_jobs,
+                std::min(RECORD_MAX_THREADS, m_jobs.workerCount() + 1));
+            fmt::println("recording draws on up to {} threads", m_parallelRecorder.threadCount());
+        });
+        // 离屏模式下代替交换链的目标图像由VMA分配
+        const TaskId swapChain = graph.addMainThreadTask("createSwapChain", { device, vma }, [this]() { createSwapChain(); });
+        graph.addMainThreadTask("createImageViews", { swapChain }, [this]() { createImageViews(); });
+        graph.addMainThreadTask("createColorResources", { vma, swapChain }, [this]() { createColorResources(); });
+        const TaskId depthResources = graph.addMainThreadTask("createDepthResources", { vma, swapChain }, [this]() {
+            m_depthFormat = findDepthFormat();
+            createDepthResources();
+        });
+        const TaskId descriptorSetLayout = graph.addMainThreadTask("createDescriptorSetLayout", { device }, [this]() {
+            createDescriptorSetLayout();
+        });
+        const TaskId pipelineCache = graph.addMainThreadTask("createPipelineCache", { device }, [this]() {
+            m_pipelineCache.create(m_physicalDevice, m_device, m_deviceTable, PIPELINE_CACHE_PATH);
+        });
+        // 创建管线（驱动编译着色器）是启动中最慢的一步，vkCreate*不要求外部同步，放在工作线程上
+        graph.addTask("createGraphicsPipeline", { shaders, pipelineCache, descriptorSetLayout, depthResources }, [this]() {
+            createGraphicsPipeline();
+        });
+        std::vector<TaskId> descriptorDependencies;
+        if (GPU_MESHLET_CULLING) {
+            descriptorDependencies.push_back(graph.addTask("createMeshletCullPipeline", { shaders, pipelineCache }, [this]() {
+                createMeshletCullPipeline();
+            }));
+        }
+        const TaskId textureImage = graph.addMainThreadTask("createTextureImage", { textureData, upload }, [this]() { createTextureImage(); });
+        const TaskId textureView = graph.addMainThreadTask("createTextureImageView", { textureImage }, [this]() { createTextureImageView(); });
+        const TaskId textureSampler = graph.addMainThreadTask("createTextureSampler", { textureImage }, [this]() { createTextureSampler(); });
+        std::vector<TaskId> uploads = { textureImage };
+        uploads.push_back(graph.addMainThreadTask("createVertexBuffer", { model, upload }, [this]() { createVertexBuffer(); }));
+        uploads.push_back(graph.addMainThreadTask("createIndexBuffer", { model, upload }, [this]() { createIndexBuffer(); }));
+        // 实例间距取决于网格包围盒
+        const TaskId instanceBuffer = graph.addMainThreadTask("createInstanceBuffer", { model, upload }, [this]() { createInstanceBuffer(); });
+        uploads.push_back(instanceBuffer);
+        if (GPU_MESHLET_CULLING) {
+            descriptorDependencies.push_back(instanceBuffer);
+            uploads.push_back(graph.addMainThreadTask("createMeshletBuffers", { model, upload }, [this]() { createMeshletBuffers(); }));
+            descriptorDependencies.push_back(uploads.back());
+        }
+        const TaskId uniformBuffers = graph.addMainThreadTask("createUniformRing", { vma }, [this]() { createUniformRing(); });
+        const TaskId descriptorPool = graph.addMainThreadTask("createDescriptorPool", { device }, [this]() { createDescriptorPool(); });
+        graph.addMainThreadTask("createDescriptorSets",
+            { descriptorPool, descriptorSetLayout, uniformBuffers, instanceBuffer, textureView, textureSampler }, [this]() { createDescriptorSets(); });
+        if (GPU_MESHLET_CULLING) {
+            descriptorDependencies.push_back(descriptorPool);
+            graph.addMainThreadTask("createMeshletCullDescriptorSets", descriptorDependencies, [this]() { createMeshletCullDescriptorSets(); });
+        }
+        graph.addMainThreadTask("createSyncObjects", { device }, [this]() { createSyncObjects(); });
+        graph.addMainThreadTask("createGpuProfiler", { device }, [this]() {
+            m_gpuProfiler.create(m_physicalDevice, m_device, m_deviceTable, m_queueFamilyIdx, MAX_FRAMES_IN_FLIGHT, GPU_PROFILER_MAX_SCOPES,
+                m_calibratedTimestamps);
+        });
+
+        // 所有初始化上传在一次提交中完成，不在这里等待；第一帧的提交等待m_uploadTicket
+        graph.addMainThreadTask("flushUploads", uploads, [this]() { m_uploadTicket = m_uploadContext.flush(); });
+
+        graph.run(m_jobs);
+        graph.printTimeline();
     }
 
     void mainLoop() {
         while (!glfwWindowShouldClose(m_window)) {
             glfwPollEvents();
             drawFrame();
+            if (m_memorySnapshotRequested) {
+                m_memorySnapshotRequested = false;
+                if (!m_memoryTelemetry.writeSnapshot(m_memorySnapshotPath)) {
+                    fmt::println("failed to write memory snapshot: {}", m_memorySnapshotPath);
+                }
+            }
         }
 
         m_deviceTable.vkDeviceWaitIdle(m_device);
     }
 
+    bool benchmarkFrames(const HeadlessOptions& options) {
+        // 预热：纹理流式加载结束、各帧的描述符集都已切换到完整的mip链之后才开始计时
+        uint32_t warmupFrames = 0;
+        while (warmupFrames < HEADLESS_WARMUP_FRAMES || m_textureLevelData != nullptr ||
+               std::any_of(m_descriptorSetResidentMip.begin(), m_descriptorSetResidentMip.end(), [](uint32_t mip) { return mip != 0; })) {
+            drawFrame();
+            ++warmupFrames;
+        }
+        m_deviceTable.vkDeviceWaitIdle(m_device);
+        m_gpuProfiler.collect();
+        const size_t gpuWarmupSamples = m_gpuProfiler.scopeDurationsMs(GPU_FRAME_SCOPE).size();
+
+        // 计时的帧从动画的第0帧开始，每次运行渲染的内容完全相同
+        m_headlessFrame = 0;
+        std::vector<double> cpuFrameTimes;
+        cpuFrameTimes.reserve(options.frameCount);
+        for (uint32_t i = 0; i < options.frameCount; ++i) {
+            auto frameStart = std::chrono::high_resolution_clock::now();
+            drawFrame();
+            cpuFrameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - frameStart).count());
+        }
+        m_deviceTable.vkDeviceWaitIdle(m_device);
+        m_gpuProfiler.collect();
+        benchmarkRecording();
+        if (!options.memorySnapshotPath.empty() && !m_memoryTelemetry.writeSnapshot(options.memorySnapshotPath)) {
+            fmt::println("failed to write memory snapshot: {}", options.memorySnapshotPath);
+        }
+        std::vector<double> gpuFrameTimes = m_gpuProfiler.scopeDurationsMs(GPU_FRAME_SCOPE);
+        gpuFrameTimes.erase(gpuFrameTimes.begin(), gpuFrameTimes.begin() + std::min(gpuWarmupSamples, gpuFrameTimes.size()));
+
+        const FrameTimeStats cpuStats = computeFrameTimeStats(cpuFrameTimes);
+        const FrameTimeStats gpuStats = computeFrameTimeStats(gpuFrameTimes);
+        fmt::println("headless: {}x{}, {}x MSAA, {} instances, {} warmup frames, {} measured frames", m_swapChainExtent.width, m_swapChainExtent.height,
+            static_cast<int>(m_msaaSamples), m_instanceCount, warmupFrames, options.frameCount);
+        for (const auto& [name, stats] : { std::pair("cpu", cpuStats), std::pair("gpu", gpuStats) }) {
+            fmt::println("{} frame: avg {:.3f} ms, p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms ({} samples)",
+                name, stats.avg, stats.p50, stats.p99, stats.max, stats.count);
+        }
+
+        BenchmarkMetrics metrics;
+        addFrameTimeMetrics("cpu", cpuStats, metrics);
+        // 队列族不支持时间戳时没有GPU数据
+        if (gpuStats.count > 0) {
+            addFrameTimeMetrics("gpu", gpuStats, metrics);
+        }
+        if (!options.saveBaselinePath.empty()) {
+            if (writeBenchmarkBaseline(options.saveBaselinePath, metrics)) {
+                fmt::println("baseline written to {}", options.saveBaselinePath);
+            } else {
+                fmt::println("failed to write baseline: {}", options.saveBaselinePath);
+            }
+        }
+        if (options.baselinePath.empty()) {
+            return true;
+        }
+        BenchmarkMetrics baseline;
+        if (!readBenchmarkBaseline(options.baselinePath, baseline)) {
+            throw std::runtime_error("failed to read benchmark baseline!");
+        }
+        const bool passed = compareWithBaseline(metrics, baseline, options.tolerance);
+        fmt::println("baseline {}: {}", options.baselinePath, passed ? "passed" : "regression");
+        return passed;
+    }
+
+    // 设备空闲时只录制（不提交）当前帧槽位的绘制列表，打印1, 2, 4 ... N个线程的录制时间
+    void benchmarkRecording() {
+        const uint32_t drawCount = drawListSize();
+        fmt::println("recording {} draws into secondary command buffers, {} iterations per thread count", drawCount, RECORD_BENCHMARK_ITERATIONS);
+        if (drawCount <= RECORD_MIN_DRAWS_PER_THREAD) {
+            fmt::println("draw list fits in one segment, use --draw-mode per-instance --instances N to record on several threads");
+        }
+        std::vector<uint32_t> threadCounts;
+        for (uint32_t count = 1; count < m_parallelRecorder.threadCount(); count *= 2) {
+            threadCounts.push_back(count);
+        }
+        threadCounts.push_back(m_parallelRecorder.threadCount());
+
+        const VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo = makeInheritanceRenderingInfo();
+        fmt::println("{:>8} {:>9} {:>12} {:>12} {:>9}", "threads", "segments", "avg ms", "p50 ms", "speedup");
+        double singleThreadMs = 0.0;
+        for (uint32_t threadCount : threadCounts) {
+            m_parallelRecorder.setThreadLimit(threadCount);
+            std::vector<double> recordTimes;
+            size_t segmentCount = 0;
+            for (uint32_t i = 0; i < RECORD_BENCHMARK_ITERATIONS; ++i) {
+                m_parallelRecorder.beginFrame(m_currentFrame);
+                auto recordStart = std::chrono::high_resolution_clock::now();
+                segmentCount = m_parallelRecorder.record(inheritanceRenderingInfo, drawCount, RECORD_MIN_DRAWS_PER_THREAD,
+                    [this](VkCommandBuffer secondaryCommandBuffer, uint32_t firstDraw, uint32_t count) {
+                        recordDraws(secondaryCommandBuffer, firstDraw, count);
+                    }).size();
+                recordTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - recordStart).count());
+            }
+            const FrameTimeStats stats = computeFrameTimeStats(recordTimes);
+            if (threadCount == 1) {
+                singleThreadMs = stats.avg;
+            }
+            fmt::println("{:>8} {:>9} {:>12.3f} {:>12.3f} {:>8.2f}x", threadCount, segmentCount, stats.avg, stats.p50, singleThreadMs / stats.avg);
+        }
+        m_parallelRecorder.setThreadLimit(m_parallelRecorder.threadCount());
+    }
+
     void cleanupSwapChain() {
         m_deviceTable.vkDestroyImageView(m_device, m_depthImageView, nullptr);
         m_depthImageView = VK_NULL_HANDLE;
+        m_memoryTelemetry.untrack(m_depthImageAllocation);
         vmaDestroyImage(m_allocator, m_depthImage, m_depthImageAllocation);
         m_depthImage = VK_NULL_HANDLE;
         m_depthImageAllocation = VK_NULL_HANDLE;
 
         m_deviceTable.vkDestroyImageView(m_device, m_colorImageView, nullptr);
         m_colorImageView = VK_NULL_HANDLE;
+        m_memoryTelemetry.untrack(m_colorImageAllocation);
         vmaDestroyImage(m_allocator, m_colorImage, m_colorImageAllocation);
         m_colorImage = VK_NULL_HANDLE;
         m_colorImageAllocation = VK_NULL_HANDLE;
@@ -218,11 +724,36 @@ private:
             m_deviceTable.vkDestroyImageView(m_device, imageView, nullptr);
         }
         m_swapChainImageViews.clear();
+        if (m_headless) {
+            m_memoryTelemetry.untrack(m_offscreenImageAllocation);
+            vmaDestroyImage(m_allocator, m_swapChainImages[0], m_offscreenImageAllocation);
+            m_swapChainImages.clear();
+            m_offscreenImageAllocation = VK_NULL_HANDLE;
+            return;
+        }
         m_deviceTable.vkDestroySwapchainKHR(m_device, m_swapChain, nullptr);
         m_swapChain = VK_NULL_HANDLE;
     }
 
     void cleanup() {
+        std::vector<MipStreamer<uint64_t>::ReadyLevel> pendingLevels;
+        m_textureStreamer.stop(pendingLevels);
+        m_textureStreamReady.clear();
+        m_textureStreamUploads.clear();
+        releaseTextureSource();
+
+        CpuProfiler::printSummary();
+        m_gpuProfiler.printSummary();
+        if (!m_tracePath.empty()) {
+            if (m_gpuProfiler.writeChromeTrace(m_tracePath)) {
+                fmt::println("trace written to {}", m_tracePath);
+            } else {
+                fmt::println("failed to write trace: {}", m_tracePath);
+            }
+        }
+        m_gpuProfiler.destroy();
+        m_memoryTelemetry.printSummary();
+
         for (auto semaphore : m_renderFinishedSemaphores) {
             m_deviceTable.vkDestroySemaphore(m_device, semaphore, nullptr);
         }
@@ -245,37 +776,80 @@ private:
             m_deviceTable.vkFreeDescriptorSets(m_device, m_descriptorPool, 1, &descriptorSet);
         }
         m_descriptorSets.clear();
+        for (auto descriptorSet : m_meshletCullDescriptorSets) {
+            m_deviceTable.vkFreeDescriptorSets(m_device, m_descriptorPool, 1, &descriptorSet);
+        }
+        m_meshletCullDescriptorSets.clear();
         m_deviceTable.vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
         m_descriptorPool = VK_NULL_HANDLE;
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-            vmaDestroyBuffer(m_allocator, m_uniformBuffers[i], m_uniformBufferAllocations[i]);
-        }
-        m_uniformBuffers.clear();
-        m_uniformBufferAllocations.clear();
+        m_memoryTelemetry.untrack(m_uniformRing.allocation());
+        m_uniformRing.destroy();
 
+        m_memoryTelemetry.untrack(m_indexBufferAllocation);
         vmaDestroyBuffer(m_allocator, m_indexBuffer, m_indexBufferAllocation);
         m_indexBuffer = VK_NULL_HANDLE;
         m_indexBufferAllocation = VK_NULL_HANDLE;
 
+        for (size_t i = 0; i < m_meshletDrawBuffers.size(); ++i) {
+            m_memoryTelemetry.untrack(m_meshletDrawBufferAllocations[i]);
+            vmaDestroyBuffer(m_allocator, m_meshletDrawBuffers[i], m_meshletDrawBufferAllocations[i]);
+        }
+        m_meshletDrawBuffers.clear();
+        m_meshletDrawBufferAllocations.clear();
+        m_memoryTelemetry.untrack(m_meshletBufferAllocation);
+        vmaDestroyBuffer(m_allocator, m_meshletBuffer, m_meshletBufferAllocation);
+        m_meshletBuffer = VK_NULL_HANDLE;
+        m_meshletBufferAllocation = VK_NULL_HANDLE;
+        m_memoryTelemetry.untrack(m_meshLodBufferAllocation);
+        vmaDestroyBuffer(m_allocator, m_meshLodBuffer, m_meshLodBufferAllocation);
+        m_meshLodBuffer = VK_NULL_HANDLE;
+        m_meshLodBufferAllocation = VK_NULL_HANDLE;
+
+        m_memoryTelemetry.untrack(m_instanceBufferAllocation);
+        vmaDestroyBuffer(m_allocator, m_instanceBuffer, m_instanceBufferAllocation);
+        m_instanceBuffer = VK_NULL_HANDLE;
+        m_instanceBufferAllocation = VK_NULL_HANDLE;
+
+        m_memoryTelemetry.untrack(m_vertexBufferAllocation);
         vmaDestroyBuffer(m_allocator, m_vertexBuffer, m_vertexBufferAllocation);
         m_vertexBuffer = VK_NULL_HANDLE;
         m_vertexBufferAllocation = VK_NULL_HANDLE;
 
+        m_meshCache.close();
+        m_assetArchive.close();
+        m_vertexData = nullptr;
+        m_indexData = nullptr;
+        m_chunkData = nullptr;
+        m_meshletData = nullptr;
+        m_lodData = nullptr;
+
+        m_deviceTable.vkDestroyPipeline(m_device, m_meshletCullPipeline, nullptr);
+        m_meshletCullPipeline = VK_NULL_HANDLE;
+        m_deviceTable.vkDestroyPipelineLayout(m_device, m_meshletCullPipelineLayout, nullptr);
+        m_meshletCullPipelineLayout = VK_NULL_HANDLE;
+        m_deviceTable.vkDestroyDescriptorSetLayout(m_device, m_meshletCullDescriptorSetLayout, nullptr);
+        m_meshletCullDescriptorSetLayout = VK_NULL_HANDLE;
+
         m_deviceTable.vkDestroyPipeline(m_device, m_graphicsPipeline, nullptr);
         m_graphicsPipeline = VK_NULL_HANDLE;
         m_deviceTable.vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
         m_pipelineLayout = VK_NULL_HANDLE;
 
-        m_deviceTable.vkDestroySampler(m_device, m_textureSampler, nullptr);
-        m_textureSampler = VK_NULL_HANDLE;
+        for (auto sampler : m_textureSamplers) {
+            m_deviceTable.vkDestroySampler(m_device, sampler, nullptr);
+        }
+        m_textureSamplers.clear();
 
         m_deviceTable.vkDestroyImageView(m_device, m_textureImageView, nullptr);
         m_textureImageView = VK_NULL_HANDLE;
+        m_memoryTelemetry.untrack(m_textureImageAllocation);
         vmaDestroyImage(m_allocator, m_textureImage, m_textureImageAllocation);
         m_textureImage = VK_NULL_HANDLE;
         m_textureImageAllocation = VK_NULL_HANDLE;
 
+        m_parallelRecorder.destroy();
+        m_jobs.destroy();
         m_deviceTable.vkDestroyCommandPool(m_device, m_commandPool, nullptr);
         m_commandPool = VK_NULL_HANDLE;
 
@@ -287,8 +861,16 @@ private:
         m_deviceTable.vkDestroyDescriptorSetLayout(m_device, m_descriptorSetLayout, nullptr);
         m_descriptorSetLayout = VK_NULL_HANDLE;
 
+        // 写回磁盘，下次启动时管线创建命中缓存
+        m_pipelineCache.destroy();
+
         cleanupSwapChain();
 
+        m_memoryTelemetry.untrack(m_uploadContext.stagingAllocation());
+        m_uploadContext.destroy();
+
+        // 此时所有分配都应已释放，剩下的打印为泄漏
+        m_memoryTelemetry.destroy();
         vmaDestroyAllocator(m_allocator);
         m_allocator = VK_NULL_HANDLE;
 
@@ -296,8 +878,10 @@ private:
         m_device = VK_NULL_HANDLE;
         m_deviceTable = {};
 
-        vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
-        m_surface = VK_NULL_HANDLE;
+        if (!m_headless) {
+            vkDestroySurfaceKHR(m_instance, m_surface, nullptr);
+            m_surface = VK_NULL_HANDLE;
+        }
 
         if (g_enableValidationLayers) {
             DestroyDebugUtilsMessengerEXT(m_instance, m_debugMessenger, nullptr);
@@ -309,8 +893,10 @@ private:
 
         volkFinalize();
 
-        glfwDestroyWindow(m_window);
-        glfwTerminate();
+        if (!m_headless) {
+            glfwDestroyWindow(m_window);
+            glfwTerminate();
+        }
     }
 
     void recreateSwapChain() {
@@ -365,8 +951,9 @@ private:
         appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
         appInfo.apiVersion = VK_API_VERSION_1_3;
 
+        // 离屏模式不需要surface相关的实例扩展
         uint32_t glfwInstanceExtensionCount = 0;
-        const char** glfwInstanceExtensions = glfwGetRequiredInstanceExtensions(&glfwInstanceExtensionCount);
+        const char** glfwInstanceExtensions = m_headless ? nullptr : glfwGetRequiredInstanceExtensions(&glfwInstanceExtensionCount);
         fmt::println("{} glfw required instance extensions;", glfwInstanceExtensionCount);
         for (uint32_t i = 0; i < glfwInstanceExtensionCount; ++i) {
             fmt::println("\t{}", glfwInstanceExtensions[i]);
@@ -446,6 +1033,9 @@ private:
     }
 
     void createSurface() {
+        if (m_headless) {
+            return;
+        }
         // 手动创建surface
         /*VkWin32SurfaceCreateInfoKHR createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
@@ -481,6 +1071,11 @@ private:
         if (m_physicalDevice == VK_NULL_HANDLE) {
             throw std::runtime_error("failed to find a suitable GPU!");
         }
+
+        // 支持时启用BC纹理压缩，纹理优先使用BC格式。在这里确定，使纹理加载不必等待逻辑设备创建
+        VkPhysicalDeviceFeatures supportedFeatures;
+        vkGetPhysicalDeviceFeatures(m_physicalDevice, &supportedFeatures);
+        m_textureCompressionBC = supportedFeatures.textureCompressionBC == VK_TRUE;
     }
 
     void createLogicalDevice() {
@@ -491,23 +1086,34 @@ private:
             throw std::runtime_error("failed to find a suitable queue family!");
         }
         m_queueFamilyIdx = queueFamilyIndex.value();
+        m_transferQueueFamilyIdx = findTransferQueueFamily(m_physicalDevice).value_or(m_queueFamilyIdx);
+        fmt::println("transferQueueFamilyIndex: {}", m_transferQueueFamilyIdx);
 
         float queuePriority = 1.0f;
-        VkDeviceQueueCreateInfo queueCreateInfo{};
-        queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-        queueCreateInfo.queueFamilyIndex = m_queueFamilyIdx;
-        queueCreateInfo.queueCount = 1;
-        queueCreateInfo.pQueuePriorities = &queuePriority;
+        std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
+        for (uint32_t queueFamilyIdx : std::set<uint32_t>{ m_queueFamilyIdx, m_transferQueueFamilyIdx }) {
+            VkDeviceQueueCreateInfo queueCreateInfo{};
+            queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+            queueCreateInfo.queueFamilyIndex = queueFamilyIdx;
+            queueCreateInfo.queueCount = 1;
+            queueCreateInfo.pQueuePriorities = &queuePriority;
+            queueCreateInfos.push_back(queueCreateInfo);
+        }
 
         VkPhysicalDeviceFeatures2 deviceFeatures2{};
         deviceFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
         deviceFeatures2.features.samplerAnisotropy = VK_TRUE;
         deviceFeatures2.features.sampleRateShading = VK_TRUE;
 
+        deviceFeatures2.features.textureCompressionBC = m_textureCompressionBC ? VK_TRUE : VK_FALSE;
+        deviceFeatures2.features.drawIndirectFirstInstance = GPU_MESHLET_CULLING ? VK_TRUE : VK_FALSE; // 剔除写入的绘制命令用firstInstance选择实例
+
         // 启用VK_KHR_buffer_device_address扩展
         VkPhysicalDeviceVulkan12Features vk12Features{};
         vk12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
         vk12Features.bufferDeviceAddress = VK_TRUE;
+        vk12Features.drawIndirectCount = GPU_MESHLET_CULLING ? VK_TRUE : VK_FALSE; // 簇剔除后的可见簇数量由GPU写入
+        vk12Features.timelineSemaphore = VK_TRUE; // 上传批次的完成通过时间线信号量通知
 
         // 启用VK_KHR_synchronization2/VK_KHR_maintenance4/VK_KHR_dynamic_rendering扩展
         VkPhysicalDeviceVulkan13Features vk13Features{};
@@ -525,7 +1131,8 @@ private:
         vk12Features.pNext = &vk13Features;
         vk13Features.pNext = &extendedDynamicStateFeatures;
 
-        std::vector<const char*> deviceExtensions = g_deviceExtensions;
+        // 离屏模式不启用VK_KHR_swapchain
+        std::vector<const char*> deviceExtensions = m_headless ? std::vector<const char*>() : g_deviceExtensions;
         uint32_t propertiesCount = 0;
         vkEnumerateDeviceExtensionProperties(m_physicalDevice, nullptr, &propertiesCount, nullptr);
         std::vector<VkExtensionProperties> properties(propertiesCount);
@@ -544,11 +1151,17 @@ private:
         }
 #endif
 
+        // GPU分析器用它把GPU时间戳对齐到CPU时间轴
+        m_calibratedTimestamps = IsExtensionAvailable(m_availableDeviceExtensions, VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+        if (m_calibratedTimestamps) {
+            deviceExtensions.push_back(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+        }
+
         VkDeviceCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
         createInfo.pNext = &deviceFeatures2;
-        createInfo.queueCreateInfoCount = 1;
-        createInfo.pQueueCreateInfos = &queueCreateInfo;
+        createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
+        createInfo.pQueueCreateInfos = queueCreateInfos.data();
         createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
         createInfo.ppEnabledExtensionNames = deviceExtensions.data();
         createInfo.pEnabledFeatures = nullptr; // 使用pNext链来启用功能，所以这里设为nullptr
@@ -560,6 +1173,7 @@ private:
         volkLoadDeviceTable(&m_deviceTable, m_device);
 
         m_deviceTable.vkGetDeviceQueue(m_device, m_queueFamilyIdx, 0, &m_queue);
+        m_deviceTable.vkGetDeviceQueue(m_device, m_transferQueueFamilyIdx, 0, &m_transferQueue);
     }
 
     void createVMA() {
@@ -593,6 +1207,7 @@ private:
         if (vmaCreateAllocator(&allocatorCreateInfo, &m_allocator) != VK_SUCCESS) {
             throw std::runtime_error("failed to create vulkan memory allocator!");
         }
+        m_memoryTelemetry.create(m_allocator);
     }
 
     void createCommandPool() {
@@ -620,6 +1235,10 @@ private:
     }
 
     void createSwapChain() {
+        if (m_headless) {
+            createOffscreenTarget();
+            return;
+        }
         SwapChainSupportDetails swapChainSupport = querySwapChainSupport(m_physicalDevice);
         printSwapChainSupportDetails(swapChainSupport);
         VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
@@ -675,6 +1294,20 @@ private:
         m_swapChainExtent = extent;
     }
 
+    // 离屏模式用一张图像代替交换链图像，作为多重采样颜色附件的resolve目标
+    void createOffscreenTarget() {
+        m_swapChainImageFormat = HEADLESS_COLOR_FORMAT;
+        m_swapChainExtent = { WIDTH, HEIGHT };
+        m_swapChainImageCount = 1;
+        m_swapChainImages.resize(1);
+        createImageWithVMA(m_swapChainExtent, 1, VK_SAMPLE_COUNT_1_BIT, m_swapChainImageFormat,
+            VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+            0, 0, 0, m_swapChainImages[0], m_offscreenImageAllocation);
+        m_memoryTelemetry.track(m_offscreenImageAllocation, MemoryCategory::Attachment, "offscreen target");
+        fmt::println("offscreen target: {}x{}, format {}", m_swapChainExtent.width, m_swapChainExtent.height,
+            static_cast<int>(m_swapChainImageFormat));
+    }
+
     void createImageViews() {
         m_swapChainImageViews.resize(m_swapChainImages.size());
 
@@ -686,7 +1319,7 @@ private:
     void createDescriptorSetLayout() {
         VkDescriptorSetLayoutBinding uboLayoutBinding{};
         uboLayoutBinding.binding = 0;
-        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         uboLayoutBinding.descriptorCount = 1;
         uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
         uboLayoutBinding.pImmutableSamplers = nullptr;
@@ -698,7 +1331,14 @@ private:
         samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
         samplerLayoutBinding.pImmutableSamplers = nullptr;
 
-        std::array<VkDescriptorSetLayoutBinding, 2> bindings = { uboLayoutBinding, samplerLayoutBinding };
+        VkDescriptorSetLayoutBinding instanceLayoutBinding{};
+        instanceLayoutBinding.binding = 2;
+        instanceLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        instanceLayoutBinding.descriptorCount = 1;
+        instanceLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        instanceLayoutBinding.pImmutableSamplers = nullptr;
+
+        std::array<VkDescriptorSetLayoutBinding, 3> bindings = { uboLayoutBinding, samplerLayoutBinding, instanceLayoutBinding };
 
         VkDescriptorSetLayoutCreateInfo layoutInfo{};
         layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
@@ -713,11 +1353,25 @@ private:
         }
     }
 
+    // 映射资源归档，之后的资源查找直接返回映射内存；归档不存在或已损坏时所有资源都从散文件读取
+    void openAssetArchive() {
+        if (m_assetArchive.open(ASSET_ARCHIVE_PATH, PROJECT_ROOT_DIR)) {
+            fmt::println("asset archive: {} entries from {}", m_assetArchive.entryCount(), ASSET_ARCHIVE_PATH);
+        }
+    }
+
+    // SPIR-V在启动时由工作线程读取（命中归档时不拷贝），与设备创建重叠
+    void readShaderFiles() {
+        m_assetArchive.load(MeshVertexLayout::VERTEX_SHADER_PATH, m_vertShaderCode);
+        m_assetArchive.load(FRAGMENT_SHADER_PATH, m_fragShaderCode);
+        if (GPU_MESHLET_CULLING) {
+            m_assetArchive.load(MESHLET_CULL_SHADER_PATH, m_meshletCullShaderCode);
+        }
+    }
+
     void createGraphicsPipeline() {
-        auto vertShaderCode = readFile(VERTEX_SHADER_PATH);
-        auto fragShaderCode = readFile(FRAGMENT_SHADER_PATH);
-        VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-        VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+        VkShaderModule vertShaderModule = createShaderModule(m_vertShaderCode);
+        VkShaderModule fragShaderModule = createShaderModule(m_fragShaderCode);
 
         VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
         vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -733,8 +1387,8 @@ private:
 
         VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
 
-        auto bindingDescription = Vertex::getBindingDescription();
-        auto attributeDescriptions = Vertex::getAttributeDescriptions();
+        constexpr auto bindingDescription = VertexInputDescription<MeshVertexLayout>::getBindingDescription();
+        constexpr auto attributeDescriptions = VertexInputDescription<MeshVertexLayout>::getAttributeDescriptions();
 
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -819,10 +1473,16 @@ private:
 
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        // 每次绘制的矩阵通过push constant传入，不写描述符
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(DrawConstants);
+
         pipelineLayoutInfo.setLayoutCount = 1;
         pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
-        pipelineLayoutInfo.pushConstantRangeCount = 0;
-        pipelineLayoutInfo.pPushConstantRanges = nullptr; // Optional
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
         if (m_deviceTable.vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout) != VK_SUCCESS) {
             throw std::runtime_error("failed to create pipeline layout!");
@@ -835,9 +1495,11 @@ private:
         pipelineRenderingInfo.depthAttachmentFormat = m_depthFormat;
         pipelineRenderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
 
+        PipelineCreationFeedback feedback(sizeof(shaderStages) / sizeof(shaderStages[0]));
+
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.pNext = &pipelineRenderingInfo;
+        pipelineInfo.pNext = feedback.chain(&pipelineRenderingInfo);
         pipelineInfo.stageCount = sizeof(shaderStages) / sizeof(shaderStages[0]);
         pipelineInfo.pStages = shaderStages;
         pipelineInfo.pVertexInputState = &vertexInputInfo;
@@ -854,14 +1516,92 @@ private:
         pipelineInfo.basePipelineHandle = VK_NULL_HANDLE; // Optional
         pipelineInfo.basePipelineIndex = -1; // Optional
 
-        if (m_deviceTable.vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
+        if (m_deviceTable.vkCreateGraphicsPipelines(m_device, m_pipelineCache.handle(), 1, &pipelineInfo, nullptr, &m_graphicsPipeline) != VK_SUCCESS) {
             throw std::runtime_error("failed to create graphics pipeline!");
         }
+        feedback.print("graphics");
 
         m_deviceTable.vkDestroyShaderModule(m_device, fragShaderModule, nullptr);
         m_deviceTable.vkDestroyShaderModule(m_device, vertShaderModule, nullptr);
     }
 
+    void createMeshletCullPipeline() {
+        std::array<VkDescriptorSetLayoutBinding, 4> bindings{};
+
+        bindings[0].binding = 0; // 簇数组
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[0].descriptorCount = 1;
+        bindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[0].pImmutableSamplers = nullptr;
+
+        bindings[1].binding = 1; // 可见簇数量 + 间接绘制命令
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].descriptorCount = 1;
+        bindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[1].pImmutableSamplers = nullptr;
+
+        bindings[2].binding = 2; // 实例数组
+        bindings[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[2].descriptorCount = 1;
+        bindings[2].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[2].pImmutableSamplers = nullptr;
+
+        bindings[3].binding = 3; // 网格包围球 + LOD表
+        bindings[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[3].descriptorCount = 1;
+        bindings[3].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        bindings[3].pImmutableSamplers = nullptr;
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        if (m_deviceTable.vkCreateDescriptorSetLayout(m_device, &layoutInfo, nullptr, &m_meshletCullDescriptorSetLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create meshlet cull descriptor set layout!");
+        }
+
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(MeshletCullParams);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_meshletCullDescriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (m_deviceTable.vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_meshletCullPipelineLayout) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create meshlet cull pipeline layout!");
+        }
+
+        VkShaderModule computeShaderModule = createShaderModule(m_meshletCullShaderCode);
+
+        VkPipelineShaderStageCreateInfo computeShaderStageInfo{};
+        computeShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        computeShaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        computeShaderStageInfo.module = computeShaderModule;
+        computeShaderStageInfo.pName = "main";
+
+        PipelineCreationFeedback feedback(1);
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.pNext = feedback.chain(nullptr);
+        pipelineInfo.stage = computeShaderStageInfo;
+        pipelineInfo.layout = m_meshletCullPipelineLayout;
+
+        VkResult result = m_deviceTable.vkCreateComputePipelines(m_device, m_pipelineCache.handle(), 1, &pipelineInfo, nullptr, &m_meshletCullPipeline);
+        m_deviceTable.vkDestroyShaderModule(m_device, computeShaderModule, nullptr);
+
+        if (result != VK_SUCCESS) {
+            throw std::runtime_error("failed to create meshlet cull pipeline!");
+        }
+        feedback.print("meshlet cull");
+    }
+
     void createColorResources() {
         VkFormat colorFormat = m_swapChainImageFormat;
 
@@ -869,6 +1609,7 @@ private:
         createImageWithVMA(m_swapChainExtent, 1, m_msaaSamples, colorFormat,
             VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
             0, 0, 0, m_colorImage, m_colorImageAllocation);
+        m_memoryTelemetry.track(m_colorImageAllocation, MemoryCategory::Attachment, "msaa color attachment");
         VkMemoryPropertyFlags flags = getVmaAllocationMemoryProperties(m_colorImageAllocation);
         fmt::println("m_colorImageAllocation memory property flags: 0x{:08x}", flags);
         m_colorImageView = createImageView(m_colorImage, colorFormat, VK_IMAGE_ASPECT_COLOR_BIT, 1);
@@ -880,6 +1621,7 @@ private:
         createImageWithVMA(m_swapChainExtent, 1, m_msaaSamples, m_depthFormat,
             VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
             0, 0, 0, m_depthImage, m_depthImageAllocation);
+        m_memoryTelemetry.track(m_depthImageAllocation, MemoryCategory::Attachment, "depth attachment");
         VkMemoryPropertyFlags flags = getVmaAllocationMemoryProperties(m_depthImageAllocation);
         fmt::println("m_depthImageAllocation memory property flags: 0x{:08x}", flags);
         m_depthImageView = createImageView(m_depthImage, m_depthFormat, VK_IMAGE_ASPECT_DEPTH_BIT, 1);
@@ -913,46 +1655,230 @@ private:
         return format == VK_FORMAT_D32_SFLOAT_S8_UINT || format == VK_FORMAT_D24_UNORM_S8_UINT;
     }
 
-    void createTextureImage() {
-        int texWidth, texHeight, texChannels;
-        stbi_set_flip_vertically_on_load(true);
-        stbi_uc* pixels = stbi_load(TEXTURE_PATH.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    // 设备能以最优平铺采样并线性过滤该格式时才使用
+    bool isTextureFormatSupported(TextureCompression compression) {
+        if (compression == TextureCompression::None) {
+            return true;
+        }
+        if (!m_textureCompressionBC) {
+            return false;
+        }
+        VkFormatProperties2 properties{};
+        properties.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2;
+        vkGetPhysicalDeviceFormatProperties2(m_physicalDevice, textureFormat(compression), &properties);
+        const VkFormatFeatureFlags required = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+            VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+        return (properties.formatProperties.optimalTilingFeatures & required) == required;
+    }
+
+    // 纹理的CPU部分：选择格式，打开KTX2缓存或烘焙mip链。只依赖物理设备，在工作线程上执行
+    void loadTextureData() {
+        auto startTime = std::chrono::high_resolution_clock::now();
 
-        if (!pixels) {
-            throw std::runtime_error("failed to load texture image!");
+        // 设备支持的格式按优先级排列。BC1的缓存只会在纹理不透明时烘焙，所以可以直接按顺序查找已有的缓存
+        std::vector<TextureCompression> candidates;
+        for (TextureCompression compression : { TextureCompression::BC1, TextureCompression::BC7, TextureCompression::None }) {
+            if (isTextureFormatSupported(compression)) {
+                candidates.push_back(compression);
+            }
         }
-        VkDeviceSize imageSize = texWidth * texHeight * 4;
-        m_mipLevels = static_cast<uint32_t>(std::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
 
-        VkBuffer stagingBuffer;
-        VmaAllocation stagingBufferAllocation;
-        createBufferWithVMA(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, 0, stagingBuffer, stagingBufferAllocation);
-        VkMemoryPropertyFlags flags = getVmaAllocationMemoryProperties(stagingBufferAllocation);
-        fmt::println("texture stagingBufferAllocation memory property flags: 0x{:08x}", flags);
+        // 依次查找资源归档与KTX2缓存，命中时直接使用映射内存中烘焙好的mip链，否则解码PNG、在CPU上生成mip链并压缩，再写回缓存。
+        // 归档中的纹理与散缓存一样记录了PNG与烘焙选项的哈希，过期时回退到散缓存；只发布归档、没有PNG时不校验。
+        // 数据在流式加载结束前一直保留，后台线程从中读取较大的级别
+        uint64_t sourceHash = 0;
+        const bool hasSource = hashFile(TEXTURE_PATH, sourceHash);
+        sourceHash = hashBytes(&TEXTURE_BC1_FOR_OPAQUE, sizeof(TEXTURE_BC1_FOR_OPAQUE), sourceHash);
+        TextureCompression compression = TextureCompression::None;
+        for (TextureCompression candidate : candidates) {
+            AssetData packed;
+            if (m_assetArchive.find(textureCachePath(candidate), packed) &&
+                m_textureCache.openMemory(packed.data, packed.size, textureFormat(candidate), hasSource ? &sourceHash : nullptr)) {
+                compression = candidate;
+                break;
+            }
+        }
+        const bool archiveHit = m_textureCache.isOpen();
+        if (!archiveHit) {
+            if (!hasSource) {
+                throw std::runtime_error("failed to load texture image!");
+            }
+            for (TextureCompression candidate : candidates) {
+                if (m_textureCache.open(textureCachePath(candidate), textureFormat(candidate), sourceHash)) {
+                    compression = candidate;
+                    break;
+                }
+            }
+        }
+        const bool cacheHit = m_textureCache.isOpen();
+        uint64_t levelDataSize = 0;
+        if (cacheHit) {
+            m_textureLevelData = m_textureCache.levelData();
+            m_textureLevels = m_textureCache.levels();
+            levelDataSize = m_textureCache.levelDataSize();
+            m_textureExtent = { m_textureCache.width(), m_textureCache.height() };
+        } else {
+            int texWidth, texHeight, texChannels;
+            stbi_set_flip_vertically_on_load(true);
+            stbi_uc* pixels = stbi_load(TEXTURE_PATH.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
 
-        vmaCopyMemoryToAllocation(m_allocator, pixels, stagingBufferAllocation, 0, imageSize);
+            if (!pixels) {
+                throw std::runtime_error("failed to load texture image!");
+            }
+            m_textureExtent = { static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight) };
+            std::vector<uint8_t> mipData;
+            std::vector<TextureLevel> mipLevels;
+            generateMipChainRGBA8(pixels, m_textureExtent.width, m_textureExtent.height, true, mipData, mipLevels);
+            const bool opaque = isOpaqueRGBA8(pixels, size_t(m_textureExtent.width) * m_textureExtent.height);
+            stbi_image_free(pixels);
+
+            for (TextureCompression candidate : candidates) {
+                if (candidate != TextureCompression::BC1 || (opaque && TEXTURE_BC1_FOR_OPAQUE)) {
+                    compression = candidate;
+                    break;
+                }
+            }
+            if (compression == TextureCompression::None) {
+                m_textureBakedData = std::move(mipData);
+                m_textureLevels = std::move(mipLevels);
+            } else {
+                compressMipChain(compression, mipData.data(), mipLevels, m_textureBakedData, m_textureLevels, m_jobs);
+            }
+
+            const std::string cachePath = textureCachePath(compression);
+            if (!writeKtx2(cachePath, textureFormat(compression), m_textureExtent.width, m_textureExtent.height,
+                    m_textureBakedData.data(), m_textureLevels, sourceHash)) {
+                fmt::println("failed to write texture cache: {}", cachePath);
+            }
+            m_textureLevelData = m_textureBakedData.data();
+            levelDataSize = m_textureBakedData.size();
+        }
+        m_textureFormat = textureFormat(compression);
+        m_textureCompression = compression;
+        m_mipLevels = static_cast<uint32_t>(m_textureLevels.size());
 
-        stbi_image_free(pixels);
+        uint64_t uncompressedSize = 0;
+        for (const TextureLevel& level : m_textureLevels) {
+            uncompressedSize += compressedLevelSize(TextureCompression::None, level.width, level.height);
+        }
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+        fmt::println("texture {}: {}x{} {}, {} mip levels, {} bytes ({} bytes as rgba8), {:.3f} ms",
+            archiveHit ? "archive hit" : cacheHit ? "cache hit" : "baked", m_textureExtent.width, m_textureExtent.height, textureCompressionName(compression),
+            m_mipLevels, levelDataSize, uncompressedSize, elapsed);
+    }
+
+    void createTextureImage() {
+        const TextureCompression compression = m_textureCompression;
 
-        VkExtent2D texExtent = { static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight) };
-        createImageWithVMA(texExtent, m_mipLevels, VK_SAMPLE_COUNT_1_BIT, VK_FORMAT_R8G8B8A8_SRGB,
-            VK_IMAGE_TILING_OPTIMAL,VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+        // mip尾：最大边不超过TEXTURE_STREAM_TAIL_SIZE的级别，至少包含最小的一级
+        uint32_t tailLevel = m_mipLevels - 1;
+        while (tailLevel > 0 && std::max(m_textureLevels[tailLevel - 1].width, m_textureLevels[tailLevel - 1].height) <= TEXTURE_STREAM_TAIL_SIZE) {
+            --tailLevel;
+        }
+        createImageWithVMA(m_textureExtent, m_mipLevels, VK_SAMPLE_COUNT_1_BIT, m_textureFormat,
+            VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
             0, 0, 0, m_textureImage, m_textureImageAllocation);
-        flags = getVmaAllocationMemoryProperties(m_textureImageAllocation);
+        m_memoryTelemetry.track(m_textureImageAllocation, MemoryCategory::Texture, "texture");
+        VkMemoryPropertyFlags flags = getVmaAllocationMemoryProperties(m_textureImageAllocation);
         fmt::println("m_textureImageAllocation memory property flags: 0x{:08x}", flags);
 
-        // 先转换图像布局为VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL，将pixels从stagingBuffer拷贝到m_textureImage
-        transitionImageLayout(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, m_mipLevels);
-        copyBufferToImage(stagingBuffer, m_textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+        // mip尾经暂存环形缓冲上传，最终为VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL。
+        // 尚未加载的级别只做布局转换，内容未定义，但采样器的minLod保证它们在常驻之前不会被采样
+        m_uploadContext.uploadImage(m_textureImage, tailLevel, m_mipLevels - tailLevel, m_textureLevelData, &m_textureLevels[tailLevel],
+            textureBlockDimension(compression), textureBlockBytes(compression), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+            VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+        if (tailLevel > 0) {
+            m_uploadContext.initializeImage(m_textureImage, 0, tailLevel, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT);
+        }
+        m_residentMip = tailLevel;
+        fmt::println("texture image: {} of {} mip levels resident", m_mipLevels - tailLevel, m_mipLevels);
+
+        // 较大的级别由后台线程逐级预读（映射文件的缺页与磁盘读取发生在后台线程），渲染线程再经暂存环形缓冲上传
+        m_textureStreamStart = std::chrono::high_resolution_clock::now();
+        m_textureStreamer.start(0, tailLevel, TEXTURE_STREAM_MAX_PENDING, [this](uint32_t level) {
+            const TextureLevel& textureLevel = m_textureLevels[level];
+            return prefetchPages(m_textureLevelData + textureLevel.offset, static_cast<size_t>(textureLevel.size));
+        });
+        if (tailLevel == 0) {
+            releaseTextureSource();
+        }
+    }
+
+    // 流式加载结束后不再需要映射的缓存文件或烘焙结果
+    void releaseTextureSource() {
+        m_textureCache.close();
+        m_textureBakedData.clear();
+        m_textureBakedData.shrink_to_fit();
+        m_textureLevelData = nullptr;
+    }
+
+    // 上传后台线程已预读的级别，上传完成（ticket达到）后降低采样器的minLod使其可被采样。
+    // 暂存环形缓冲没有空间时剩余的级别留到之后的帧，渲染线程不等待之前的上传完成
+    void updateTextureStreaming() {
+        if (m_textureLevelData == nullptr) {
+            return;
+        }
+        // 初始化批次在图形队列上获取了所有级别的所有权，完成之前不能在传输队列上写入
+        if (m_uploadTicket != 0) {
+            return;
+        }
+
+        m_textureStreamer.poll(m_textureStreamReady);
+        size_t uploadCount = 0;
+        for (; uploadCount < m_textureStreamReady.size(); ++uploadCount) {
+            const uint32_t level = m_textureStreamReady[uploadCount].first;
+            if (!m_uploadContext.tryUploadImage(m_textureImage, level, 1, m_textureLevelData, &m_textureLevels[level],
+                    textureBlockDimension(m_textureCompression), textureBlockBytes(m_textureCompression),
+                    VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT)) {
+                break;
+            }
+        }
+        if (uploadCount > 0) {
+            const UploadContext::Ticket ticket = m_uploadContext.flush();
+            for (size_t i = 0; i < uploadCount; ++i) {
+                m_textureStreamUploads.emplace_back(m_textureStreamReady[i].first, ticket);
+            }
+            m_textureStreamReady.erase(m_textureStreamReady.begin(), m_textureStreamReady.begin() + uploadCount);
+        }
 
-        // // 再将图像布局转换为VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL，让shader能够对图像进行采样
-        // transitionImageLayout(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, m_mipLevels);
-        // transitioned to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL while generating mipmaps
+        for (auto it = m_textureStreamUploads.begin(); it != m_textureStreamUploads.end();) {
+            if (m_uploadContext.isComplete(it->second)) {
+                m_residentMip = std::min(m_residentMip, it->first);
+                it = m_textureStreamUploads.erase(it);
+            } else {
+                ++it;
+            }
+        }
 
-        vmaDestroyBuffer(m_allocator, stagingBuffer, stagingBufferAllocation);
+        if (m_textureStreamer.finished() && m_textureStreamReady.empty() && m_textureStreamUploads.empty()) {
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_textureStreamStart).count();
+            fmt::println("texture streaming finished: all {} mip levels resident after {:.3f} ms", m_mipLevels, elapsed);
+            releaseTextureSource();
+        }
+    }
+
+    // 本帧的描述符集还未绑定且上一次使用已经结束（fence已signal），可以直接更新采样器
+    void updateTextureDescriptor(uint32_t currentImage) {
+        if (m_descriptorSetResidentMip[currentImage] == m_residentMip) {
+            return;
+        }
+        VkDescriptorImageInfo imageInfo{};
+        imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        imageInfo.imageView = m_textureImageView;
+        imageInfo.sampler = m_textureSamplers[m_residentMip];
 
-        //transitioned to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL while generating mipmaps
-        generateMipmaps(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, m_mipLevels);
+        VkWriteDescriptorSet descriptorWrite{};
+        descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        descriptorWrite.dstSet = m_descriptorSets[currentImage];
+        descriptorWrite.dstBinding = 1;
+        descriptorWrite.dstArrayElement = 0;
+        descriptorWrite.descriptorCount = 1;
+        descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        descriptorWrite.pImageInfo = &imageInfo;
+
+        m_deviceTable.vkUpdateDescriptorSets(m_device, 1, &descriptorWrite, 0, nullptr);
+        m_descriptorSetResidentMip[currentImage] = m_residentMip;
     }
 
     VkSampleCountFlagBits getMaxUsableSampleCount() {
@@ -970,101 +1896,11 @@ private:
         return VK_SAMPLE_COUNT_1_BIT;
     }
 
-    void generateMipmaps(VkImage image, VkFormat imageFormat, int32_t texWidth, int32_t texHeight, uint32_t mipLevels) {
-        // Check if image format supports linear blitting
-        // VkCmdBlitImage requires the texture image format we use to support linear filtering
-        VkFormatProperties2 properties{};
-        properties.sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2;
-        vkGetPhysicalDeviceFormatProperties2(m_physicalDevice, imageFormat, &properties);
-
-        if (!(properties.formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT)) {
-            throw std::runtime_error("texture image format does not support linear blitting!");
-        }
-
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.image = image;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-
-        int32_t mipWidth = texWidth;
-        int32_t mipHeight = texHeight;
-
-        for (uint32_t i = 1; i < mipLevels; i++) {
-            barrier.subresourceRange.baseMipLevel = i - 1;
-            barrier.subresourceRange.levelCount = 1;
-            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-            barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-
-             m_deviceTable.vkCmdPipelineBarrier(commandBuffer,
-                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
-                0, nullptr,
-                0, nullptr,
-                1, &barrier);
-
-            VkImageBlit blit{};
-            blit.srcOffsets[0] = { 0, 0, 0 };
-            blit.srcOffsets[1] = { mipWidth, mipHeight, 1 };
-            blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            blit.srcSubresource.mipLevel = i - 1;
-            blit.srcSubresource.baseArrayLayer = 0;
-            blit.srcSubresource.layerCount = 1;
-            blit.dstOffsets[0] = { 0, 0, 0 };
-            blit.dstOffsets[1] = { mipWidth > 1 ? mipWidth / 2 : 1, mipHeight > 1 ? mipHeight / 2 : 1, 1 };
-            blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-            blit.dstSubresource.mipLevel = i;
-            blit.dstSubresource.baseArrayLayer = 0;
-            blit.dstSubresource.layerCount = 1;
-
-             m_deviceTable.vkCmdBlitImage(commandBuffer,
-                image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-                image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                1, &blit,
-                VK_FILTER_LINEAR);
-
-            barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-            barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-             m_deviceTable.vkCmdPipelineBarrier(commandBuffer,
-                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-                0, nullptr,
-                0, nullptr,
-                1, &barrier);
-
-            if (mipWidth > 1) mipWidth /= 2;
-            if (mipHeight > 1) mipHeight /= 2;
-        }
-
-        barrier.subresourceRange.baseMipLevel = mipLevels - 1;
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-        // insert one more pipeline barrier. This barrier transitions the last mip level from
-        // VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
-         m_deviceTable.vkCmdPipelineBarrier(commandBuffer,
-            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
-            0, nullptr,
-            0, nullptr,
-            1, &barrier);
-
-        endSingleTimeCommands(commandBuffer);
-    }
-
     void createTextureImageView() {
-        m_textureImageView = createImageView(m_textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
+        m_textureImageView = createImageView(m_textureImage, m_textureFormat, VK_IMAGE_ASPECT_COLOR_BIT, m_mipLevels);
     }
 
+    // 每个mip级别一个采样器，第i个的minLod为i；常驻级别变化时切换描述符集中的采样器
     void createTextureSampler() {
         VkPhysicalDeviceProperties properties{};
         vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
@@ -1082,13 +1918,16 @@ private:
         samplerInfo.maxAnisotropy = properties.limits.maxSamplerAnisotropy;
         samplerInfo.compareEnable = VK_FALSE;
         samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
-        samplerInfo.minLod = 0.0f;
         samplerInfo.maxLod = VK_LOD_CLAMP_NONE; // static_cast<float>(m_mipLevels);
         samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
         samplerInfo.unnormalizedCoordinates = VK_FALSE;
 
-        if (m_deviceTable.vkCreateSampler(m_device, &samplerInfo, nullptr, &m_textureSampler) != VK_SUCCESS) {
-            throw std::runtime_error("failed to create texture sampler!");
+        m_textureSamplers.resize(m_mipLevels, VK_NULL_HANDLE);
+        for (uint32_t i = 0; i < m_mipLevels; ++i) {
+            samplerInfo.minLod = static_cast<float>(i);
+            if (m_deviceTable.vkCreateSampler(m_device, &samplerInfo, nullptr, &m_textureSamplers[i]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create texture sampler!");
+            }
         }
     }
 
@@ -1127,68 +1966,6 @@ private:
         }
     }
 
-    void transitionImageLayout(VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkImageMemoryBarrier barrier{};
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.oldLayout = oldLayout;
-        barrier.newLayout = newLayout;
-        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-        barrier.image = image;
-        if (newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
-            if (hasStencilComponent(format)) {
-                barrier.subresourceRange.aspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
-            }
-        } else {
-            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        }
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = mipLevels;
-        barrier.subresourceRange.baseArrayLayer = 0;
-        barrier.subresourceRange.layerCount = 1;
-
-        VkPipelineStageFlags sourceStage;
-        VkPipelineStageFlags destinationStage;
-
-        if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-
-            sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-        } else if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL && newLayout == VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) {
-            barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-            barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-
-            sourceStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
-            destinationStage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-        } else if (oldLayout == VK_IMAGE_LAYOUT_UNDEFINED && newLayout == VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL) {
-            barrier.srcAccessMask = 0;
-            barrier.dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-
-            sourceStage = VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT;
-            destinationStage = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-        } else {
-            throw std::invalid_argument("unsupported layout transition!");
-        }
-
-        // A pipeline barrier like that is generally used to synchronize access to resources,
-        // like ensuring that a write to a buffer completes before reading from it
-         m_deviceTable.vkCmdPipelineBarrier(
-            commandBuffer,
-            sourceStage, destinationStage,
-            0,
-            0, nullptr, // VkMemoryBarrier
-            0, nullptr, // VkBufferMemoryBarrier
-            1, &barrier // VkImageMemoryBarrier
-        );
-
-        endSingleTimeCommands(commandBuffer);
-    }
-
     void transitionImageLayout2(
         VkImage               image,
         VkImageLayout         oldLayout,
@@ -1224,29 +2001,6 @@ private:
          m_deviceTable.vkCmdPipelineBarrier2(m_commandBuffers[m_currentFrame], &dependencyInfo);
     }
 
-    void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkBufferImageCopy region{};
-        region.bufferOffset = 0;
-        region.bufferRowLength = 0;
-        region.bufferImageHeight = 0;
-        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-        region.imageSubresource.mipLevel = 0; // 拷贝到 mipLevel 0 上
-        region.imageSubresource.baseArrayLayer = 0;
-        region.imageSubresource.layerCount = 1;
-        region.imageOffset = { 0, 0, 0 };
-        region.imageExtent = {
-            width,
-            height,
-            1
-        };
-
-        m_deviceTable.vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-        endSingleTimeCommands(commandBuffer);
-    }
-
     VkImageView createImageView(VkImage image, VkFormat format, VkImageAspectFlags aspectFlags, uint32_t mipLevels) {
         VkImageViewCreateInfo viewInfo{};
         viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -1268,6 +2022,33 @@ private:
     }
 
     void loadModel() {
+        auto startTime = std::chrono::high_resolution_clock::now();
+
+        uint64_t sourceHash = 0;
+        const bool hasSource = hashFile(MODEL_PATH, sourceHash);
+        sourceHash = hashBytes(&OPTIMIZE_MESH, sizeof(OPTIMIZE_MESH), sourceHash); // 开关网格优化后缓存随之失效
+        sourceHash = hashBytes(&MESH_LOD_TARGET_ERROR, sizeof(MESH_LOD_TARGET_ERROR), sourceHash);
+
+        // 归档中打包的网格缓存头部记录了烘焙时OBJ与选项的哈希，与当前不一致时回退到散缓存；只发布归档、没有OBJ时不校验
+        AssetData packed;
+        if (m_assetArchive.find(MESH_CACHE_PATH, packed) && m_meshCache.openMemory(packed.data, packed.size, hasSource ? &sourceHash : nullptr) &&
+            loadModelFromCache()) {
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+            fmt::println("mesh archive hit: {} vertices, {} indices, {} chunks, {} meshlets, {} lods, {:.3f} ms",
+                m_vertexCount, m_indexCount, m_chunkCount, m_meshletCount, m_lodCount, elapsed);
+            return;
+        }
+        if (!hasSource) {
+            throw std::runtime_error("failed to open model file!");
+        }
+
+        if (m_meshCache.open(MESH_CACHE_PATH, sourceHash) && loadModelFromCache()) {
+            auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+            fmt::println("mesh cache hit: {} vertices, {} indices, {} chunks, {} meshlets, {} lods, {:.3f} ms",
+                m_vertexCount, m_indexCount, m_chunkCount, m_meshletCount, m_lodCount, elapsed);
+            return;
+        }
+
         tinyobj::attrib_t attrib;
         std::vector<tinyobj::shape_t> shapes;
         std::vector<tinyobj::material_t> materials;
@@ -1277,111 +2058,226 @@ private:
             throw std::runtime_error(warn + err);
         }
 
-        std::unordered_map<Vertex, uint32_t> uniqueVertices{};
-
-        for (const auto& shape : shapes) {
-            for (const auto& index : shape.mesh.indices) {
-                Vertex vertex{};
+        std::vector<tinyobj::index_t> indexStorage;
+        const auto& objIndices = flattenObjIndices(shapes, indexStorage);
+        buildIndexedMeshParallel<Vertex>(objIndices.size(),
+            [&](size_t i) { return makeObjVertex(attrib, objIndices[i]); },
+            m_jobs, m_jobs.workerCount() + 1, m_vertices, m_indices);
+        if (OPTIMIZE_MESH) {
+            optimizeMesh(m_vertices, m_indices);
+        }
 
-                vertex.pos = {
-                    attrib.vertices[3 * index.vertex_index + 0],
-                    attrib.vertices[3 * index.vertex_index + 1],
-                    attrib.vertices[3 * index.vertex_index + 2]
-                };
+        // 逐级简化生成LOD链，所有级别共用同一份顶点，索引依次存放
+        const MeshBounds sourceBounds = computeMeshBounds(m_vertices);
+        std::vector<uint32_t> lodIndices;
+        std::vector<MeshLodLevel> lodLevels;
+        buildLodChain(lodIndices, lodLevels, m_indices.data(), m_indices.size(),
+            &m_vertices[0].pos.x, m_vertices.size(), sizeof(Vertex),
+            glm::length(sourceBounds.extent) * MESH_LOD_TARGET_ERROR);
+        for (size_t i = 0; i < lodLevels.size(); ++i) {
+            fmt::println("  lod {}: {} triangles, error {:.6f}", i, lodLevels[i].indexCount / 3, lodLevels[i].error);
+        }
 
-                vertex.texCoord = {
-                    attrib.texcoords[2 * index.texcoord_index + 0],
-                    attrib.texcoords[2 * index.texcoord_index + 1]
-                };
+        // 切分为16位索引的块，块边界上的顶点会被复制；块不跨越LOD，每级LOD对应一段连续的块
+        std::vector<uint32_t> lodIndexCounts(lodLevels.size());
+        for (size_t i = 0; i < lodLevels.size(); ++i) {
+            lodIndexCounts[i] = lodLevels[i].indexCount;
+        }
+        std::vector<Vertex> chunkVertices;
+        std::vector<uint32_t> lodFirstChunk;
+        splitMeshIndex16(m_vertices, lodIndices, lodIndexCounts, chunkVertices, m_chunkIndices, m_meshChunks, lodFirstChunk);
 
-                vertex.color = { 1.0f, 1.0f, 1.0f };
+        buildMeshlets(m_meshlets, m_chunkIndices.data(), m_meshChunks.data(), m_meshChunks.size(),
+            &chunkVertices[0].pos.x, sizeof(Vertex));
 
-                if (uniqueVertices.count(vertex) == 0) {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(m_vertices.size());
-                    m_vertices.push_back(vertex);
-                }
-
-                m_indices.push_back(uniqueVertices[vertex]);
+        // 簇按块的顺序生成，每级LOD的簇也是连续的一段，按索引范围查找边界
+        auto firstMeshletAt = [this](uint32_t firstChunk) {
+            if (firstChunk >= m_meshChunks.size()) {
+                return static_cast<uint32_t>(m_meshlets.size());
             }
-        }
+            const uint32_t firstIndex = m_meshChunks[firstChunk].firstIndex;
+            auto it = std::lower_bound(m_meshlets.begin(), m_meshlets.end(), firstIndex,
+                [](const Meshlet& meshlet, uint32_t index) { return meshlet.firstIndex < index; });
+            return static_cast<uint32_t>(it - m_meshlets.begin());
+        };
+        m_meshLods.resize(lodLevels.size());
+        for (size_t i = 0; i < lodLevels.size(); ++i) {
+            MeshLod& lod = m_meshLods[i];
+            lod.error = lodLevels[i].error;
+            lod.firstChunk = lodFirstChunk[i];
+            lod.chunkCount = lodFirstChunk[i + 1] - lodFirstChunk[i];
+            lod.firstMeshlet = firstMeshletAt(lodFirstChunk[i]);
+            lod.meshletCount = firstMeshletAt(lodFirstChunk[i + 1]) - lod.firstMeshlet;
+        }
+
+        m_meshBounds = computeMeshBounds(chunkVertices);
+        m_meshVertices.resize(chunkVertices.size());
+        for (size_t i = 0; i < chunkVertices.size(); ++i) {
+            m_meshVertices[i] = MeshVertexLayout::pack(chunkVertices[i], m_meshBounds);
+        }
+
+        m_vertexData = m_meshVertices.data();
+        m_vertexCount = static_cast<uint32_t>(m_meshVertices.size());
+        m_indexData = m_chunkIndices.data();
+        m_indexCount = static_cast<uint32_t>(m_chunkIndices.size());
+        m_chunkData = m_meshChunks.data();
+        m_chunkCount = static_cast<uint32_t>(m_meshChunks.size());
+        m_meshletData = m_meshlets.data();
+        m_meshletCount = static_cast<uint32_t>(m_meshlets.size());
+        m_lodData = m_meshLods.data();
+        m_lodCount = static_cast<uint32_t>(m_meshLods.size());
+
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+        fmt::println("mesh cache miss: parsed {} vertices, {} indices, {} chunks, {} meshlets, {} lods, {:.3f} ms",
+            m_vertexCount, m_indexCount, m_chunkCount, m_meshletCount, m_lodCount, elapsed);
+        fmt::println("vertex format: {} bytes/vertex ({} bytes unpacked), vertex buffer {} bytes",
+            sizeof(MeshVertex), sizeof(Vertex), sizeof(MeshVertex) * m_meshVertices.size());
+
+        MeshCacheWriter writer;
+        writer.addSection(MESH_SECTION_VERTICES, sizeof(MeshVertex), m_meshVertices.data(), sizeof(MeshVertex) * m_meshVertices.size());
+        writer.addSection(MESH_SECTION_BOUNDS, sizeof(MeshBounds), &m_meshBounds, sizeof(MeshBounds));
+        writer.addSection(MESH_SECTION_INDICES, sizeof(uint16_t), m_chunkIndices.data(), sizeof(uint16_t) * m_chunkIndices.size());
+        writer.addSection(MESH_SECTION_CHUNKS, sizeof(MeshChunk), m_meshChunks.data(), sizeof(MeshChunk) * m_meshChunks.size());
+        writer.addSection(MESH_SECTION_MESHLETS, sizeof(Meshlet), m_meshlets.data(), sizeof(Meshlet) * m_meshlets.size());
+        writer.addSection(MESH_SECTION_LODS, sizeof(MeshLod), m_meshLods.data(), sizeof(MeshLod) * m_meshLods.size());
+        if (!writer.write(MESH_CACHE_PATH, sourceHash)) {
+            fmt::println("failed to write mesh cache: {}", MESH_CACHE_PATH);
+        }
+    }
+
+    // 命中缓存时顶点/索引直接指向映射内存（缓存文件或资源归档），跳过OBJ文本解析和顶点去重
+    bool loadModelFromCache() {
+        MeshCacheBlob vertices, indices, bounds, chunks, meshlets, lods;
+        if (!m_meshCache.section(MESH_SECTION_VERTICES, sizeof(MeshVertex), vertices) ||
+            !m_meshCache.section(MESH_SECTION_INDICES, sizeof(uint16_t), indices) ||
+            !m_meshCache.section(MESH_SECTION_BOUNDS, sizeof(MeshBounds), bounds) || bounds.count() != 1 ||
+            !m_meshCache.section(MESH_SECTION_CHUNKS, sizeof(MeshChunk), chunks) ||
+            !m_meshCache.section(MESH_SECTION_MESHLETS, sizeof(Meshlet), meshlets) ||
+            !m_meshCache.section(MESH_SECTION_LODS, sizeof(MeshLod), lods) ||
+            vertices.count() == 0 || indices.count() == 0 || chunks.count() == 0 || meshlets.count() == 0 || lods.count() == 0) {
+            m_meshCache.close();
+            return false;
+        }
+
+        memcpy(&m_meshBounds, bounds.data, sizeof(MeshBounds));
+        m_vertexData = vertices.data;
+        m_vertexCount = static_cast<uint32_t>(vertices.count());
+        m_indexData = static_cast<const uint16_t*>(indices.data);
+        m_indexCount = static_cast<uint32_t>(indices.count());
+        m_chunkData = static_cast<const MeshChunk*>(chunks.data);
+        m_chunkCount = static_cast<uint32_t>(chunks.count());
+        m_meshletData = static_cast<const Meshlet*>(meshlets.data);
+        m_meshletCount = static_cast<uint32_t>(meshlets.count());
+        m_lodData = static_cast<const MeshLod*>(lods.data);
+        m_lodCount = static_cast<uint32_t>(lods.count());
+        return true;
     }
 
     void createVertexBuffer() {
-        VkDeviceSize bufferSize = sizeof(m_vertices[0]) * m_vertices.size();
-
-        VkBuffer stagingBuffer;
-        VmaAllocation stagingBufferAllocation;
-
-        createBufferWithVMA(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, 0, stagingBuffer, stagingBufferAllocation);
-        VkMemoryPropertyFlags flags = getVmaAllocationMemoryProperties(stagingBufferAllocation);
-        fmt::println("vertex stagingBufferAllocation memory property flags: 0x{:08x}", flags);
-
-        vmaCopyMemoryToAllocation(m_allocator, m_vertices.data(), stagingBufferAllocation, 0, bufferSize);
+        VkDeviceSize bufferSize = sizeof(MeshVertex) * m_vertexCount;
 
         createBufferWithVMA(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 0, 0, 0, m_vertexBuffer, m_vertexBufferAllocation);
-        flags = getVmaAllocationMemoryProperties(m_vertexBufferAllocation);
+        m_memoryTelemetry.track(m_vertexBufferAllocation, MemoryCategory::Vertex, "vertex buffer");
+        VkMemoryPropertyFlags flags = getVmaAllocationMemoryProperties(m_vertexBufferAllocation);
         fmt::println("m_vertexBufferAllocation memory property flags: 0x{:08x}", flags);
 
-        copyBuffer(stagingBuffer, m_vertexBuffer, bufferSize);
-
-        vmaDestroyBuffer(m_allocator, stagingBuffer, stagingBufferAllocation);
+        m_uploadContext.uploadBuffer(m_vertexBuffer, 0, m_vertexData, bufferSize,
+            VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT);
     }
 
     void createIndexBuffer() {
-        VkDeviceSize bufferSize = sizeof(m_indices[0]) * m_indices.size();
-
-        VkBuffer stagingBuffer;
-        VmaAllocation stagingBufferAllocation;
-
-        createBufferWithVMA(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, 0, 0, stagingBuffer, stagingBufferAllocation);
-        VkMemoryPropertyFlags flags = getVmaAllocationMemoryProperties(stagingBufferAllocation);
-        fmt::println("index stagingBufferAllocation memory property flags: 0x{:08x}", flags);
-
-        vmaCopyMemoryToAllocation(m_allocator, m_indices.data(), stagingBufferAllocation, 0, bufferSize);
+        VkDeviceSize bufferSize = sizeof(uint16_t) * m_indexCount;
 
         createBufferWithVMA(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 0, 0, 0, m_indexBuffer, m_indexBufferAllocation);
-        flags = getVmaAllocationMemoryProperties(m_indexBufferAllocation);
+        m_memoryTelemetry.track(m_indexBufferAllocation, MemoryCategory::Index, "index buffer");
+        VkMemoryPropertyFlags flags = getVmaAllocationMemoryProperties(m_indexBufferAllocation);
         fmt::println("m_indexBufferAllocation memory property flags: 0x{:08x}", flags);
 
-        copyBuffer(stagingBuffer, m_indexBuffer, bufferSize);
-
-        vmaDestroyBuffer(m_allocator, stagingBuffer, stagingBufferAllocation);
+        m_uploadContext.uploadBuffer(m_indexBuffer, 0, m_indexData, bufferSize,
+            VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT);
+    }
+
+    void createMeshletBuffers() {
+        VkDeviceSize bufferSize = sizeof(Meshlet) * m_meshletCount;
+
+        createBufferWithVMA(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0, 0, 0, m_meshletBuffer, m_meshletBufferAllocation);
+        m_memoryTelemetry.track(m_meshletBufferAllocation, MemoryCategory::Storage, "meshlet buffer");
+        m_uploadContext.uploadBuffer(m_meshletBuffer, 0, m_meshletData, bufferSize,
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+
+        // 网格包围球之后是LOD表，剔除时按实例选择LOD
+        std::vector<GpuMeshLod> lods(m_lodCount);
+        m_maxLodMeshletCount = 0;
+        for (uint32_t i = 0; i < m_lodCount; ++i) {
+            lods[i] = { m_lodData[i].error, m_lodData[i].firstMeshlet, m_lodData[i].meshletCount, 0 };
+            m_maxLodMeshletCount = std::max(m_maxLodMeshletCount, m_lodData[i].meshletCount);
+        }
+        const glm::vec4 boundingSphere(m_meshBounds.min + m_meshBounds.extent * 0.5f, glm::length(m_meshBounds.extent) * 0.5f);
+        std::vector<uint8_t> lodBufferData(sizeof(glm::vec4) + sizeof(GpuMeshLod) * lods.size());
+        memcpy(lodBufferData.data(), &boundingSphere, sizeof(glm::vec4));
+        memcpy(lodBufferData.data() + sizeof(glm::vec4), lods.data(), sizeof(GpuMeshLod) * lods.size());
+        createBufferWithVMA(lodBufferData.size(), VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0, 0, 0, m_meshLodBuffer, m_meshLodBufferAllocation);
+        m_memoryTelemetry.track(m_meshLodBufferAllocation, MemoryCategory::Storage, "mesh lod buffer");
+        m_uploadContext.uploadBuffer(m_meshLodBuffer, 0, lodBufferData.data(), lodBufferData.size(),
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+
+        // 最坏情况下所有实例都选中簇最多的LOD且所有簇都可见，每个并行帧各一份，避免覆盖上一帧仍在读取的命令。
+        // 实例很多时按MESHLET_DRAW_CAPACITY_LIMIT与设备的maxDrawIndirectCount截断
+        VkPhysicalDeviceProperties properties;
+        vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+        const uint64_t worstDrawCount = static_cast<uint64_t>(m_maxLodMeshletCount) * m_instanceCount;
+        m_maxDrawCount = static_cast<uint32_t>(std::min<uint64_t>({ worstDrawCount, MESHLET_DRAW_CAPACITY_LIMIT, properties.limits.maxDrawIndirectCount }));
+        if (m_maxDrawCount < worstDrawCount) {
+            fmt::println("meshlet draw capacity {} is below the worst case of {} draws, excess visible meshlets are dropped", m_maxDrawCount, worstDrawCount);
+        }
+        VkDeviceSize drawBufferSize = MESHLET_DRAW_COMMANDS_OFFSET + sizeof(VkDrawIndexedIndirectCommand) * m_maxDrawCount;
+        m_meshletDrawBuffers.resize(MAX_FRAMES_IN_FLIGHT);
+        m_meshletDrawBufferAllocations.resize(MAX_FRAMES_IN_FLIGHT);
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+            createBufferWithVMA(
+                drawBufferSize,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                0, 0, 0,
+                m_meshletDrawBuffers[i],
+                m_meshletDrawBufferAllocations[i]);
+            m_memoryTelemetry.track(m_meshletDrawBufferAllocations[i], MemoryCategory::Storage, fmt::format("meshlet draw buffer {}", i));
+        }
     }
 
-    void createUniformBuffers() {
-        VkDeviceSize bufferSize = sizeof(UniformBufferObject);
+    // 实例变换只在初始化时上传一次，之后每帧的CPU开销与实例数无关
+    void createInstanceBuffer() {
+        const std::vector<InstanceData> instances = placeInstances(m_instanceCount, glm::length(m_meshBounds.extent));
+        VkDeviceSize bufferSize = sizeof(InstanceData) * instances.size();
 
-        m_uniformBuffers.resize(MAX_FRAMES_IN_FLIGHT);
-        m_uniformBufferAllocations.resize(MAX_FRAMES_IN_FLIGHT);
-        m_uniformBufferAllocationInfos.resize(MAX_FRAMES_IN_FLIGHT);
+        createBufferWithVMA(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0, 0, 0, m_instanceBuffer, m_instanceBufferAllocation);
+        m_memoryTelemetry.track(m_instanceBufferAllocation, MemoryCategory::Storage, "instance buffer");
+        m_uploadContext.uploadBuffer(m_instanceBuffer, 0, instances.data(), bufferSize,
+            VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT);
+        fmt::println("instances: {}", m_instanceCount);
+    }
 
-        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-            createBufferWithVMA(
-                bufferSize,
-                VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                VMA_ALLOCATION_CREATE_MAPPED_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT,
-                0,
-                0,
-                m_uniformBuffers[i],
-                m_uniformBufferAllocations[i],
-                &m_uniformBufferAllocationInfos[i]);
-            VkMemoryPropertyFlags flags = getVmaAllocationMemoryProperties(m_uniformBufferAllocations[i]);
-            fmt::println("m_uniformBuffersAllocation[{}] memory property flags: 0x{:08x}", i, flags);
-        }
+    // 所有并行帧共用一个持久映射的缓冲区，每帧一段
+    void createUniformRing() {
+        m_uniformRing.create(m_allocator, m_physicalDevice, UNIFORM_RING_FRAME_SIZE, MAX_FRAMES_IN_FLIGHT);
+        m_memoryTelemetry.track(m_uniformRing.allocation(), MemoryCategory::Uniform, "uniform ring");
+        VkMemoryPropertyFlags flags = getVmaAllocationMemoryProperties(m_uniformRing.allocation());
+        fmt::println("m_uniformRing memory property flags: 0x{:08x}", flags);
     }
 
     void createDescriptorPool() {
-        std::array<VkDescriptorPoolSize, 2> poolSizes{};
-        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+        std::array<VkDescriptorPoolSize, 3> poolSizes{};
+        poolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
         poolSizes[0].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
         poolSizes[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
         poolSizes[1].descriptorCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        poolSizes[2].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER; // 顶点着色器的实例数组 + 簇剔除的四个缓冲区
+        poolSizes[2].descriptorCount = static_cast<uint32_t>(5 * MAX_FRAMES_IN_FLIGHT);
 
         VkDescriptorPoolCreateInfo poolInfo{};
         poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
         poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
         // poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
-        poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        poolInfo.maxSets = static_cast<uint32_t>(2 * MAX_FRAMES_IN_FLIGHT);
         poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
         poolInfo.pPoolSizes = poolSizes.data();
 
@@ -1404,24 +2300,30 @@ private:
         }
 
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+            // 偏移在绑定时通过动态偏移给出，描述符之后不再更新
             VkDescriptorBufferInfo bufferInfo{};
-            bufferInfo.buffer = m_uniformBuffers[i];
+            bufferInfo.buffer = m_uniformRing.buffer();
             bufferInfo.offset = 0;
             bufferInfo.range = sizeof(UniformBufferObject);
 
             VkDescriptorImageInfo imageInfo{};
             imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
             imageInfo.imageView = m_textureImageView;
-            imageInfo.sampler = m_textureSampler;
+            imageInfo.sampler = m_textureSamplers[m_residentMip];
+
+            VkDescriptorBufferInfo instanceBufferInfo{};
+            instanceBufferInfo.buffer = m_instanceBuffer;
+            instanceBufferInfo.offset = 0;
+            instanceBufferInfo.range = VK_WHOLE_SIZE;
 
-            std::array<VkWriteDescriptorSet, 2> descriptorWrites{};
+            std::array<VkWriteDescriptorSet, 3> descriptorWrites{};
 
             descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
             descriptorWrites[0].dstSet = m_descriptorSets[i];
             descriptorWrites[0].dstBinding = 0;
             descriptorWrites[0].dstArrayElement = 0;
             descriptorWrites[0].descriptorCount = 1;
-            descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
             descriptorWrites[0].pImageInfo = nullptr; // Optional
             descriptorWrites[0].pBufferInfo = &bufferInfo;
             descriptorWrites[0].pTexelBufferView = nullptr; // Optional
@@ -1436,6 +2338,87 @@ private:
             descriptorWrites[1].pBufferInfo = nullptr; // Optional
             descriptorWrites[1].pTexelBufferView = nullptr; // Optional
 
+            descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[2].dstSet = m_descriptorSets[i];
+            descriptorWrites[2].dstBinding = 2;
+            descriptorWrites[2].dstArrayElement = 0;
+            descriptorWrites[2].descriptorCount = 1;
+            descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[2].pBufferInfo = &instanceBufferInfo;
+
+            m_deviceTable.vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
+            m_descriptorSetResidentMip[i] = m_residentMip;
+        }
+    }
+
+    void createMeshletCullDescriptorSets() {
+        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, m_meshletCullDescriptorSetLayout);
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = m_descriptorPool;
+        allocInfo.descriptorSetCount = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT);
+        allocInfo.pSetLayouts = layouts.data();
+
+        m_meshletCullDescriptorSets.resize(MAX_FRAMES_IN_FLIGHT);
+        if (m_deviceTable.vkAllocateDescriptorSets(m_device, &allocInfo, m_meshletCullDescriptorSets.data()) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate meshlet cull descriptor sets!");
+        }
+
+        for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+            VkDescriptorBufferInfo meshletBufferInfo{};
+            meshletBufferInfo.buffer = m_meshletBuffer;
+            meshletBufferInfo.offset = 0;
+            meshletBufferInfo.range = VK_WHOLE_SIZE;
+
+            VkDescriptorBufferInfo drawBufferInfo{};
+            drawBufferInfo.buffer = m_meshletDrawBuffers[i];
+            drawBufferInfo.offset = 0;
+            drawBufferInfo.range = VK_WHOLE_SIZE;
+
+            VkDescriptorBufferInfo instanceBufferInfo{};
+            instanceBufferInfo.buffer = m_instanceBuffer;
+            instanceBufferInfo.offset = 0;
+            instanceBufferInfo.range = VK_WHOLE_SIZE;
+
+            VkDescriptorBufferInfo lodBufferInfo{};
+            lodBufferInfo.buffer = m_meshLodBuffer;
+            lodBufferInfo.offset = 0;
+            lodBufferInfo.range = VK_WHOLE_SIZE;
+
+            std::array<VkWriteDescriptorSet, 4> descriptorWrites{};
+
+            descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[0].dstSet = m_meshletCullDescriptorSets[i];
+            descriptorWrites[0].dstBinding = 0;
+            descriptorWrites[0].dstArrayElement = 0;
+            descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[0].descriptorCount = 1;
+            descriptorWrites[0].pBufferInfo = &meshletBufferInfo;
+
+            descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[1].dstSet = m_meshletCullDescriptorSets[i];
+            descriptorWrites[1].dstBinding = 1;
+            descriptorWrites[1].dstArrayElement = 0;
+            descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[1].descriptorCount = 1;
+            descriptorWrites[1].pBufferInfo = &drawBufferInfo;
+
+            descriptorWrites[2].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[2].dstSet = m_meshletCullDescriptorSets[i];
+            descriptorWrites[2].dstBinding = 2;
+            descriptorWrites[2].dstArrayElement = 0;
+            descriptorWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[2].descriptorCount = 1;
+            descriptorWrites[2].pBufferInfo = &instanceBufferInfo;
+
+            descriptorWrites[3].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+            descriptorWrites[3].dstSet = m_meshletCullDescriptorSets[i];
+            descriptorWrites[3].dstBinding = 3;
+            descriptorWrites[3].dstArrayElement = 0;
+            descriptorWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            descriptorWrites[3].descriptorCount = 1;
+            descriptorWrites[3].pBufferInfo = &lodBufferInfo;
+
             m_deviceTable.vkUpdateDescriptorSets(m_device, static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
         }
     }
@@ -1473,51 +2456,6 @@ private:
         return flags;
     }
 
-    VkCommandBuffer beginSingleTimeCommands() {
-        VkCommandBufferAllocateInfo allocInfo{};
-        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-        allocInfo.commandPool = m_commandPool;
-        allocInfo.commandBufferCount = 1;
-
-        VkCommandBuffer commandBuffer;
-        m_deviceTable.vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer);
-
-        VkCommandBufferBeginInfo beginInfo{};
-        beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-        m_deviceTable.vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-        return commandBuffer;
-    }
-
-    void endSingleTimeCommands(VkCommandBuffer commandBuffer) {
-        m_deviceTable.vkEndCommandBuffer(commandBuffer);
-
-        VkSubmitInfo submitInfo{};
-        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-        submitInfo.commandBufferCount = 1;
-        submitInfo.pCommandBuffers = &commandBuffer;
-
-        m_deviceTable.vkQueueSubmit(m_queue, 1, &submitInfo, VK_NULL_HANDLE);
-        m_deviceTable.vkQueueWaitIdle(m_queue);
-
-        m_deviceTable.vkFreeCommandBuffers(m_device, m_commandPool, 1, &commandBuffer);
-    }
-
-    void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size) {
-        VkCommandBuffer commandBuffer = beginSingleTimeCommands();
-
-        VkBufferCopy copyRegion{};
-        copyRegion.srcOffset = 0; // Optional
-        copyRegion.dstOffset = 0; // Optional
-        copyRegion.size = size;
-        m_deviceTable.vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-        endSingleTimeCommands(commandBuffer);
-    }
-
     uint32_t findMemoryType(uint32_t memTypeIdxFilter, VkMemoryPropertyFlags properties) {
         VkPhysicalDeviceMemoryProperties memProperties;
         vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &memProperties);
@@ -1531,6 +2469,46 @@ private:
         throw std::runtime_error("failed to find suitable memory type!");
     }
 
+    // 簇剔除：清零可见簇计数 -> 计算着色器写入压缩后的间接绘制命令 -> 之后的绘制读取命令与计数
+    void recordMeshletCulling(VkCommandBuffer commandBuffer) {
+        VkBuffer drawBuffer = m_meshletDrawBuffers[m_currentFrame];
+        m_deviceTable.vkCmdFillBuffer(commandBuffer, drawBuffer, 0, sizeof(uint32_t), 0);
+
+        VkMemoryBarrier2 clearBarrier{};
+        clearBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        clearBarrier.srcStageMask = VK_PIPELINE_STAGE_2_CLEAR_BIT;
+        clearBarrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+        clearBarrier.dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        clearBarrier.dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+
+        VkDependencyInfo clearDependency{};
+        clearDependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        clearDependency.memoryBarrierCount = 1;
+        clearDependency.pMemoryBarriers = &clearBarrier;
+        m_deviceTable.vkCmdPipelineBarrier2(commandBuffer, &clearDependency);
+
+        m_deviceTable.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_meshletCullPipeline);
+        m_deviceTable.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_meshletCullPipelineLayout,
+            0, 1, &m_meshletCullDescriptorSets[m_currentFrame], 0, nullptr);
+        m_deviceTable.vkCmdPushConstants(commandBuffer, m_meshletCullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT,
+            0, sizeof(MeshletCullParams), &m_meshletCullParams);
+        // 每个实例一行工作组，覆盖簇最多的LOD；各实例选中的LOD在着色器中决定
+        m_deviceTable.vkCmdDispatch(commandBuffer, (m_maxLodMeshletCount + MESHLET_CULL_GROUP_SIZE - 1) / MESHLET_CULL_GROUP_SIZE, m_instanceCount, 1);
+
+        VkMemoryBarrier2 drawBarrier{};
+        drawBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+        drawBarrier.srcStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+        drawBarrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+        drawBarrier.dstStageMask = VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT;
+        drawBarrier.dstAccessMask = VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT;
+
+        VkDependencyInfo drawDependency{};
+        drawDependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+        drawDependency.memoryBarrierCount = 1;
+        drawDependency.pMemoryBarriers = &drawBarrier;
+        m_deviceTable.vkCmdPipelineBarrier2(commandBuffer, &drawDependency);
+    }
+
     void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex) {
         VkCommandBufferBeginInfo beginInfo{};
         beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -1541,6 +2519,21 @@ private:
             throw std::runtime_error("failed to begin recording command buffer!");
         }
 
+        // 新常驻的级别在绑定描述符集之前切换到更低minLod的采样器
+        updateTextureDescriptor(m_currentFrame);
+
+        // 读回该帧槽位上一次的GPU计时并重置查询
+        m_gpuProfiler.beginFrame(commandBuffer, m_currentFrame);
+        m_parallelRecorder.beginFrame(m_currentFrame);
+        const uint32_t frameScope = m_gpuProfiler.beginScope(commandBuffer, GPU_FRAME_SCOPE);
+
+        if (useMeshletCulling()) {
+            const uint32_t cullScope = m_gpuProfiler.beginScope(commandBuffer, "meshlet culling");
+            recordMeshletCulling(commandBuffer);
+            m_gpuProfiler.endScope(commandBuffer, cullScope);
+        }
+
+        const uint32_t transitionScope = m_gpuProfiler.beginScope(commandBuffer, "layout transitions");
         // Before starting rendering, transition the swapchain image to COLOR_ATTACHMENT_OPTIMAL
         transitionImageLayout2(
             m_swapChainImages[imageIndex],
@@ -1573,6 +2566,7 @@ private:
             VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
             VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
             VK_IMAGE_ASPECT_DEPTH_BIT);
+        m_gpuProfiler.endScope(commandBuffer, transitionScope);
 
         VkClearValue clearColor{}, clearDepth{};
         clearColor.color = {0.0f, 0.0f, 0.0f, 1.0f};
@@ -1608,9 +2602,71 @@ private:
         renderingInfo.colorAttachmentCount = 1;
         renderingInfo.pColorAttachments = &colorAttachment;
         renderingInfo.pDepthAttachment = &depthAttachment;
+        renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
 
+        const uint32_t renderScope = m_gpuProfiler.beginScope(commandBuffer, "rendering");
         m_deviceTable.vkCmdBeginRendering(commandBuffer, &renderingInfo);
 
+        // 绘制在多个线程上录制到二级命令缓冲区
+        const VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo = makeInheritanceRenderingInfo();
+        const uint32_t drawCount = drawListSize();
+        const std::vector<VkCommandBuffer>& secondaryCommandBuffers = m_parallelRecorder.record(inheritanceRenderingInfo, drawCount,
+            RECORD_MIN_DRAWS_PER_THREAD, [this](VkCommandBuffer secondaryCommandBuffer, uint32_t firstDraw, uint32_t count) {
+                recordDraws(secondaryCommandBuffer, firstDraw, count);
+            });
+        m_deviceTable.vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(secondaryCommandBuffers.size()), secondaryCommandBuffers.data());
+
+        m_deviceTable.vkCmdEndRendering(commandBuffer);
+        m_gpuProfiler.endScope(commandBuffer, renderScope);
+
+        // After rendering, transition the swapchain image to PRESENT_SRC
+        // 离屏模式没有VK_KHR_swapchain，转换为TRANSFER_SRC以便回读。各帧共用同一张离屏图像，
+        // 目标阶段设为颜色附件输出，与下一帧开头的布局转换构成执行依赖链（窗口模式下由acquire的信号量保证）
+        transitionImageLayout2(
+            m_swapChainImages[imageIndex],
+            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+            m_headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+            VK_ACCESS_2_NONE,
+            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+            m_headless ? VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT : VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
+            VK_IMAGE_ASPECT_COLOR_BIT);
+        m_gpuProfiler.endScope(commandBuffer, frameScope);
+
+        if (m_deviceTable.vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record command buffer!");
+        }
+    }
+
+    bool useMeshletCulling() const {
+        return GPU_MESHLET_CULLING && !m_perInstanceDraws;
+    }
+
+    // 簇剔除时只有一次间接绘制，由主线程录制；逐实例绘制时每个实例的每个块各一次绘制，其他情况每个块一次
+    uint32_t drawListSize() const {
+        const uint32_t chunkCount = m_lodData[m_currentLod].chunkCount;
+        if (useMeshletCulling()) {
+            return 1;
+        }
+        return m_perInstanceDraws ? chunkCount * m_instanceCount : chunkCount;
+    }
+
+    // 附件格式与采样数需要与vkCmdBeginRendering一致
+    VkCommandBufferInheritanceRenderingInfo makeInheritanceRenderingInfo() const {
+        VkCommandBufferInheritanceRenderingInfo inheritanceRenderingInfo{};
+        inheritanceRenderingInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO;
+        inheritanceRenderingInfo.viewMask = 0;
+        inheritanceRenderingInfo.colorAttachmentCount = 1;
+        inheritanceRenderingInfo.pColorAttachmentFormats = &m_swapChainImageFormat;
+        inheritanceRenderingInfo.depthAttachmentFormat = m_depthFormat;
+        inheritanceRenderingInfo.stencilAttachmentFormat = VK_FORMAT_UNDEFINED;
+        inheritanceRenderingInfo.rasterizationSamples = m_msaaSamples;
+        return inheritanceRenderingInfo;
+    }
+
+    // 在二级命令缓冲区中录制绘制列表中第firstDraw起的drawCount次绘制，可能在工作线程上执行，只读取本帧已确定的状态。
+    // 二级命令缓冲区不继承主命令缓冲区的状态，每个都要重新绑定
+    void recordDraws(VkCommandBuffer commandBuffer, uint32_t firstDraw, uint32_t drawCount) const {
         m_deviceTable.vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_graphicsPipeline);
 
         VkViewport viewport{};
@@ -1638,28 +2694,34 @@ private:
         VkBuffer vertexBuffers[] = { m_vertexBuffer };
         VkDeviceSize offsets[] = { 0 };
         m_deviceTable.vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-        m_deviceTable.vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+        m_deviceTable.vkCmdBindIndexBuffer(commandBuffer, m_indexBuffer, 0, VK_INDEX_TYPE_UINT16);
         m_deviceTable.vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-            m_pipelineLayout, 0, 1, &m_descriptorSets[m_currentFrame], 0, nullptr);
+            m_pipelineLayout, 0, 1, &m_descriptorSets[m_currentFrame], 1, &m_frameUniformOffset);
+        m_deviceTable.vkCmdPushConstants(commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT,
+            0, sizeof(DrawConstants), &m_drawConstants);
 
         // vkCmdDraw(commandBuffer, static_cast<uint32_t>(m_vertices.size()), 1, 0, 0);
-        m_deviceTable.vkCmdDrawIndexed(commandBuffer, static_cast<uint32_t>(m_indices.size()), 1, 0, 0, 0); // 索引绘制
-
-        m_deviceTable.vkCmdEndRendering(commandBuffer);
-
-        // After rendering, transition the swapchain image to PRESENT_SRC
-        transitionImageLayout2(
-            m_swapChainImages[imageIndex],
-            VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-            VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-            VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
-            VK_ACCESS_2_NONE,
-            VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
-            VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT,
-            VK_IMAGE_ASPECT_COLOR_BIT);
-
-        if (m_deviceTable.vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-            throw std::runtime_error("failed to record command buffer!");
+        const MeshLod& lod = m_lodData[m_currentLod];
+        if (useMeshletCulling()) {
+            // 可见簇的数量与绘制命令都由剔除阶段写入，数量在偏移0，命令从MESHLET_DRAW_COMMANDS_OFFSET开始。
+            // 所有实例的所有LOD共用一次绘制调用，CPU开销与实例数无关
+            m_deviceTable.vkCmdDrawIndexedIndirectCount(commandBuffer,
+                m_meshletDrawBuffers[m_currentFrame], MESHLET_DRAW_COMMANDS_OFFSET,
+                m_meshletDrawBuffers[m_currentFrame], 0,
+                m_maxDrawCount, sizeof(VkDrawIndexedIndirectCommand));
+        } else if (m_perInstanceDraws) {
+            // 绘制列表按实例排列，每个实例的各块连续；firstInstance选择实例的模型矩阵
+            for (uint32_t draw = firstDraw; draw < firstDraw + drawCount; ++draw) {
+                const uint32_t instance = draw / lod.chunkCount;
+                const MeshChunk& chunk = m_chunkData[lod.firstChunk + draw % lod.chunkCount];
+                m_deviceTable.vkCmdDrawIndexed(commandBuffer, chunk.indexCount, 1, chunk.firstIndex, chunk.vertexOffset, instance);
+            }
+        } else {
+            // 索引绘制，每块16位索引各自通过vertexOffset定位到自己的顶点；所有实例使用同一级LOD，不做剔除
+            for (uint32_t i = lod.firstChunk + firstDraw; i < lod.firstChunk + firstDraw + drawCount; ++i) {
+                const MeshChunk& chunk = m_chunkData[i];
+                m_deviceTable.vkCmdDrawIndexed(commandBuffer, chunk.indexCount, m_instanceCount, chunk.firstIndex, chunk.vertexOffset, 0);
+            }
         }
     }
 
@@ -1695,31 +2757,66 @@ private:
 
         auto currentTime = std::chrono::high_resolution_clock::now();
         float time = std::chrono::duration<float, std::chrono::seconds::period>(currentTime - startTime).count();
+        if (m_headless) {
+            // 离屏基准按帧号推进，与实际耗时无关
+            time = m_headlessFrame++ * HEADLESS_FRAME_TIME;
+        }
+
+        // 实例方阵越大相机越远，远近平面一起按比例放大，单个实例时与原来的视角相同
+        const float viewScale = std::max(1.0f, std::ceil(std::sqrt(static_cast<float>(m_instanceCount))) * 0.5f);
+        const glm::vec3 eye = glm::vec3(2.0f, 2.0f, 2.0f) * viewScale;
+        // 整个场景绕Z轴旋转，实例的模型矩阵是静态的
+        const glm::mat4 sceneModel = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
 
         UniformBufferObject ubo{};
-        ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ubo.view = glm::lookAtRH(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-        ubo.proj = glm::perspectiveRH_ZO(glm::radians(45.0f), m_swapChainExtent.width / (float)m_swapChainExtent.height, 0.1f, 10.0f);
+        const glm::mat4 view = glm::lookAtRH(eye, glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        ubo.view = view * sceneModel;
+        ubo.proj = glm::perspectiveRH_ZO(glm::radians(45.0f), m_swapChainExtent.width / (float)m_swapChainExtent.height,
+            0.1f * viewScale, 10.0f * viewScale);
         ubo.proj[1][1] *= -1;
         // GLM was originally designed for OpenGL, where the Y coordinate of the clip coordinates is inverted.
         // The easiest way to compensate for that is to flip the sign on the scaling factor of the Y axis in the projection matrix.
         // If you don't do this, then the image will be rendered upside down.
 
-        memcpy(m_uniformBufferAllocationInfos[currentImage].pMappedData, &ubo, sizeof(ubo));
-        // vmaCopyMemoryToAllocation(m_allocator, &ubo, m_uniformBuffersAllocation[currentImage], 0, sizeof(ubo));
+        // 该帧槽位的栅栏已经等待过，GPU不再读取它的一段
+        m_uniformRing.beginFrame(static_cast<uint32_t>(currentImage));
+        m_frameUniformOffset = m_uniformRing.push(ubo);
+        m_uniformRing.flush();
+        // 网格的反量化矩阵是每次绘制的常量
+        m_drawConstants.model = MeshVertexLayout::dequantizeMatrix(m_meshBounds);
+
+        // LOD误差与簇的包围体都在未量化的网格空间，使用不含反量化缩放的矩阵。
+        // 不做簇剔除时所有实例使用原点处实例选出的LOD，簇剔除时每个实例在着色器中各自选择
+        const float projScale = std::abs(ubo.proj[1][1]);
+        const float viewportHeight = static_cast<float>(m_swapChainExtent.height);
+        m_currentLod = selectMeshLod(m_lodData, m_lodCount, m_meshBounds, sceneModel, eye, projScale, viewportHeight, MESH_LOD_PIXEL_ERROR);
+        m_meshletCullParams = makeMeshletCullParams(ubo.proj, view, sceneModel, eye, projScale * viewportHeight * 0.5f / MESH_LOD_PIXEL_ERROR,
+            m_instanceCount, m_lodCount, m_maxDrawCount);
     }
 
     void drawFrame() {
+        CpuZone frameZone("drawFrame");
         // Note: inFlightFences, presentCompleteSemaphores, and commandBuffers are indexed by frameIndex,
         //       while renderFinishedSemaphores is indexed by imageIndex
-        VkResult fenceResult = m_deviceTable.vkWaitForFences(m_device, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+        VkResult fenceResult = VK_SUCCESS;
+        {
+            CpuZone zone("vkWaitForFences");
+            fenceResult = m_deviceTable.vkWaitForFences(m_device, 1, &m_inFlightFences[m_currentFrame], VK_TRUE, UINT64_MAX);
+        }
         if (fenceResult != VK_SUCCESS) {
             throw std::runtime_error("failed to wait for fences!");
         }
+        m_uploadContext.collect();
+        m_memoryTelemetry.update();
 
-        uint32_t imageIndex;
+        // 离屏模式只有一张目标图像，不需要acquire
+        uint32_t imageIndex = 0;
+        VkResult result = VK_SUCCESS;
         // image可用时，m_imageAvailableSemaphores[m_currentFrame]会被设置为signaled状态。
-        VkResult result = m_deviceTable.vkAcquireNextImageKHR(m_device, m_swapChain, UINT64_MAX, m_imageAvailableSemaphores[m_currentFrame], VK_NULL_HANDLE, &imageIndex);
+        if (!m_headless) {
+            CpuZone zone("vkAcquireNextImageKHR");
+            result = m_deviceTable.vkAcquireNextImageKHR(m_device, m_swapChain, UINT64_MAX, m_imageAvailableSemaphores[m_currentFrame], VK_NULL_HANDLE, &imageIndex);
+        }
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR) {
             recreateSwapChain();
@@ -1729,37 +2826,67 @@ private:
         }
 
         updateUniformBuffer(m_currentFrame);
+        updateTextureStreaming();
 
         // Only reset the fence if we are submitting work
         m_deviceTable.vkResetFences(m_device, 1, &m_inFlightFences[m_currentFrame]);
 
         m_deviceTable.vkResetCommandBuffer(m_commandBuffers[m_currentFrame], /*VkCommandBufferResetFlagBits*/ 0);
-        recordCommandBuffer(m_commandBuffers[m_currentFrame], imageIndex);
+        {
+            CpuZone zone("recordCommandBuffer");
+            recordCommandBuffer(m_commandBuffers[m_currentFrame], imageIndex);
+        }
 
         VkSubmitInfo submitInfo{};
         submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
         // 等待 m_imageAvailableSemaphores[m_currentFrame] 变为 signaled 状态，等待成功后，m_imageAvailableSemaphores[m_currentFrame] 会自动变为 unsignaled 状态。
         // 此时image可以被使用，所以可以提交命令。
-        VkSemaphore waitSemaphores[] = { m_imageAvailableSemaphores[m_currentFrame] };
-        VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-        submitInfo.waitSemaphoreCount = 1;
-        submitInfo.pWaitSemaphores = waitSemaphores;
-        submitInfo.pWaitDstStageMask = waitStages;
+        VkSemaphore waitSemaphores[] = { m_imageAvailableSemaphores[m_currentFrame], m_uploadContext.semaphore() };
+        VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT };
+        // 离屏模式没有acquire，跳过第一个信号量
+        const uint32_t firstWait = m_headless ? 1 : 0;
+        submitInfo.waitSemaphoreCount = 1 - firstWait;
+        submitInfo.pWaitSemaphores = waitSemaphores + firstWait;
+        submitInfo.pWaitDstStageMask = waitStages + firstWait;
+
+        // 初始化上传尚未完成时，在GPU上等待上传的时间线信号量，CPU不阻塞
+        uint64_t waitValues[] = { 0, m_uploadTicket };
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        if (m_uploadTicket != 0 && m_uploadContext.isComplete(m_uploadTicket)) {
+            m_uploadTicket = 0;
+        }
+        if (m_uploadTicket != 0) {
+            timelineInfo.waitSemaphoreValueCount = 2 - firstWait;
+            timelineInfo.pWaitSemaphoreValues = waitValues + firstWait;
+            submitInfo.pNext = &timelineInfo;
+            submitInfo.waitSemaphoreCount = 2 - firstWait;
+        }
 
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers = &m_commandBuffers[m_currentFrame];
 
         // 在提交的命令缓冲区执行完成后，m_renderFinishedSemaphores[imageIndex] 会自动变为 signaled 状态。
         VkSemaphore signalSemaphores[] = { m_renderFinishedSemaphores[imageIndex] };
-        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.signalSemaphoreCount = m_headless ? 0 : 1;
         submitInfo.pSignalSemaphores = signalSemaphores;
 
         // 在提交的命令缓冲区执行完成后，m_inFlightFences[m_currentFrame] 会自动变为 signaled 状态。
-        if (m_deviceTable.vkQueueSubmit(m_queue, 1, &submitInfo, m_inFlightFences[m_currentFrame]) != VK_SUCCESS) {
+        VkResult submitResult = VK_SUCCESS;
+        {
+            CpuZone zone("vkQueueSubmit");
+            submitResult = m_deviceTable.vkQueueSubmit(m_queue, 1, &submitInfo, m_inFlightFences[m_currentFrame]);
+        }
+        if (submitResult != VK_SUCCESS) {
             throw std::runtime_error("failed to submit draw command buffer!");
         }
 
+        if (m_headless) {
+            m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+            return;
+        }
+
         VkPresentInfoKHR presentInfo{};
         presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
@@ -1775,7 +2902,10 @@ private:
         presentInfo.pImageIndices = &imageIndex;
         presentInfo.pResults = nullptr; // Optional
 
-        result = m_deviceTable.vkQueuePresentKHR(m_queue, &presentInfo);
+        {
+            CpuZone zone("vkQueuePresentKHR");
+            result = m_deviceTable.vkQueuePresentKHR(m_queue, &presentInfo);
+        }
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || m_framebufferResized) {
             m_framebufferResized = false;
@@ -1787,11 +2917,12 @@ private:
         m_currentFrame = (m_currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
     }
 
-    VkShaderModule createShaderModule(const std::vector<char>& code) {
+    // 归档中的数据块按64字节对齐，满足pCode的4字节对齐要求
+    VkShaderModule createShaderModule(const AssetData& code) {
         VkShaderModuleCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = code.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());
+        createInfo.codeSize = code.size;
+        createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data);
 
         VkShaderModule shaderModule;
         if (m_deviceTable.vkCreateShaderModule(m_device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
@@ -1897,8 +3028,8 @@ private:
 
         bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-        bool swapChainAdequate = false;
-        if (extensionsSupported) {
+        bool swapChainAdequate = m_headless;
+        if (extensionsSupported && !m_headless) {
             SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
             swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
         }
@@ -1906,8 +3037,16 @@ private:
         VkPhysicalDeviceFeatures supportedFeatures;
         vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
+        VkPhysicalDeviceVulkan12Features supportedVk12Features{};
+        supportedVk12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+        VkPhysicalDeviceFeatures2 supportedFeatures2{};
+        supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        supportedFeatures2.pNext = &supportedVk12Features;
+        vkGetPhysicalDeviceFeatures2(device, &supportedFeatures2);
+
         return physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_3 && queueFamilyIdx.has_value() && extensionsSupported
-            && swapChainAdequate && (supportedFeatures.samplerAnisotropy == VK_TRUE);
+            && swapChainAdequate && (supportedFeatures.samplerAnisotropy == VK_TRUE)
+            && (!GPU_MESHLET_CULLING || (supportedVk12Features.drawIndirectCount == VK_TRUE && supportedFeatures.drawIndirectFirstInstance == VK_TRUE));
     }
 
     bool checkDeviceExtensionSupport(VkPhysicalDevice device) {
@@ -1916,7 +3055,10 @@ private:
         std::vector<VkExtensionProperties> availableExtensions(extensionCount);
         vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-        std::set<std::string> requiredExtensions(g_deviceExtensions.begin(), g_deviceExtensions.end());
+        std::set<std::string> requiredExtensions;
+        if (!m_headless) {
+            requiredExtensions.insert(g_deviceExtensions.begin(), g_deviceExtensions.end());
+        }
 
         for (const auto& extension : availableExtensions) {
             requiredExtensions.erase(extension.extensionName);
@@ -1933,9 +3075,12 @@ private:
 
         uint32_t i = 0;
         for (const auto& queueFamily : queueFamilies) {
-            VkBool32 presentSupport = VK_FALSE;
-            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &presentSupport);
-            if ((queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && (presentSupport == VK_TRUE)) {
+            VkBool32 presentSupport = m_headless ? VK_TRUE : VK_FALSE;
+            if (!m_headless) {
+                vkGetPhysicalDeviceSurfaceSupportKHR(device, i, m_surface, &presentSupport);
+            }
+            // 簇剔除的计算着色器与绘制在同一个队列上提交
+            if ((queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && (queueFamily.queueFlags & VK_QUEUE_COMPUTE_BIT) && (presentSupport == VK_TRUE)) {
                 return i;
             }
             ++i;
@@ -1944,6 +3089,29 @@ private:
         return std::nullopt;
     }
 
+    // 优先选择只支持传输的队列族（通常对应独立的DMA引擎），其次是不支持图形的队列族
+    std::optional<uint32_t> findTransferQueueFamily(VkPhysicalDevice device) {
+        uint32_t queueFamilyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount, queueFamilies.data());
+
+        std::optional<uint32_t> result;
+        for (uint32_t i = 0; i < queueFamilyCount; ++i) {
+            VkQueueFlags flags = queueFamilies[i].queueFlags;
+            if (!(flags & VK_QUEUE_TRANSFER_BIT) || (flags & VK_QUEUE_GRAPHICS_BIT)) {
+                continue;
+            }
+            if (!(flags & VK_QUEUE_COMPUTE_BIT)) {
+                return i;
+            }
+            if (!result.has_value()) {
+                result = i;
+            }
+        }
+        return result;
+    }
+
     bool checkValidationLayerSupport() const {
         uint32_t layerCount;
         vkEnumerateInstanceLayerProperties(&layerCount, nullptr);
@@ -1970,22 +3138,6 @@ private:
         return true;
     }
 
-    static std::vector<char> readFile(const std::string& filename) {
-        std::ifstream file(filename, std::ios::ate | std::ios::binary);
-        if (!file.is_open()) {
-            throw std::runtime_error("failed to open file!");
-        }
-
-        size_t fileSize = static_cast<size_t>(file.tellg());
-        std::vector<char> buffer(fileSize);
-
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-
-        file.close();
-        return buffer;
-    }
-
     static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
         VkDebugUtilsMessageSeverityFlagBitsEXT messageSeverity,
         VkDebugUtilsMessageTypeFlagsEXT messageType,
@@ -2009,6 +3161,8 @@ private:
 
 private:
     GLFWwindow* m_window{ nullptr };
+    bool                         m_headless { false };     // 离屏渲染，没有窗口、surface与交换链
+    uint32_t                     m_headlessFrame { 0 };    // 离屏模式下动画推进到的帧号
 
     uint32_t                     m_apiVersion = 0;
 
@@ -2020,15 +3174,29 @@ private:
     VkSampleCountFlagBits        m_msaaSamples { VK_SAMPLE_COUNT_1_BIT };
     VkDevice                     m_device;
     std::vector<VkExtensionProperties> m_availableDeviceExtensions;
+    bool                         m_calibratedTimestamps { false }; // 已启用VK_EXT_calibrated_timestamps
 
     VolkDeviceTable              m_deviceTable;
     VmaAllocator                 m_allocator;
 
     uint32_t                     m_queueFamilyIdx;
     VkQueue                      m_queue;
+    uint32_t                     m_transferQueueFamilyIdx;  // 没有专用传输队列族时与m_queueFamilyIdx相同
+    VkQueue                      m_transferQueue;
+    UploadContext                m_uploadContext;
+    UploadContext::Ticket        m_uploadTicket { 0 };      // 第一帧需要等待的初始化上传
 
     VkCommandPool                m_commandPool;
     std::vector<VkCommandBuffer> m_commandBuffers;
+    JobSystem                    m_jobs;                   // 应用共用的任务系统，在initVulkan()开始时创建
+    ParallelRecorder             m_parallelRecorder;       // 每帧每段的命令池与二级命令缓冲区
+
+    GpuProfiler                  m_gpuProfiler;
+    std::string                  m_tracePath;              // 为空时不导出trace
+
+    MemoryTelemetry              m_memoryTelemetry;
+    std::string                  m_memorySnapshotPath { MEMORY_SNAPSHOT_PATH };
+    bool                         m_memorySnapshotRequested { false };
 
     VkSwapchainKHR               m_swapChain;
     uint32_t                     m_swapChainImageCount { 0 };
@@ -2036,6 +3204,7 @@ private:
     VkFormat                     m_swapChainImageFormat;
     VkExtent2D                   m_swapChainExtent;
     std::vector<VkImageView>     m_swapChainImageViews;
+    VmaAllocation                m_offscreenImageAllocation { VK_NULL_HANDLE }; // 离屏模式下m_swapChainImages[0]的内存
 
     VkImage                      m_colorImage;
     VmaAllocation                m_colorImageAllocation;
@@ -2046,29 +3215,85 @@ private:
     VmaAllocation                m_depthImageAllocation;
     VkImageView                  m_depthImageView;
 
+    AssetArchive                 m_assetArchive;
+    AssetData                    m_vertShaderCode;
+    AssetData                    m_fragShaderCode;
+    AssetData                    m_meshletCullShaderCode;
+
+    PipelineCache                m_pipelineCache;
     VkDescriptorSetLayout        m_descriptorSetLayout;
     VkPipelineLayout             m_pipelineLayout;
     VkPipeline                   m_graphicsPipeline;
 
+    VkDescriptorSetLayout        m_meshletCullDescriptorSetLayout { VK_NULL_HANDLE };
+    VkPipelineLayout             m_meshletCullPipelineLayout { VK_NULL_HANDLE };
+    VkPipeline                   m_meshletCullPipeline { VK_NULL_HANDLE };
+
     uint32_t                     m_mipLevels;
+    VkFormat                     m_textureFormat { VK_FORMAT_R8G8B8A8_SRGB }; // 设备支持时为BC1/BC7
+    VkExtent2D                   m_textureExtent {};
+    bool                         m_textureCompressionBC { false };
     VkImage                      m_textureImage;
     VmaAllocation                m_textureImageAllocation;
     VkImageView                  m_textureImageView;
-    VkSampler                    m_textureSampler;
+    std::vector<VkSampler>       m_textureSamplers;           // 第i个的minLod为i
+    uint32_t                     m_residentMip { 0 };         // 已上传的最精细级别，更精细的级别仍在流式加载
+    std::array<uint32_t, MAX_FRAMES_IN_FLIGHT> m_descriptorSetResidentMip {}; // 各帧描述符集中采样器对应的级别
+    MipStreamer<uint64_t>        m_textureStreamer;
+    std::vector<MipStreamer<uint64_t>::ReadyLevel> m_textureStreamReady; // 已预读、等待暂存空间上传的级别（从粗到细）
+    std::vector<std::pair<uint32_t, UploadContext::Ticket>> m_textureStreamUploads; // 已提交、尚未完成上传的级别
+    TextureCompression           m_textureCompression { TextureCompression::None };
+    std::chrono::high_resolution_clock::time_point m_textureStreamStart;
+    Ktx2Texture                  m_textureCache;              // 流式加载期间保持映射
+    std::vector<uint8_t>         m_textureBakedData;          // 未命中缓存时的烘焙结果
+    std::vector<TextureLevel>    m_textureLevels;
+    const uint8_t*               m_textureLevelData { nullptr };
 
     std::vector<Vertex>          m_vertices;
     std::vector<uint32_t>        m_indices;
+    std::vector<MeshVertex>      m_meshVertices; // m_vertices转换为顶点缓冲区格式后的结果
+    MeshBounds                   m_meshBounds {};
+    MeshCache                    m_meshCache;
+    const void*                  m_vertexData { nullptr }; // 指向m_meshVertices或映射的缓存文件
+    uint32_t                     m_vertexCount { 0 };
+    std::vector<uint16_t>        m_chunkIndices; // m_indices切分后的块内16位索引
+    std::vector<MeshChunk>       m_meshChunks;
+    const uint16_t*              m_indexData { nullptr };
+    uint32_t                     m_indexCount { 0 };
+    const MeshChunk*             m_chunkData { nullptr };
+    uint32_t                     m_chunkCount { 0 };
+    std::vector<Meshlet>         m_meshlets;
+    const Meshlet*               m_meshletData { nullptr };
+    uint32_t                     m_meshletCount { 0 };
+    std::vector<MeshLod>         m_meshLods;
+    const MeshLod*               m_lodData { nullptr };
+    uint32_t                     m_lodCount { 0 };
+    uint32_t                     m_currentLod { 0 }; // 每帧在updateUniformBuffer中按屏幕空间误差选择
     VkBuffer                     m_vertexBuffer;
     VmaAllocation                m_vertexBufferAllocation;
     VkBuffer                     m_indexBuffer;
     VmaAllocation                m_indexBufferAllocation;
-
-    std::vector<VkBuffer>        m_uniformBuffers;
-    std::vector<VmaAllocation>   m_uniformBufferAllocations;
-    std::vector<VmaAllocationInfo> m_uniformBufferAllocationInfos;
+    VkBuffer                     m_meshletBuffer { VK_NULL_HANDLE };
+    VmaAllocation                m_meshletBufferAllocation { VK_NULL_HANDLE };
+    VkBuffer                     m_meshLodBuffer { VK_NULL_HANDLE };
+    VmaAllocation                m_meshLodBufferAllocation { VK_NULL_HANDLE };
+    uint32_t                     m_maxLodMeshletCount { 0 };
+    std::vector<VkBuffer>        m_meshletDrawBuffers; // 每个并行帧一份：可见簇数量 + 间接绘制命令
+    std::vector<VmaAllocation>   m_meshletDrawBufferAllocations;
+    uint32_t                     m_maxDrawCount { 0 };  // 间接绘制缓冲区的容量
+    MeshletCullParams            m_meshletCullParams {};
+    uint32_t                     m_instanceCount { 1 };
+    bool                         m_perInstanceDraws { false }; // 关闭簇剔除，逐实例逐块绘制
+    VkBuffer                     m_instanceBuffer { VK_NULL_HANDLE };
+    VmaAllocation                m_instanceBufferAllocation { VK_NULL_HANDLE };
+
+    UniformRing                  m_uniformRing;
+    uint32_t                     m_frameUniformOffset { 0 }; // 本帧UniformBufferObject在m_uniformRing中的动态偏移
+    DrawConstants                m_drawConstants {};
 
     VkDescriptorPool             m_descriptorPool;
     std::vector<VkDescriptorSet> m_descriptorSets;
+    std::vector<VkDescriptorSet> m_meshletCullDescriptorSets;
 
     // fences are used to keep the CPU and GPU in sync with each-other
     std::vector<VkFence>         m_inFlightFences;
@@ -2079,11 +3304,249 @@ private:
     bool                         m_framebufferResized { false };
 };
 
+// 对同一条索引流依次运行三种顶点去重实现，报告吞吐量并校验输出一致。并行实现的任务系统在计时前创建
+template <typename Fetch>
+void runMeshBuildBenchmark(const std::string& name, size_t indexCount, const Fetch& fetch, int iterations) {
+    const size_t threadCount = std::max(1u, std::thread::hardware_concurrency());
+    JobSystem jobs;
+    jobs.create(static_cast<uint32_t>(threadCount - 1));
+
+    auto measure = [&](const char* label, auto&& build) {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        double bestMs = std::numeric_limits<double>::max();
+        for (int i = 0; i < iterations; ++i) {
+            auto start = std::chrono::high_resolution_clock::now();
+            build(vertices, indices);
+            auto end = std::chrono::high_resolution_clock::now();
+            bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(end - start).count());
+        }
+        fmt::println("  {:<24} {:>10} unique / {:>10} indices  {:>10.3f} ms  {:>8.2f} Mverts/s",
+            label, vertices.size(), indices.size(), bestMs, indexCount / bestMs / 1000.0);
+        return std::make_pair(std::move(vertices), std::move(indices));
+    };
+
+    fmt::println("{}: {} threads", name, threadCount);
+    auto reference = measure("std::unordered_map", [&](auto& vertices, auto& indices) {
+        buildIndexedMeshUnorderedMap<Vertex>(indexCount, fetch, vertices, indices);
+    });
+    auto flat = measure("flat weld table", [&](auto& vertices, auto& indices) {
+        buildIndexedMesh<Vertex>(indexCount, fetch, vertices, indices);
+    });
+    if (flat != reference) {
+        throw std::runtime_error("flat weld table does not match std::unordered_map output!");
+    }
+    flat = {};
+    auto parallel = measure("flat weld table parallel", [&](auto& vertices, auto& indices) {
+        buildIndexedMeshParallel<Vertex>(indexCount, fetch, jobs, threadCount, vertices, indices);
+    });
+    if (parallel != reference) {
+        throw std::runtime_error("parallel mesh build does not match single-threaded output!");
+    }
+}
+
+// 顶点去重基准测试，不创建窗口和Vulkan设备：
+//   1. models/viking_room.obj
+//   2. 合成的约1000万顶点规则网格（每个格子两个三角形，相邻三角形共享顶点）
+void benchmarkMeshLoad() {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, MODEL_PATH.c_str())) {
+        throw std::runtime_error(warn + err);
+    }
+
+    std::vector<tinyobj::index_t> indexStorage;
+    const auto& objIndices = flattenObjIndices(shapes, indexStorage);
+    runMeshBuildBenchmark(MODEL_PATH, objIndices.size(),
+        [&](size_t i) { return makeObjVertex(attrib, objIndices[i]); }, 10);
+
+    constexpr uint32_t GRID_SIZE = 3163; // 3163 * 3163 ≈ 10M 顶点
+    constexpr uint32_t CORNERS[6][2] = { {0, 0}, {1, 0}, {1, 1}, {0, 0}, {1, 1}, {0, 1} };
+    const size_t gridIndexCount = size_t{ GRID_SIZE - 1 } * (GRID_SIZE - 1) * 6;
+    runMeshBuildBenchmark(fmt::format("synthetic {}x{} grid", GRID_SIZE, GRID_SIZE), gridIndexCount,
+        [&](size_t i) {
+            const size_t cell = i / 6;
+            const uint32_t x = static_cast<uint32_t>(cell % (GRID_SIZE - 1)) + CORNERS[i % 6][0];
+            const uint32_t y = static_cast<uint32_t>(cell / (GRID_SIZE - 1)) + CORNERS[i % 6][1];
+            Vertex vertex{};
+            vertex.pos = { static_cast<float>(x), static_cast<float>(y), 0.0f };
+            vertex.color = { 1.0f, 1.0f, 1.0f };
+            vertex.texCoord = { x / static_cast<float>(GRID_SIZE), y / static_cast<float>(GRID_SIZE) };
+            return vertex;
+        }, 1);
+}
+
+// 只在CPU上运行网格优化并报告ACMR/ATVR，不创建窗口和Vulkan设备
+void benchmarkMeshOptimize() {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+
+    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, MODEL_PATH.c_str())) {
+        throw std::runtime_error(warn + err);
+    }
+
+    std::vector<tinyobj::index_t> indexStorage;
+    const auto& objIndices = flattenObjIndices(shapes, indexStorage);
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    buildIndexedMesh<Vertex>(objIndices.size(),
+        [&](size_t i) { return makeObjVertex(attrib, objIndices[i]); }, vertices, indices);
+    optimizeMesh(vertices, indices);
+}
+
+// 分别用单线程和全部硬件线程压缩整条mip链，报告编码吞吐（MPix/s）与相对RGBA8节省的显存。
+// 每个线程数对应一个预先创建的任务系统，计时不包含线程的创建
+void benchmarkTextureCompress() {
+    int texWidth, texHeight, texChannels;
+    stbi_set_flip_vertically_on_load(true);
+    stbi_uc* pixels = stbi_load(TEXTURE_PATH.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    if (!pixels) {
+        throw std::runtime_error("failed to load texture image!");
+    }
+    std::vector<uint8_t> mipData;
+    std::vector<TextureLevel> mipLevels;
+    generateMipChainRGBA8(pixels, texWidth, texHeight, true, mipData, mipLevels);
+    stbi_image_free(pixels);
+
+    uint64_t texelCount = 0;
+    for (const TextureLevel& level : mipLevels) {
+        texelCount += uint64_t(level.width) * level.height;
+    }
+    const size_t hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+    fmt::println("texture {}x{}, {} mip levels, {} texels, {} bytes as rgba8",
+        texWidth, texHeight, mipLevels.size(), texelCount, mipData.size());
+
+    std::vector<uint8_t> compressed;
+    std::vector<TextureLevel> compressedLevels;
+    for (TextureCompression compression : { TextureCompression::BC1, TextureCompression::BC7 }) {
+        for (size_t threadCount : { size_t(1), hardwareThreads }) {
+            JobSystem jobs;
+            jobs.create(static_cast<uint32_t>(threadCount - 1));
+            auto startTime = std::chrono::high_resolution_clock::now();
+            compressMipChain(compression, mipData.data(), mipLevels, compressed, compressedLevels, jobs);
+            auto elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+            fmt::println("{} x{} threads: {:.3f} ms, {:.2f} MPix/s, {} bytes, saved {} bytes ({:.1f}%)",
+                textureCompressionName(compression), threadCount, elapsed * 1000.0, texelCount / elapsed / 1e6,
+                compressed.size(), mipData.size() - compressed.size(),
+                100.0 * (mipData.size() - compressed.size()) / mipData.size());
+        }
+    }
+}
+
+// 测量一个空CpuZone的开销（两次读计数器加一次写入环形缓冲）
+void benchmarkCpuZones() {
+    constexpr uint32_t ZONE_COUNT = 10'000'000;
+    auto startTime = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < ZONE_COUNT; ++i) {
+        CpuZone zone("benchmark zone");
+    }
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::high_resolution_clock::now() - startTime).count();
+    fmt::println("{} zones: {:.1f} ns per zone", ZONE_COUNT, elapsed / ZONE_COUNT);
+}
+
+// 选项argv[i]的值；选项在最后、缺少值时抛出异常，与未知选项一样以失败退出
+const char* optionValue(int argc, const char* argv[], int i) {
+    if (i + 1 >= argc) {
+        throw std::runtime_error(fmt::format("missing value for option: {}", argv[i]));
+    }
+    return argv[i + 1];
+}
+
+// indirect：簇剔除后一次间接绘制；per-instance：每个实例的每个块一次绘制
+bool parseDrawMode(const char* mode, bool& perInstanceDraws) {
+    if (strcmp(mode, "indirect") == 0) {
+        perInstanceDraws = false;
+    } else if (strcmp(mode, "per-instance") == 0) {
+        perInstanceDraws = true;
+    } else {
+        return false;
+    }
+    return true;
+}
+
 int main(int argc, const char* argv[]) {
     fmt::println("hello vulkan");
+    CpuProfiler::setThreadName("main");
+    CpuProfiler::setThreadRingCapacity(CpuProfiler::MAIN_THREAD_RING_CAPACITY);
     HelloTriangleApplication app;
 
     try {
+        if (argc > 1 && strcmp(argv[1], "--bench-mesh-load") == 0) {
+            benchmarkMeshLoad();
+            return EXIT_SUCCESS;
+        }
+        if (argc > 1 && strcmp(argv[1], "--bench-mesh-optimize") == 0) {
+            benchmarkMeshOptimize();
+            return EXIT_SUCCESS;
+        }
+        if (argc > 1 && strcmp(argv[1], "--bench-texture-compress") == 0) {
+            benchmarkTextureCompress();
+            return EXIT_SUCCESS;
+        }
+        if (argc > 1 && strcmp(argv[1], "--bench-cpu-zones") == 0) {
+            benchmarkCpuZones();
+            return EXIT_SUCCESS;
+        }
+        if (argc > 1 && strcmp(argv[1], "--headless") == 0) {
+            // --headless [--frames N] [--baseline path] [--save-baseline path] [--tolerance x] [--trace path] [--memory-snapshot path]
+            //            [--instances N] [--draw-mode indirect|per-instance]
+            HeadlessOptions options;
+            bool perInstanceDraws = false;
+            for (int i = 2; i < argc; i += 2) {
+                if (strcmp(argv[i], "--frames") == 0) {
+                    options.frameCount = static_cast<uint32_t>(std::max(1, atoi(optionValue(argc, argv, i))));
+                } else if (strcmp(argv[i], "--baseline") == 0) {
+                    options.baselinePath = optionValue(argc, argv, i);
+                } else if (strcmp(argv[i], "--save-baseline") == 0) {
+                    options.saveBaselinePath = optionValue(argc, argv, i);
+                } else if (strcmp(argv[i], "--tolerance") == 0) {
+                    options.tolerance = atof(optionValue(argc, argv, i));
+                } else if (strcmp(argv[i], "--trace") == 0) {
+                    app.setTracePath(optionValue(argc, argv, i));
+                } else if (strcmp(argv[i], "--memory-snapshot") == 0) {
+                    options.memorySnapshotPath = optionValue(argc, argv, i);
+                } else if (strcmp(argv[i], "--instances") == 0) {
+                    app.setInstanceCount(static_cast<uint32_t>(std::max(1, atoi(optionValue(argc, argv, i)))));
+                } else if (strcmp(argv[i], "--draw-mode") == 0) {
+                    const char* mode = optionValue(argc, argv, i);
+                    if (!parseDrawMode(mode, perInstanceDraws)) {
+                        fmt::println("unknown draw mode: {}", mode);
+                        return EXIT_FAILURE;
+                    }
+                    app.setPerInstanceDraws(perInstanceDraws);
+                } else {
+                    fmt::println("unknown option: {}", argv[i]);
+                    return EXIT_FAILURE;
+                }
+            }
+            return app.runHeadless(options) ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+        // [--trace path] [--memory-snapshot path] [--instances N] [--draw-mode indirect|per-instance]
+        bool perInstanceDraws = false;
+        for (int i = 1; i < argc; i += 2) {
+            if (strcmp(argv[i], "--trace") == 0) {
+                app.setTracePath(optionValue(argc, argv, i));
+            } else if (strcmp(argv[i], "--memory-snapshot") == 0) {
+                app.setMemorySnapshotPath(optionValue(argc, argv, i));
+            } else if (strcmp(argv[i], "--instances") == 0) {
+                app.setInstanceCount(static_cast<uint32_t>(std::max(1, atoi(optionValue(argc, argv, i)))));
+            } else if (strcmp(argv[i], "--draw-mode") == 0) {
+                const char* mode = optionValue(argc, argv, i);
+                if (!parseDrawMode(mode, perInstanceDraws)) {
+                    fmt::println("unknown draw mode: {}", mode);
+                    return EXIT_FAILURE;
+                }
+                app.setPerInstanceDraws(perInstanceDraws);
+            } else {
+                fmt::println("unknown option: {}", argv[i]);
+                return EXIT_FAILURE;
+            }
+        }
         app.run();
     }
     catch (const std::exception& e) {
@@ -0,0 +1,179 @@
+#include "memory_telemetry.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <fmt/format.h>
+
+#include "mesh_cache.h"
+
+namespace {
+    constexpr const char* CATEGORY_NAMES[] = {
+        "vertex", "index", "texture", "uniform", "storage", "staging", "attachment",
+    };
+    static_assert(std::size(CATEGORY_NAMES) == static_cast<size_t>(MemoryCategory::Count), "missing memory category name");
+
+    double toMiB(VkDeviceSize bytes) {
+        return static_cast<double>(bytes) / (1024.0 * 1024.0);
+    }
+}
+
+const char* memoryCategoryName(MemoryCategory category) {
+    return CATEGORY_NAMES[static_cast<size_t>(category)];
+}
+
+void MemoryTelemetry::create(VmaAllocator allocator) {
+    m_allocator = allocator;
+    const VkPhysicalDeviceMemoryProperties* memoryProperties = nullptr;
+    vmaGetMemoryProperties(m_allocator, &memoryProperties);
+    m_heaps.assign(memoryProperties->memoryHeapCount, {});
+    m_budgetWarned.assign(memoryProperties->memoryHeapCount, false);
+    for (uint32_t i = 0; i < memoryProperties->memoryHeapCount; ++i) {
+        m_heaps[i].flags = memoryProperties->memoryHeaps[i].flags;
+        m_heaps[i].size = memoryProperties->memoryHeaps[i].size;
+    }
+    sample();
+}
+
+size_t MemoryTelemetry::destroy() {
+    if (m_allocator == VK_NULL_HANDLE) {
+        return 0;
+    }
+    sample();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& [allocation, entry] : m_allocations) {
+        fmt::println("memory leak: {} ({}, {} bytes)", entry.name, memoryCategoryName(entry.category), entry.size);
+    }
+    // 没有登记过的分配不在上面的列表里，只能从VMA的统计中得到数量
+    uint32_t vmaAllocationCount = 0;
+    for (const HeapTelemetry& heap : m_heaps) {
+        vmaAllocationCount += heap.allocationCount;
+    }
+    if (vmaAllocationCount > m_allocations.size()) {
+        fmt::println("memory leak: {} untracked allocations", vmaAllocationCount - m_allocations.size());
+    }
+    const size_t leaks = std::max<size_t>(vmaAllocationCount, m_allocations.size());
+    m_allocations.clear();
+    m_heaps.clear();
+    m_budgetWarned.clear();
+    m_allocator = VK_NULL_HANDLE;
+    return leaks;
+}
+
+void MemoryTelemetry::track(VmaAllocation allocation, MemoryCategory category, const std::string& name) {
+    vmaSetAllocationName(m_allocator, allocation, name.c_str());
+    VmaAllocationInfo allocationInfo;
+    vmaGetAllocationInfo(m_allocator, allocation, &allocationInfo);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_allocations[allocation] = { category, name, allocationInfo.size };
+}
+
+void MemoryTelemetry::untrack(VmaAllocation allocation) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_allocations.erase(allocation);
+}
+
+void MemoryTelemetry::update() {
+    if (Clock::now() - m_lastSample >= SAMPLE_INTERVAL) {
+        sample();
+    }
+}
+
+void MemoryTelemetry::sample() {
+    m_lastSample = Clock::now();
+    std::vector<VmaBudget> budgets(m_heaps.size());
+    vmaGetHeapBudgets(m_allocator, budgets.data());
+    VmaTotalStatistics statistics;
+    vmaCalculateStatistics(m_allocator, &statistics);
+
+    for (uint32_t i = 0; i < m_heaps.size(); ++i) {
+        HeapTelemetry& heap = m_heaps[i];
+        const VmaDetailedStatistics& detailed = statistics.memoryHeap[i];
+        heap.budget = budgets[i].budget;
+        heap.usage = budgets[i].usage;
+        heap.peakUsage = std::max(heap.peakUsage, heap.usage);
+        heap.blockBytes = detailed.statistics.blockBytes;
+        heap.allocationBytes = detailed.statistics.allocationBytes;
+        heap.blockCount = detailed.statistics.blockCount;
+        heap.allocationCount = detailed.statistics.allocationCount;
+        const VkDeviceSize unusedBytes = heap.blockBytes - heap.allocationBytes;
+        heap.fragmentation = unusedBytes > 0 && detailed.unusedRangeCount > 0 ?
+            1.0 - static_cast<double>(detailed.unusedRangeSizeMax) / static_cast<double>(unusedBytes) : 0.0;
+
+        // 回落到阈值以下后再次超过时重新警告
+        const bool overBudget = heap.budget > 0 && heap.usage > heap.budget * BUDGET_WARNING_RATIO;
+        if (overBudget && !m_budgetWarned[i]) {
+            fmt::println("warning: memory heap {} usage {:.1f} MiB is over {:.0f}% of its {:.1f} MiB budget",
+                i, toMiB(heap.usage), BUDGET_WARNING_RATIO * 100.0, toMiB(heap.budget));
+        }
+        m_budgetWarned[i] = overBudget;
+    }
+}
+
+std::array<CategoryTelemetry, static_cast<size_t>(MemoryCategory::Count)> MemoryTelemetry::categoryTotals() const {
+    std::array<CategoryTelemetry, static_cast<size_t>(MemoryCategory::Count)> totals {};
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& [allocation, entry] : m_allocations) {
+        CategoryTelemetry& total = totals[static_cast<size_t>(entry.category)];
+        ++total.count;
+        total.bytes += entry.size;
+    }
+    return totals;
+}
+
+void MemoryTelemetry::printSummary() const {
+    for (size_t i = 0; i < m_heaps.size(); ++i) {
+        const HeapTelemetry& heap = m_heaps[i];
+        fmt::println("memory heap {}{}: peak {:.1f} MiB, budget {:.1f} MiB, {} blocks {:.1f} MiB, {} allocations {:.1f} MiB, fragmentation {:.1f}%",
+            i, (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? " (device local)" : "", toMiB(heap.peakUsage), toMiB(heap.budget),
+            heap.blockCount, toMiB(heap.blockBytes), heap.allocationCount, toMiB(heap.allocationBytes), heap.fragmentation * 100.0);
+    }
+    const auto totals = categoryTotals();
+    for (size_t i = 0; i < totals.size(); ++i) {
+        if (totals[i].count > 0) {
+            fmt::println("memory {:<10} {:>4} allocations {:>10.2f} MiB", CATEGORY_NAMES[i], totals[i].count, toMiB(totals[i].bytes));
+        }
+    }
+}
+
+bool MemoryTelemetry::writeSnapshot(const std::string& path) {
+    sample();
+
+    // 分配名称都是代码中的字符串，不含需要转义的字符
+    std::string json = "{\n\"heaps\":[";
+    for (size_t i = 0; i < m_heaps.size(); ++i) {
+        const HeapTelemetry& heap = m_heaps[i];
+        json += fmt::format("{}\n{{\"index\":{},\"deviceLocal\":{},\"size\":{},\"budget\":{},\"usage\":{},\"peakUsage\":{},"
+            "\"blockCount\":{},\"blockBytes\":{},\"allocationCount\":{},\"allocationBytes\":{},\"fragmentation\":{:.4f}}}",
+            i == 0 ? "" : ",", i, (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0, heap.size, heap.budget, heap.usage,
+            heap.peakUsage, heap.blockCount, heap.blockBytes, heap.allocationCount, heap.allocationBytes, heap.fragmentation);
+    }
+    json += "\n],\n\"categories\":{";
+    const auto totals = categoryTotals();
+    for (size_t i = 0; i < totals.size(); ++i) {
+        json += fmt::format("{}\n\"{}\":{{\"count\":{},\"bytes\":{}}}", i == 0 ? "" : ",", CATEGORY_NAMES[i], totals[i].count, totals[i].bytes);
+    }
+    json += "\n},\n\"allocations\":[";
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        bool first = true;
+        for (const auto& [allocation, entry] : m_allocations) {
+            json += fmt::format("{}\n{{\"name\":\"{}\",\"category\":\"{}\",\"size\":{}}}",
+                first ? "" : ",", entry.name, memoryCategoryName(entry.category), entry.size);
+            first = false;
+        }
+    }
+    // VMA自带的详细统计（每个内存块中的分配与空闲区间），本身就是一个JSON对象
+    char* vmaStats = nullptr;
+    vmaBuildStatsString(m_allocator, &vmaStats, VK_TRUE);
+    json += "\n],\n\"vma\":";
+    json += vmaStats;
+    json += "\n}\n";
+    vmaFreeStatsString(m_allocator, vmaStats);
+
+    if (!writeFileAtomically(path, json.data(), json.size())) {
+        return false;
+    }
+    fmt::println("memory snapshot written to {}", path);
+    return true;
+}
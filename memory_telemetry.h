@@ -0,0 +1,89 @@
+#ifndef MEMORY_TELEMETRY_H
+#define MEMORY_TELEMETRY_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <vk_api.h>
+
+enum class MemoryCategory : uint32_t {
+    Vertex,
+    Index,
+    Texture,
+    Uniform,
+    Storage,
+    Staging,
+    Attachment,
+    Count
+};
+
+const char* memoryCategoryName(MemoryCategory category);
+
+// 一个内存堆最近一次采样的结果
+struct HeapTelemetry {
+    VkMemoryHeapFlags flags { 0 };
+    VkDeviceSize      size { 0 };
+    VkDeviceSize      budget { 0 };          // vmaGetHeapBudgets，没有VK_EXT_memory_budget时是VMA的估计值
+    VkDeviceSize      usage { 0 };           // 整个进程在该堆上的用量，包含VMA之外的分配
+    VkDeviceSize      peakUsage { 0 };
+    VkDeviceSize      blockBytes { 0 };      // VMA向驱动申请的VkDeviceMemory总大小
+    VkDeviceSize      allocationBytes { 0 }; // 其中被分配占用的部分
+    uint32_t          blockCount { 0 };
+    uint32_t          allocationCount { 0 };
+    double            fragmentation { 0.0 }; // 1 - 最大空闲区间 / 空闲总量，0表示空闲空间是连续的
+};
+
+struct CategoryTelemetry {
+    uint32_t     count { 0 };
+    VkDeviceSize bytes { 0 };
+};
+
+// 显存遥测：每个VMA分配创建后用track()登记名称与类别（同时写入VmaAllocation的名称，在VMA的统计JSON中可见），
+// 销毁前用untrack()注销。update()每帧调用，每隔SAMPLE_INTERVAL用vmaGetHeapBudgets/vmaCalculateStatistics采样各堆的预算、
+// 用量与碎片率，用量超过预算的BUDGET_WARNING_RATIO时打印一次警告。
+// destroy()在vmaDestroyAllocator之前调用，报告仍未注销的分配（泄漏）。track/untrack可以在多个线程中调用
+class MemoryTelemetry {
+public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr Clock::duration SAMPLE_INTERVAL = std::chrono::seconds(1);
+    static constexpr double BUDGET_WARNING_RATIO = 0.9;
+
+    void create(VmaAllocator allocator);
+    // 返回泄漏的分配数量
+    size_t destroy();
+
+    void track(VmaAllocation allocation, MemoryCategory category, const std::string& name);
+    void untrack(VmaAllocation allocation);
+
+    void update();
+    void sample();
+
+    const std::vector<HeapTelemetry>& heaps() const { return m_heaps; }
+    std::array<CategoryTelemetry, static_cast<size_t>(MemoryCategory::Count)> categoryTotals() const;
+
+    // 各堆的峰值用量、预算与碎片率，以及各类别的分配总量
+    void printSummary() const;
+    // 立即采样并写出JSON快照：各堆、各类别、每个登记的分配，以及vmaBuildStatsString的详细统计
+    bool writeSnapshot(const std::string& path);
+
+private:
+    struct Allocation {
+        MemoryCategory category;
+        std::string    name;
+        VkDeviceSize   size;
+    };
+
+    VmaAllocator                                  m_allocator { VK_NULL_HANDLE };
+    mutable std::mutex                            m_mutex;
+    std::unordered_map<VmaAllocation, Allocation> m_allocations;
+    std::vector<HeapTelemetry>                    m_heaps;
+    std::vector<bool>                             m_budgetWarned;
+    Clock::time_point                             m_lastSample;
+};
+
+#endif // MEMORY_TELEMETRY_H
@@ -0,0 +1,231 @@
+#ifndef MESH_BUILDER_H
+#define MESH_BUILDER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "job_system.h"
+#include "vertex_weld_table.h"
+
+// 把 [0, count) 平均切分为 chunkCount 块，每块一个任务执行 fn(begin, end, chunkIndex)，调用线程执行第一块后在wait()中帮忙执行其余块。
+// 所有块结束后才返回；任一块抛出异常时重新抛出（调用线程的异常优先）
+template <typename Fn>
+void parallelForChunks(JobSystem& jobs, size_t count, size_t chunkCount, const Fn& fn) {
+    if (chunkCount <= 1) {
+        fn(size_t{ 0 }, count, size_t{ 0 });
+        return;
+    }
+
+    JobCounter counter;
+    for (size_t chunk = 1; chunk < chunkCount; ++chunk) {
+        jobs.spawn([&fn, count, chunkCount, chunk]() {
+            fn(count * chunk / chunkCount, count * (chunk + 1) / chunkCount, chunk);
+        }, &counter);
+    }
+    // 其他块引用了fn与调用方的局部变量，第一块出错时也要等它们结束
+    std::exception_ptr error;
+    try {
+        fn(size_t{ 0 }, count / chunkCount, size_t{ 0 });
+    } catch (...) {
+        error = std::current_exception();
+    }
+    try {
+        jobs.wait(counter);
+    } catch (...) {
+        if (!error) {
+            error = std::current_exception();
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// 预留的唯一顶点数量：三角网格的唯一顶点通常不超过索引数的一半，超出时哈希表自动扩容
+inline size_t estimateUniqueVertexCount(size_t indexCount) {
+    return indexCount / 2 + 1;
+}
+
+// 单线程顶点去重：fetch(i) 返回索引流中第 i 个顶点，输出按首次出现顺序排列的唯一顶点及索引
+template <typename VertexT, typename Fetch, typename Hash = FloatVertexHash<VertexT>>
+void buildIndexedMesh(size_t count, const Fetch& fetch, std::vector<VertexT>& vertices, std::vector<uint32_t>& indices) {
+    Hash hasher{};
+    VertexWeldTable uniqueVertices;
+    uniqueVertices.reserve(estimateUniqueVertexCount(count));
+    auto keyAt = [&vertices](uint32_t value) -> const VertexT& { return vertices[value]; };
+
+    vertices.clear();
+    vertices.reserve(estimateUniqueVertexCount(count));
+    indices.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const VertexT vertex = fetch(i);
+        auto [index, inserted] = uniqueVertices.findOrInsert(vertex, hasher(vertex),
+            static_cast<uint32_t>(vertices.size()), keyAt, hasher);
+        if (inserted) {
+            vertices.push_back(vertex);
+        }
+        indices[i] = index;
+    }
+}
+
+// 原始实现：std::unordered_map + count()/operator[] 两次查找，仅作为基准测试的对照组
+template <typename VertexT, typename Fetch, typename Hash = std::hash<VertexT>>
+void buildIndexedMeshUnorderedMap(size_t count, const Fetch& fetch, std::vector<VertexT>& vertices, std::vector<uint32_t>& indices) {
+    std::unordered_map<VertexT, uint32_t, Hash> uniqueVertices{};
+
+    vertices.clear();
+    indices.clear();
+    indices.reserve(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        VertexT vertex = fetch(i);
+
+        if (uniqueVertices.count(vertex) == 0) {
+            uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+            vertices.push_back(vertex);
+        }
+
+        indices.push_back(uniqueVertices[vertex]);
+    }
+}
+
+constexpr size_t MESH_BUILDER_MIN_CHUNK_SIZE = 64 * 1024; // 每个线程至少处理的索引数量，太小时线程开销大于收益
+
+// 多线程顶点去重，输出与 buildIndexedMesh 完全一致（顶点按全局首次出现顺序编号）：
+//   1. 索引流按线程切块，每块独立去重，得到块内唯一顶点（按块内首次出现顺序）
+//   2. 按哈希值把块内唯一顶点分片，每个分片由一个线程按块顺序合并，记录每个顶点的首次出现位置
+//   3. 按块顺序前缀和为首次出现的顶点分配全局编号
+//   4. 各块并行把块内索引重写为全局编号
+// 各阶段的块在jobs上执行，threadCount为切分的块数
+template <typename VertexT, typename Fetch, typename Hash = FloatVertexHash<VertexT>>
+void buildIndexedMeshParallel(size_t count, const Fetch& fetch, JobSystem& jobs, size_t threadCount,
+                              std::vector<VertexT>& vertices, std::vector<uint32_t>& indices) {
+    const size_t chunkCount = std::max<size_t>(1, std::min(threadCount, count / MESH_BUILDER_MIN_CHUNK_SIZE));
+    if (chunkCount == 1) {
+        buildIndexedMesh<VertexT, Fetch, Hash>(count, fetch, vertices, indices);
+        return;
+    }
+
+    struct LocalRef {
+        uint32_t chunk;
+        uint32_t local;
+    };
+
+    struct Chunk {
+        size_t                begin = 0;
+        std::vector<VertexT>  vertices;     // 块内唯一顶点
+        std::vector<uint64_t> hashes;       // 对应顶点的哈希，分片阶段复用
+        std::vector<uint32_t> indices;      // 块内局部编号
+        std::vector<LocalRef> owner;        // 该顶点全局首次出现的位置
+        std::vector<uint32_t> globalIds;
+        uint32_t              firstCount = 0;
+    };
+
+    std::vector<Chunk> chunks(chunkCount);
+    Hash hasher{};
+
+    // 1. 块内去重
+    parallelForChunks(jobs, count, chunkCount, [&](size_t begin, size_t end, size_t c) {
+        Chunk& chunk = chunks[c];
+        chunk.begin = begin;
+        VertexWeldTable uniqueVertices;
+        uniqueVertices.reserve(estimateUniqueVertexCount(end - begin));
+        auto keyAt = [&chunk](uint32_t value) -> const VertexT& { return chunk.vertices[value]; };
+        chunk.vertices.reserve(estimateUniqueVertexCount(end - begin));
+        chunk.hashes.reserve(estimateUniqueVertexCount(end - begin));
+        chunk.indices.resize(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            const VertexT vertex = fetch(i);
+            const uint64_t hash = hasher(vertex);
+            auto [index, inserted] = uniqueVertices.findOrInsert(vertex, hash,
+                static_cast<uint32_t>(chunk.vertices.size()), keyAt, hasher);
+            if (inserted) {
+                chunk.vertices.push_back(vertex);
+                chunk.hashes.push_back(hash);
+            }
+            chunk.indices[i - begin] = index;
+        }
+        chunk.owner.resize(chunk.vertices.size());
+        chunk.globalIds.resize(chunk.vertices.size());
+    });
+
+    // 2. 按哈希分片合并，每个分片内部按 (块, 块内编号) 顺序遍历，首个插入者即全局首次出现
+    const size_t shardCount = chunkCount;
+    parallelForChunks(jobs, shardCount, shardCount, [&](size_t, size_t, size_t shard) {
+        // 表中的值是分片内首次出现顶点的编号，firstRefs记录其所在位置
+        std::vector<LocalRef> firstRefs;
+        VertexWeldTable shardVertices;
+        shardVertices.reserve(chunks[0].vertices.size() / shardCount + 1);
+        auto keyAt = [&](uint32_t value) -> const VertexT& {
+            return chunks[firstRefs[value].chunk].vertices[firstRefs[value].local];
+        };
+        for (uint32_t c = 0; c < chunkCount; ++c) {
+            Chunk& chunk = chunks[c];
+            for (uint32_t l = 0; l < chunk.vertices.size(); ++l) {
+                // 用哈希的高位分片，低位留给表内寻址，避免分片后槽位分布退化
+                if ((chunk.hashes[l] >> 48) % shardCount != shard) {
+                    continue;
+                }
+                auto [value, inserted] = shardVertices.findOrInsert(chunk.vertices[l], chunk.hashes[l],
+                    static_cast<uint32_t>(firstRefs.size()), keyAt, hasher);
+                if (inserted) {
+                    firstRefs.push_back(LocalRef{ c, l });
+                }
+                chunk.owner[l] = firstRefs[value];
+            }
+        }
+    });
+
+    // 3. 为首次出现的顶点分配全局编号
+    std::vector<uint32_t> chunkBase(chunkCount, 0);
+    parallelForChunks(jobs, chunkCount, chunkCount, [&](size_t, size_t, size_t c) {
+        Chunk& chunk = chunks[c];
+        for (uint32_t l = 0; l < chunk.vertices.size(); ++l) {
+            if (chunk.owner[l].chunk == c && chunk.owner[l].local == l) {
+                ++chunk.firstCount;
+            }
+        }
+    });
+    uint32_t uniqueCount = 0;
+    for (size_t c = 0; c < chunkCount; ++c) {
+        chunkBase[c] = uniqueCount;
+        uniqueCount += chunks[c].firstCount;
+    }
+
+    vertices.resize(uniqueCount);
+    indices.resize(count);
+
+    parallelForChunks(jobs, chunkCount, chunkCount, [&](size_t, size_t, size_t c) {
+        Chunk& chunk = chunks[c];
+        uint32_t next = chunkBase[c];
+        for (uint32_t l = 0; l < chunk.vertices.size(); ++l) {
+            if (chunk.owner[l].chunk == c && chunk.owner[l].local == l) {
+                chunk.globalIds[l] = next;
+                vertices[next] = chunk.vertices[l];
+                ++next;
+            }
+        }
+    });
+
+    // 4. 解析非首次出现顶点的全局编号并重写索引
+    parallelForChunks(jobs, chunkCount, chunkCount, [&](size_t, size_t, size_t c) {
+        Chunk& chunk = chunks[c];
+        for (uint32_t l = 0; l < chunk.vertices.size(); ++l) {
+            const LocalRef owner = chunk.owner[l];
+            if (owner.chunk != c || owner.local != l) {
+                chunk.globalIds[l] = chunks[owner.chunk].globalIds[owner.local];
+            }
+        }
+        for (size_t i = 0; i < chunk.indices.size(); ++i) {
+            indices[chunk.begin + i] = chunk.globalIds[chunk.indices[i]];
+        }
+    });
+}
+
+#endif // MESH_BUILDER_H
@@ -0,0 +1,349 @@
+#include "mesh_cache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_data = other.m_data;
+        m_size = other.m_size;
+        other.m_data = nullptr;
+        other.m_size = 0;
+#ifdef _WIN32
+        m_file = other.m_file;
+        m_mapping = other.m_mapping;
+        other.m_file = nullptr;
+        other.m_mapping = nullptr;
+#endif
+    }
+    return *this;
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize{};
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // 映射建立后文件描述符不再需要
+    if (view == MAP_FAILED) {
+        return false;
+    }
+    m_data = static_cast<const uint8_t*>(view);
+    m_size = static_cast<size_t>(st.st_size);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_data == nullptr) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(m_data);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+    CloseHandle(static_cast<HANDLE>(m_file));
+    m_mapping = nullptr;
+    m_file = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+    m_data = nullptr;
+    m_size = 0;
+}
+
+namespace {
+    // xxHash64
+    constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ULL;
+    constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+    constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ULL;
+    constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+    constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+    inline uint64_t rotl64(uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    inline uint64_t read64(const uint8_t* p) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline uint32_t read32(const uint8_t* p) {
+        uint32_t v;
+        memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline uint64_t round64(uint64_t acc, uint64_t input) {
+        acc += input * PRIME64_2;
+        acc = rotl64(acc, 31);
+        return acc * PRIME64_1;
+    }
+
+    inline uint64_t mergeRound64(uint64_t acc, uint64_t val) {
+        acc ^= round64(0, val);
+        return acc * PRIME64_1 + PRIME64_4;
+    }
+}
+
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    const uint8_t* end = p + size;
+    uint64_t h;
+
+    if (size >= 32) {
+        // 四路独立累加，充分利用指令级并行
+        uint64_t v1 = seed + PRIME64_1 + PRIME64_2;
+        uint64_t v2 = seed + PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - PRIME64_1;
+        const uint8_t* limit = end - 32;
+        do {
+            v1 = round64(v1, read64(p));
+            v2 = round64(v2, read64(p + 8));
+            v3 = round64(v3, read64(p + 16));
+            v4 = round64(v4, read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+        h = mergeRound64(h, v1);
+        h = mergeRound64(h, v2);
+        h = mergeRound64(h, v3);
+        h = mergeRound64(h, v4);
+    } else {
+        h = seed + PRIME64_5;
+    }
+
+    h += static_cast<uint64_t>(size);
+
+    while (p + 8 <= end) {
+        h ^= round64(0, read64(p));
+        h = rotl64(h, 27) * PRIME64_1 + PRIME64_4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * PRIME64_1;
+        h = rotl64(h, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= static_cast<uint64_t>(*p) * PRIME64_5;
+        h = rotl64(h, 11) * PRIME64_1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= PRIME64_2;
+    h ^= h >> 29;
+    h *= PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+bool hashFile(const std::string& path, uint64_t& hash) {
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    hash = hashBytes(file.data(), file.size());
+    return true;
+}
+
+namespace {
+    // 由write写入临时文件，全部成功后替换目标文件；任一步失败都删除临时文件
+    bool writeFileAtomically(const std::string& path, const std::function<bool(FILE*)>& write) {
+        const std::string tmpPath = path + ".tmp";
+        FILE* file = fopen(tmpPath.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        bool ok = write(file);
+        ok = (fclose(file) == 0) && ok;
+        if (!ok) {
+            remove(tmpPath.c_str());
+            return false;
+        }
+#ifdef _WIN32
+        if (!MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+#else
+        if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+#endif
+            remove(tmpPath.c_str());
+            return false;
+        }
+        return true;
+    }
+}
+
+bool writeFileAtomically(const std::string& path, const void* data, size_t size) {
+    return writeFileAtomically(path, [&](FILE* file) {
+        return size == 0 || fwrite(data, 1, size, file) == size;
+    });
+}
+
+bool MeshCache::open(const std::string& path, uint64_t sourceHash) {
+    close();
+    if (!m_file.open(path)) {
+        return false;
+    }
+    return parse(m_file.data(), m_file.size(), &sourceHash);
+}
+
+bool MeshCache::openMemory(const uint8_t* data, size_t size, const uint64_t* sourceHash) {
+    close();
+    return parse(data, size, sourceHash);
+}
+
+bool MeshCache::parse(const uint8_t* data, size_t fileSize, const uint64_t* sourceHash) {
+    if (fileSize < sizeof(MeshCacheHeader)) {
+        close();
+        return false;
+    }
+
+    MeshCacheHeader header{};
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != MESH_CACHE_MAGIC || header.version != MESH_CACHE_VERSION ||
+        (sourceHash != nullptr && header.sourceHash != *sourceHash)) {
+        close();
+        return false;
+    }
+
+    const uint64_t tableSize = static_cast<uint64_t>(header.sectionCount) * sizeof(MeshCacheSection);
+    if (sizeof(MeshCacheHeader) + tableSize > fileSize) {
+        close();
+        return false;
+    }
+
+    m_sections.resize(header.sectionCount);
+    memcpy(m_sections.data(), data + sizeof(MeshCacheHeader), static_cast<size_t>(tableSize));
+    for (const auto& section : m_sections) {
+        if (section.offset > fileSize || section.size > fileSize - section.offset) {
+            close();
+            return false;
+        }
+    }
+    m_data = data;
+    return true;
+}
+
+void MeshCache::close() {
+    m_sections.clear();
+    m_data = nullptr;
+    m_file.close();
+}
+
+bool MeshCache::section(uint32_t id, uint32_t elementSize, MeshCacheBlob& blob) const {
+    for (const auto& section : m_sections) {
+        if (section.id == id) {
+            if (section.elementSize != elementSize) {
+                return false;
+            }
+            blob.data = m_data + section.offset;
+            blob.size = section.size;
+            blob.elementSize = section.elementSize;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MeshCacheWriter::addSection(uint32_t id, uint32_t elementSize, const void* data, uint64_t size) {
+    m_sections.push_back({ id, elementSize, data, size });
+}
+
+bool MeshCacheWriter::write(const std::string& path, uint64_t sourceHash) const {
+    auto alignUp = [](uint64_t value) {
+        return (value + MESH_CACHE_ALIGNMENT - 1) & ~(MESH_CACHE_ALIGNMENT - 1);
+    };
+
+    MeshCacheHeader header{};
+    header.magic = MESH_CACHE_MAGIC;
+    header.version = MESH_CACHE_VERSION;
+    header.sourceHash = sourceHash;
+    header.sectionCount = static_cast<uint32_t>(m_sections.size());
+
+    std::vector<MeshCacheSection> table(m_sections.size());
+    uint64_t offset = alignUp(sizeof(MeshCacheHeader) + sizeof(MeshCacheSection) * table.size());
+    for (size_t i = 0; i < m_sections.size(); ++i) {
+        table[i].id = m_sections[i].id;
+        table[i].elementSize = m_sections[i].elementSize;
+        table[i].offset = offset;
+        table[i].size = m_sections[i].size;
+        offset = alignUp(offset + m_sections[i].size);
+    }
+
+    static const uint8_t zeros[MESH_CACHE_ALIGNMENT] = {};
+    return writeFileAtomically(path, [&](FILE* file) {
+        bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+        if (!table.empty()) {
+            ok = ok && fwrite(table.data(), sizeof(MeshCacheSection), table.size(), file) == table.size();
+        }
+        uint64_t written = sizeof(MeshCacheHeader) + sizeof(MeshCacheSection) * table.size();
+        for (size_t i = 0; ok && i < m_sections.size(); ++i) {
+            const size_t padding = static_cast<size_t>(table[i].offset - written);
+            ok = ok && (padding == 0 || fwrite(zeros, 1, padding, file) == padding);
+            const size_t size = static_cast<size_t>(m_sections[i].size);
+            ok = ok && (size == 0 || fwrite(m_sections[i].data, 1, size, file) == size);
+            written = table[i].offset + m_sections[i].size;
+        }
+        return ok;
+    });
+}
@@ -0,0 +1,128 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 只读内存映射文件，析构时自动解除映射
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const uint8_t* m_data { nullptr };
+    size_t         m_size { 0 };
+#ifdef _WIN32
+    void*          m_file { nullptr };
+    void*          m_mapping { nullptr };
+#endif
+};
+
+// 64位内容哈希，用于判断源文件是否发生变化
+uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0);
+
+// 对整个文件内容做哈希，文件不存在时返回false
+bool hashFile(const std::string& path, uint64_t& hash);
+
+// 先写入临时文件再重命名，避免进程中途退出留下半个文件
+bool writeFileAtomically(const std::string& path, const void* data, size_t size);
+
+constexpr uint32_t makeFourCC(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) |
+           (static_cast<uint32_t>(c) << 16) | (static_cast<uint32_t>(d) << 24);
+}
+
+// 网格缓存文件布局：
+//   MeshCacheHeader | MeshCacheSection[sectionCount] | 按 MESH_CACHE_ALIGNMENT 对齐的数据块...
+// 每个数据块由四字符码标识，读取时直接返回映射内存中的指针，不做任何拷贝。
+// 处理流程（去重、排序、量化等）改变时必须递增 MESH_CACHE_VERSION，使旧缓存失效。
+constexpr uint32_t MESH_CACHE_MAGIC = makeFourCC('K', 'V', 'M', 'C');
+constexpr uint32_t MESH_CACHE_VERSION = 6;
+constexpr uint64_t MESH_CACHE_ALIGNMENT = 64;
+
+constexpr uint32_t MESH_SECTION_VERTICES = makeFourCC('V', 'E', 'R', 'T');
+constexpr uint32_t MESH_SECTION_INDICES = makeFourCC('I', 'N', 'D', 'X');
+constexpr uint32_t MESH_SECTION_BOUNDS = makeFourCC('B', 'N', 'D', 'S');
+constexpr uint32_t MESH_SECTION_CHUNKS = makeFourCC('C', 'H', 'N', 'K');
+constexpr uint32_t MESH_SECTION_MESHLETS = makeFourCC('M', 'S', 'H', 'L');
+constexpr uint32_t MESH_SECTION_LODS = makeFourCC('L', 'O', 'D', 'S');
+
+struct MeshCacheHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t sourceHash;
+    uint32_t sectionCount;
+    uint32_t reserved;
+};
+
+struct MeshCacheSection {
+    uint32_t id;
+    uint32_t elementSize;
+    uint64_t offset;
+    uint64_t size;
+};
+
+struct MeshCacheBlob {
+    const void* data { nullptr };
+    uint64_t    size { 0 };
+    uint32_t    elementSize { 0 };
+
+    uint64_t count() const { return elementSize != 0 ? size / elementSize : 0; }
+};
+
+class MeshCache {
+public:
+    // 映射缓存文件并校验魔数、版本与源文件哈希，任一不匹配都视为未命中
+    bool open(const std::string& path, uint64_t sourceHash);
+    // 使用调用方持有的内存（资源归档中的缓存），同样校验魔数、版本与源文件哈希；sourceHash为nullptr时（源文件不存在）不校验哈希
+    bool openMemory(const uint8_t* data, size_t size, const uint64_t* sourceHash);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+
+    // 查找指定数据块，elementSize不一致时视为不存在
+    bool section(uint32_t id, uint32_t elementSize, MeshCacheBlob& blob) const;
+
+private:
+    // sourceHash为nullptr时不校验源文件哈希
+    bool parse(const uint8_t* data, size_t size, const uint64_t* sourceHash);
+
+    MappedFile                    m_file;
+    const uint8_t*                m_data { nullptr }; // 指向m_file或调用方的内存
+    std::vector<MeshCacheSection> m_sections;
+};
+
+class MeshCacheWriter {
+public:
+    // 数据在write()之前必须保持有效
+    void addSection(uint32_t id, uint32_t elementSize, const void* data, uint64_t size);
+
+    // 先写入临时文件再重命名，避免进程中途退出留下半个缓存文件
+    bool write(const std::string& path, uint64_t sourceHash) const;
+
+private:
+    struct PendingSection {
+        uint32_t    id;
+        uint32_t    elementSize;
+        const void* data;
+        uint64_t    size;
+    };
+    std::vector<PendingSection> m_sections;
+};
+
+#endif // MESH_CACHE_H
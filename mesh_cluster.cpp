@@ -0,0 +1,154 @@
+#include "mesh_cluster.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace {
+    struct Vec3 {
+        float x, y, z;
+    };
+
+    Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    Vec3 operator+(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+    Vec3 operator*(const Vec3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+    float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vec3 cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    float length(const Vec3& a) { return std::sqrt(dot(a, a)); }
+
+    // 锥剔除被禁用时的cutoff：余弦不可能大于1，剔除条件永远不成立
+    constexpr float CONE_DISABLED = 2.0f;
+
+    Vec3 loadPosition(const float* positions, size_t positionStride, size_t vertex) {
+        const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + positionStride * vertex);
+        return { p[0], p[1], p[2] };
+    }
+
+    // 包围球取AABB中心与最远顶点距离；法线锥按 meshoptimizer 的方法取三角形单位法线的平均方向，
+    // 锥顶沿锥轴后退到所有三角形平面的背后，保证相机落在锥内时整簇三角形都是背面
+    void computeMeshletBounds(Meshlet& meshlet, const uint16_t* indices, const float* positions, size_t positionStride) {
+        const uint32_t triangleCount = meshlet.indexCount / 3;
+        auto corner = [&](uint32_t triangle, uint32_t k) {
+            const uint16_t local = indices[meshlet.firstIndex + triangle * 3 + k];
+            return loadPosition(positions, positionStride, static_cast<size_t>(meshlet.vertexOffset) + local);
+        };
+
+        Vec3 lo{ FLT_MAX, FLT_MAX, FLT_MAX };
+        Vec3 hi{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (uint32_t t = 0; t < triangleCount; ++t) {
+            for (uint32_t k = 0; k < 3; ++k) {
+                const Vec3 p = corner(t, k);
+                lo = { std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z) };
+                hi = { std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z) };
+            }
+        }
+        const Vec3 center = (lo + hi) * 0.5f;
+        float radius = 0.0f;
+        for (uint32_t t = 0; t < triangleCount; ++t) {
+            for (uint32_t k = 0; k < 3; ++k) {
+                radius = std::max(radius, length(corner(t, k) - center));
+            }
+        }
+
+        // 退化三角形的法线记为零向量，不参与锥的计算
+        std::vector<Vec3> normals(triangleCount, Vec3{ 0.0f, 0.0f, 0.0f });
+        Vec3 axis{ 0.0f, 0.0f, 0.0f };
+        for (uint32_t t = 0; t < triangleCount; ++t) {
+            const Vec3 p0 = corner(t, 0);
+            const Vec3 n = cross(corner(t, 1) - p0, corner(t, 2) - p0);
+            const float area = length(n);
+            if (area > 0.0f) {
+                normals[t] = n * (1.0f / area);
+                axis = axis + normals[t];
+            }
+        }
+
+        float coneCutoff = CONE_DISABLED;
+        Vec3 apex = center;
+        const float axisLength = length(axis);
+        if (axisLength > 0.0f) {
+            axis = axis * (1.0f / axisLength);
+            float minDot = 1.0f;
+            for (const Vec3& n : normals) {
+                if (dot(n, n) > 0.0f) {
+                    minDot = std::min(minDot, dot(axis, n));
+                }
+            }
+            // 法线张开接近90度时锥几乎不可能剔除任何东西，直接禁用
+            if (minDot > 0.1f) {
+                float maxT = 0.0f;
+                for (uint32_t t = 0; t < triangleCount; ++t) {
+                    const Vec3& n = normals[t];
+                    if (dot(n, n) > 0.0f) {
+                        maxT = std::max(maxT, dot(center - corner(t, 0), n) / dot(axis, n));
+                    }
+                }
+                apex = center - axis * maxT;
+                coneCutoff = std::sqrt(1.0f - minDot * minDot);
+            }
+        }
+
+        meshlet.center[0] = center.x;
+        meshlet.center[1] = center.y;
+        meshlet.center[2] = center.z;
+        meshlet.radius = radius;
+        meshlet.coneApex[0] = apex.x;
+        meshlet.coneApex[1] = apex.y;
+        meshlet.coneApex[2] = apex.z;
+        meshlet.coneCutoff = coneCutoff;
+        meshlet.coneAxis[0] = axis.x;
+        meshlet.coneAxis[1] = axis.y;
+        meshlet.coneAxis[2] = axis.z;
+    }
+}
+
+void buildMeshlets(std::vector<Meshlet>& meshlets, const uint16_t* indices, const MeshChunk* chunks, size_t chunkCount,
+                   const float* positions, size_t positionStride, uint32_t maxVertices, uint32_t maxTriangles) {
+    meshlets.clear();
+
+    // stamps[v]等于当前簇编号表示块内顶点v已计入当前簇
+    std::vector<uint32_t> stamps;
+    uint32_t stamp = 0;
+
+    for (size_t c = 0; c < chunkCount; ++c) {
+        const MeshChunk& chunk = chunks[c];
+        stamps.assign(chunk.vertexCount, UINT32_MAX);
+
+        Meshlet meshlet{};
+        meshlet.firstIndex = chunk.firstIndex;
+        meshlet.vertexOffset = chunk.vertexOffset;
+        uint32_t vertexCount = 0;
+
+        auto flush = [&]() {
+            if (meshlet.indexCount > 0) {
+                computeMeshletBounds(meshlet, indices, positions, positionStride);
+                meshlets.push_back(meshlet);
+            }
+            meshlet.firstIndex += meshlet.indexCount;
+            meshlet.indexCount = 0;
+            vertexCount = 0;
+            ++stamp;
+        };
+
+        for (uint32_t i = 0; i + 2 < chunk.indexCount; i += 3) {
+            const uint16_t* triangle = indices + chunk.firstIndex + i;
+            uint32_t newVertices = 0;
+            for (uint32_t k = 0; k < 3; ++k) {
+                const bool seen = stamps[triangle[k]] == stamp ||
+                    (k > 0 && triangle[k] == triangle[0]) || (k > 1 && triangle[k] == triangle[1]);
+                newVertices += seen ? 0 : 1;
+            }
+            if (vertexCount + newVertices > maxVertices || meshlet.indexCount / 3 + 1 > maxTriangles) {
+                flush();
+            }
+            for (uint32_t k = 0; k < 3; ++k) {
+                if (stamps[triangle[k]] != stamp) {
+                    stamps[triangle[k]] = stamp;
+                    ++vertexCount;
+                }
+            }
+            meshlet.indexCount += 3;
+        }
+        flush();
+    }
+}
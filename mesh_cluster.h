@@ -0,0 +1,34 @@
+#ifndef MESH_CLUSTER_H
+#define MESH_CLUSTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "mesh_split.h"
+
+constexpr uint32_t MESHLET_MAX_VERTICES = 64;
+constexpr uint32_t MESHLET_MAX_TRIANGLES = 124;
+
+// 网格簇（meshlet）：索引缓冲区中连续的一段三角形，附带剔除用的包围球与法线锥。
+// 布局与 shaders/meshlet_cull.comp 中的 std430 结构体一致，所有坐标都在网格空间
+struct Meshlet {
+    float    center[3];
+    float    radius;
+    float    coneApex[3];
+    float    coneCutoff;  // 视线方向与锥轴夹角的余弦不小于它时整簇背面朝向相机；大于1表示不做锥剔除
+    float    coneAxis[3];
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t  vertexOffset;
+    uint32_t padding[2];
+};
+static_assert(sizeof(Meshlet) == 64, "Meshlet must match the std430 layout in meshlet_cull.comp");
+
+// 按三角形顺序把每个16位块切成不超过maxVertices个顶点、maxTriangles个三角形的簇，不改变索引顺序。
+// positions指向块顶点数组中第一个顶点的位置（3个float），块内第i个顶点位于 positions + (vertexOffset + i) * positionStride 字节处
+void buildMeshlets(std::vector<Meshlet>& meshlets, const uint16_t* indices, const MeshChunk* chunks, size_t chunkCount,
+                   const float* positions, size_t positionStride,
+                   uint32_t maxVertices = MESHLET_MAX_VERTICES, uint32_t maxTriangles = MESHLET_MAX_TRIANGLES);
+
+#endif // MESH_CLUSTER_H
@@ -0,0 +1,290 @@
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    constexpr uint32_t INVALID_VERTEX = UINT32_MAX;
+
+    // 顶点 -> 引用它的三角形列表，按CSR格式紧凑存放
+    struct TriangleAdjacency {
+        std::vector<uint32_t> counts;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> faces;
+    };
+
+    void buildTriangleAdjacency(TriangleAdjacency& adjacency, const uint32_t* indices, size_t indexCount, size_t vertexCount) {
+        const size_t faceCount = indexCount / 3;
+        adjacency.counts.assign(vertexCount, 0);
+        adjacency.offsets.resize(vertexCount);
+        adjacency.faces.resize(faceCount * 3);
+
+        for (size_t i = 0; i < faceCount * 3; ++i) {
+            ++adjacency.counts[indices[i]];
+        }
+        uint32_t offset = 0;
+        for (size_t v = 0; v < vertexCount; ++v) {
+            adjacency.offsets[v] = offset;
+            offset += adjacency.counts[v];
+        }
+
+        std::vector<uint32_t> fill(adjacency.offsets);
+        for (size_t face = 0; face < faceCount; ++face) {
+            for (size_t k = 0; k < 3; ++k) {
+                adjacency.faces[fill[indices[face * 3 + k]]++] = static_cast<uint32_t>(face);
+            }
+        }
+    }
+
+    // FIFO缓存：顶点在最近cacheSize次未命中之内被载入则视为命中。返回本三角形的未命中数
+    uint32_t updateCache(uint32_t a, uint32_t b, uint32_t c, uint32_t cacheSize, uint32_t* timestamps, uint32_t& timestamp) {
+        uint32_t misses = 0;
+        for (uint32_t v : { a, b, c }) {
+            if (timestamp - timestamps[v] > cacheSize) {
+                timestamps[v] = timestamp++;
+                ++misses;
+            }
+        }
+        return misses;
+    }
+
+    // 弹出死端栈，直到找到仍有未输出三角形的顶点
+    uint32_t popDeadEnd(std::vector<uint32_t>& deadEnd, const std::vector<uint32_t>& liveTriangles) {
+        while (!deadEnd.empty()) {
+            const uint32_t vertex = deadEnd.back();
+            deadEnd.pop_back();
+            if (liveTriangles[vertex] > 0) {
+                return vertex;
+            }
+        }
+        return INVALID_VERTEX;
+    }
+
+    struct Vec3 {
+        float x, y, z;
+    };
+
+    Vec3 loadPosition(const float* positions, size_t positionStride, uint32_t vertex) {
+        const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + positionStride * vertex);
+        return { p[0], p[1], p[2] };
+    }
+}
+
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+    VertexCacheStats stats{};
+    const size_t faceCount = indexCount / 3;
+    if (faceCount == 0 || vertexCount == 0) {
+        return stats;
+    }
+
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t timestamp = cacheSize + 1;
+    for (size_t face = 0; face < faceCount; ++face) {
+        stats.vertexTransforms += updateCache(indices[face * 3 + 0], indices[face * 3 + 1], indices[face * 3 + 2],
+            cacheSize, timestamps.data(), timestamp);
+    }
+
+    stats.acmr = static_cast<double>(stats.vertexTransforms) / faceCount;
+    stats.atvr = static_cast<double>(stats.vertexTransforms) / vertexCount;
+    return stats;
+}
+
+void optimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+    const size_t faceCount = indexCount / 3;
+    if (faceCount == 0 || vertexCount == 0) {
+        return;
+    }
+
+    TriangleAdjacency adjacency;
+    buildTriangleAdjacency(adjacency, indices, indexCount, vertexCount);
+
+    std::vector<uint32_t> liveTriangles(adjacency.counts);
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    std::vector<uint8_t>  emitted(faceCount, 0);
+    std::vector<uint32_t> deadEnd;
+    deadEnd.reserve(faceCount * 3);
+
+    uint32_t timestamp = cacheSize + 1;
+    size_t   cursor = 0;       // 死端栈为空时按编号顺序寻找下一个起点
+    size_t   outputCount = 0;
+    uint32_t current = 0;
+
+    while (current != INVALID_VERTEX) {
+        const size_t candidatesBegin = deadEnd.size();
+
+        // 输出当前顶点扇形中所有未输出的三角形
+        const uint32_t* faces = adjacency.faces.data() + adjacency.offsets[current];
+        for (uint32_t k = 0; k < adjacency.counts[current]; ++k) {
+            const uint32_t face = faces[k];
+            if (emitted[face]) {
+                continue;
+            }
+            emitted[face] = 1;
+            for (size_t corner = 0; corner < 3; ++corner) {
+                const uint32_t v = indices[face * 3 + corner];
+                destination[outputCount++] = v;
+                deadEnd.push_back(v);
+                --liveTriangles[v];
+                if (timestamp - timestamps[v] > cacheSize) {
+                    timestamps[v] = timestamp++;
+                }
+            }
+        }
+
+        // 在刚输出的顶点中选下一个扇形中心：优先选择处理完其余三角形后仍留在缓存中、且在缓存中最久的顶点
+        uint32_t best = INVALID_VERTEX;
+        int64_t  bestPriority = -1;
+        for (size_t i = candidatesBegin; i < deadEnd.size(); ++i) {
+            const uint32_t v = deadEnd[i];
+            if (liveTriangles[v] == 0) {
+                continue;
+            }
+            int64_t priority = 0;
+            const uint32_t age = timestamp - timestamps[v];
+            if (age + 2 * liveTriangles[v] <= cacheSize) {
+                priority = age;
+            }
+            if (priority > bestPriority) {
+                best = v;
+                bestPriority = priority;
+            }
+        }
+
+        if (best == INVALID_VERTEX) {
+            best = popDeadEnd(deadEnd, liveTriangles);
+        }
+        if (best == INVALID_VERTEX) {
+            while (cursor < vertexCount && liveTriangles[cursor] == 0) {
+                ++cursor;
+            }
+            best = cursor < vertexCount ? static_cast<uint32_t>(cursor) : INVALID_VERTEX;
+        }
+        current = best;
+    }
+}
+
+void optimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+                      const float* positions, size_t vertexCount, size_t positionStride,
+                      float threshold, uint32_t cacheSize) {
+    const size_t faceCount = indexCount / 3;
+    if (faceCount == 0 || vertexCount == 0) {
+        return;
+    }
+
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t timestamp = cacheSize + 1;
+
+    // 1. 硬边界：三个顶点全部未命中，说明Tipsify在这里跳到了网格的另一块区域
+    std::vector<uint32_t> hardBoundaries;
+    for (size_t face = 0; face < faceCount; ++face) {
+        const uint32_t misses = updateCache(indices[face * 3 + 0], indices[face * 3 + 1], indices[face * 3 + 2],
+            cacheSize, timestamps.data(), timestamp);
+        if (face == 0 || misses == 3) {
+            hardBoundaries.push_back(static_cast<uint32_t>(face));
+        }
+    }
+    hardBoundaries.push_back(static_cast<uint32_t>(faceCount));
+
+    // 2. 软边界：在簇内部累计的ACMR不超过整簇ACMR*threshold的位置继续切分，切分处视为缓存被清空
+    std::vector<uint32_t> clusters;
+    for (size_t h = 0; h + 1 < hardBoundaries.size(); ++h) {
+        const uint32_t begin = hardBoundaries[h];
+        const uint32_t end = hardBoundaries[h + 1];
+
+        timestamp += cacheSize + 1;
+        uint32_t clusterMisses = 0;
+        for (uint32_t face = begin; face < end; ++face) {
+            clusterMisses += updateCache(indices[face * 3 + 0], indices[face * 3 + 1], indices[face * 3 + 2],
+                cacheSize, timestamps.data(), timestamp);
+        }
+        const float clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+        clusters.push_back(begin);
+        timestamp += cacheSize + 1;
+        uint32_t runningMisses = 0;
+        uint32_t runningFaces = 0;
+        for (uint32_t face = begin; face < end; ++face) {
+            runningMisses += updateCache(indices[face * 3 + 0], indices[face * 3 + 1], indices[face * 3 + 2],
+                cacheSize, timestamps.data(), timestamp);
+            ++runningFaces;
+            if (static_cast<float>(runningMisses) / runningFaces <= clusterThreshold && face + 1 < end) {
+                clusters.push_back(face + 1);
+                timestamp += cacheSize + 1;
+                runningMisses = 0;
+                runningFaces = 0;
+            }
+        }
+    }
+    clusters.push_back(static_cast<uint32_t>(faceCount));
+
+    // 3. 以网格中心为参照，计算每个簇面积加权的中心与平均法线，越朝外的簇越先绘制
+    Vec3 meshCentroid{ 0.0f, 0.0f, 0.0f };
+    for (size_t i = 0; i < faceCount * 3; ++i) {
+        const Vec3 p = loadPosition(positions, positionStride, indices[i]);
+        meshCentroid.x += p.x;
+        meshCentroid.y += p.y;
+        meshCentroid.z += p.z;
+    }
+    const float invIndexCount = 1.0f / static_cast<float>(faceCount * 3);
+    meshCentroid = { meshCentroid.x * invIndexCount, meshCentroid.y * invIndexCount, meshCentroid.z * invIndexCount };
+
+    const size_t clusterCount = clusters.size() - 1;
+    std::vector<float> sortKeys(clusterCount);
+    for (size_t c = 0; c < clusterCount; ++c) {
+        Vec3 centroid{ 0.0f, 0.0f, 0.0f };
+        Vec3 normal{ 0.0f, 0.0f, 0.0f };
+        float area = 0.0f;
+        for (uint32_t face = clusters[c]; face < clusters[c + 1]; ++face) {
+            const Vec3 p0 = loadPosition(positions, positionStride, indices[face * 3 + 0]);
+            const Vec3 p1 = loadPosition(positions, positionStride, indices[face * 3 + 1]);
+            const Vec3 p2 = loadPosition(positions, positionStride, indices[face * 3 + 2]);
+            const Vec3 e1{ p1.x - p0.x, p1.y - p0.y, p1.z - p0.z };
+            const Vec3 e2{ p2.x - p0.x, p2.y - p0.y, p2.z - p0.z };
+            const Vec3 n{ e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+            const float faceArea = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+            centroid.x += (p0.x + p1.x + p2.x) / 3.0f * faceArea;
+            centroid.y += (p0.y + p1.y + p2.y) / 3.0f * faceArea;
+            centroid.z += (p0.z + p1.z + p2.z) / 3.0f * faceArea;
+            normal.x += n.x;
+            normal.y += n.y;
+            normal.z += n.z;
+            area += faceArea;
+        }
+
+        const float invArea = area > 0.0f ? 1.0f / area : 0.0f;
+        centroid = { centroid.x * invArea, centroid.y * invArea, centroid.z * invArea };
+        const float normalLength = std::sqrt(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+        const float invNormalLength = normalLength > 0.0f ? 1.0f / normalLength : 0.0f;
+
+        sortKeys[c] = ((centroid.x - meshCentroid.x) * normal.x +
+                       (centroid.y - meshCentroid.y) * normal.y +
+                       (centroid.z - meshCentroid.z) * normal.z) * invNormalLength;
+    }
+
+    std::vector<uint32_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    size_t outputCount = 0;
+    for (uint32_t c : order) {
+        const size_t begin = static_cast<size_t>(clusters[c]) * 3;
+        const size_t end = static_cast<size_t>(clusters[c + 1]) * 3;
+        std::copy(indices + begin, indices + end, destination + outputCount);
+        outputCount += end - begin;
+    }
+}
+
+size_t optimizeVertexFetchRemap(std::vector<uint32_t>& remap, uint32_t* indices, size_t indexCount, size_t vertexCount) {
+    remap.assign(vertexCount, INVALID_VERTEX);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+        uint32_t& mapped = remap[indices[i]];
+        if (mapped == INVALID_VERTEX) {
+            mapped = next++;
+        }
+        indices[i] = mapped;
+    }
+    return next;
+}
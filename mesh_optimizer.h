@@ -0,0 +1,56 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 顶点后变换缓存（post-transform vertex cache）的模拟大小，按常见硬件的FIFO深度取值
+constexpr uint32_t MESH_OPTIMIZER_CACHE_SIZE = 16;
+
+// 过度绘制优化允许的ACMR退化比例，1.05表示切分簇后ACMR最多变差5%
+constexpr float MESH_OPTIMIZER_OVERDRAW_THRESHOLD = 1.05f;
+
+struct VertexCacheStats {
+    uint32_t vertexTransforms { 0 }; // 缓存未命中次数，即顶点着色器实际执行次数
+    double   acmr { 0.0 };           // average cache miss ratio：每个三角形的未命中数，下限0.5，上限3
+    double   atvr { 0.0 };           // average transformed vertex ratio：未命中数/顶点数，理想值为1
+};
+
+// 用FIFO缓存模拟顶点着色器的执行次数，不依赖GPU，可以在任何机器上比较索引顺序的好坏
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                                    uint32_t cacheSize = MESH_OPTIMIZER_CACHE_SIZE);
+
+// Tipsify顶点缓存排序（Sander et al. 2007）：线性时间，按顶点扇形遍历三角形。
+// destination与indices不能指向同一块内存
+void optimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                         uint32_t cacheSize = MESH_OPTIMIZER_CACHE_SIZE);
+
+// 过度绘制优化，输入应当是optimizeVertexCache的结果：
+// 按缓存失效位置把三角形切成簇，在ACMR不超过threshold倍的前提下继续细分，
+// 再按簇朝外的程度从大到小排序，使外侧的面先绘制、内侧被遮挡的面能被深度测试提前剔除。
+// positions指向第一个顶点的位置（3个float），positionStride为相邻顶点的字节跨度
+void optimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+                      const float* positions, size_t vertexCount, size_t positionStride,
+                      float threshold = MESH_OPTIMIZER_OVERDRAW_THRESHOLD,
+                      uint32_t cacheSize = MESH_OPTIMIZER_CACHE_SIZE);
+
+// 顶点读取优化：按索引中首次引用的顺序为顶点重新编号并原地改写索引，未被引用的顶点被丢弃。
+// remap[旧编号] = 新编号（未引用为UINT32_MAX），返回新的顶点数量
+size_t optimizeVertexFetchRemap(std::vector<uint32_t>& remap, uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+template <typename VertexT>
+void optimizeVertexFetch(std::vector<VertexT>& vertices, std::vector<uint32_t>& indices) {
+    std::vector<uint32_t> remap;
+    const size_t uniqueCount = optimizeVertexFetchRemap(remap, indices.data(), indices.size(), vertices.size());
+
+    std::vector<VertexT> reordered(uniqueCount);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        if (remap[i] != UINT32_MAX) {
+            reordered[remap[i]] = vertices[i];
+        }
+    }
+    vertices.swap(reordered);
+}
+
+#endif // MESH_OPTIMIZER_H
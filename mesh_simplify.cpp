@@ -0,0 +1,342 @@
+#include "mesh_simplify.h"
+
+#include "mesh_optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace {
+    struct Vec3 {
+        float x, y, z;
+    };
+
+    Vec3 operator-(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    float dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    Vec3 cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+    Vec3 loadPosition(const float* positions, size_t positionStride, size_t vertex) {
+        const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + positionStride * vertex);
+        return { p[0], p[1], p[2] };
+    }
+
+    // 对称4x4矩阵 Q = sum(w * p * p^T)，p = (a, b, c, d) 为平面方程，weight = sum(w)；用double累加避免大网格上的精度损失
+    struct Quadric {
+        double a2, b2, c2, d2;
+        double ab, ac, ad;
+        double bc, bd, cd;
+        double weight;
+
+        Quadric& operator+=(const Quadric& q) {
+            a2 += q.a2; b2 += q.b2; c2 += q.c2; d2 += q.d2;
+            ab += q.ab; ac += q.ac; ad += q.ad;
+            bc += q.bc; bd += q.bd; cd += q.cd;
+            weight += q.weight;
+            return *this;
+        }
+    };
+
+    Quadric planeQuadric(double a, double b, double c, double d, double weight) {
+        return {
+            weight * a * a, weight * b * b, weight * c * c, weight * d * d,
+            weight * a * b, weight * a * c, weight * a * d,
+            weight * b * c, weight * b * d, weight * c * d,
+            weight,
+        };
+    }
+
+    // v^T Q v / weight，v = (x, y, z, 1)：点到累计平面距离平方的加权平均，与顶点位置单位的平方同量纲
+    double quadricError(const Quadric& q, const Vec3& v) {
+        if (q.weight <= 0.0) {
+            return 0.0;
+        }
+        const double x = v.x, y = v.y, z = v.z;
+        const double r = q.a2 * x * x + q.b2 * y * y + q.c2 * z * z + q.d2
+            + 2.0 * (q.ab * x * y + q.ac * x * z + q.bc * y * z)
+            + 2.0 * (q.ad * x + q.bd * y + q.cd * z);
+        return std::max(r, 0.0) / q.weight;
+    }
+
+    // 同一位置的所有顶点映射到其中编号最小的一个，用于识别纹理接缝并在位置层面累计二次误差
+    std::vector<uint32_t> buildPositionRemap(const float* positions, size_t vertexCount, size_t positionStride) {
+        std::vector<uint32_t> order(vertexCount);
+        std::iota(order.begin(), order.end(), 0u);
+        auto bits = [&](uint32_t v) {
+            const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + positionStride * v);
+            std::array<uint32_t, 3> key{};
+            std::memcpy(key.data(), p, sizeof(key));
+            return key;
+        };
+        std::sort(order.begin(), order.end(), [&](uint32_t l, uint32_t r) {
+            const auto kl = bits(l);
+            const auto kr = bits(r);
+            return kl != kr ? kl < kr : l < r;
+        });
+
+        std::vector<uint32_t> remap(vertexCount);
+        for (size_t i = 0; i < vertexCount;) {
+            size_t j = i + 1;
+            while (j < vertexCount && bits(order[j]) == bits(order[i])) {
+                ++j;
+            }
+            for (size_t k = i; k < j; ++k) {
+                remap[order[k]] = order[i];
+            }
+            i = j;
+        }
+        return remap;
+    }
+
+    // 锁定位置拓扑下的开放边/非流形边端点，以及有多个顶点（接缝）的位置
+    std::vector<uint8_t> buildLockedVertices(const uint32_t* indices, size_t indexCount,
+                                             const std::vector<uint32_t>& remap) {
+        const size_t vertexCount = remap.size();
+        std::vector<uint8_t> locked(vertexCount, 0);
+
+        std::vector<uint32_t> wedges(vertexCount, 0);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            ++wedges[remap[v]];
+        }
+
+        std::vector<uint64_t> edges;
+        edges.reserve(indexCount);
+        for (size_t i = 0; i + 2 < indexCount; i += 3) {
+            for (size_t k = 0; k < 3; ++k) {
+                const uint32_t a = remap[indices[i + k]];
+                const uint32_t b = remap[indices[i + (k + 1) % 3]];
+                if (a != b) {
+                    edges.push_back((uint64_t(a) << 32) | b);
+                }
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+
+        for (size_t i = 0; i < edges.size(); ++i) {
+            const uint32_t a = uint32_t(edges[i] >> 32);
+            const uint32_t b = uint32_t(edges[i]);
+            const bool duplicated = (i > 0 && edges[i - 1] == edges[i]) || (i + 1 < edges.size() && edges[i + 1] == edges[i]);
+            const bool open = !std::binary_search(edges.begin(), edges.end(), (uint64_t(b) << 32) | a);
+            if (duplicated || open) {
+                locked[a] = 1;
+                locked[b] = 1;
+            }
+        }
+
+        // 锁定状态按位置共享，接缝上的每个顶点都不能被折叠掉
+        for (size_t v = 0; v < vertexCount; ++v) {
+            if (wedges[remap[v]] > 1 || locked[remap[v]]) {
+                locked[v] = 1;
+            }
+        }
+        return locked;
+    }
+
+    struct Collapse {
+        uint32_t source;
+        uint32_t target;
+        double   error;
+    };
+}
+
+size_t simplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+                    const float* positions, size_t vertexCount, size_t positionStride,
+                    size_t targetIndexCount, float targetError, float* resultError) {
+    std::vector<uint32_t> current(indices, indices + indexCount / 3 * 3);
+    double maxError = 0.0;
+
+    const std::vector<uint32_t> remap = buildPositionRemap(positions, vertexCount, positionStride);
+    const std::vector<uint8_t>  locked = buildLockedVertices(current.data(), current.size(), remap);
+
+    // 每个位置累计相邻三角形平面的二次误差，以三角形面积为权重
+    std::vector<Quadric> quadrics(vertexCount, Quadric{});
+    for (size_t i = 0; i < current.size(); i += 3) {
+        const Vec3 p0 = loadPosition(positions, positionStride, current[i + 0]);
+        const Vec3 p1 = loadPosition(positions, positionStride, current[i + 1]);
+        const Vec3 p2 = loadPosition(positions, positionStride, current[i + 2]);
+        const Vec3 n = cross(p1 - p0, p2 - p0);
+        const double length = std::sqrt(double(dot(n, n)));
+        if (length <= 0.0) {
+            continue;
+        }
+        const double a = n.x / length, b = n.y / length, c = n.z / length;
+        const double d = -(a * p0.x + b * p0.y + c * p0.z);
+        const Quadric q = planeQuadric(a, b, c, d, length * 0.5);
+        for (size_t k = 0; k < 3; ++k) {
+            quadrics[remap[current[i + k]]] += q;
+        }
+    }
+
+    const double errorLimit = double(targetError) * double(targetError);
+    std::vector<uint32_t> collapseRemap(vertexCount);
+    std::vector<uint8_t>  passLocked(vertexCount);
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<Collapse> candidates;
+
+    while (current.size() > targetIndexCount) {
+        // 顶点到相邻三角形的CSR邻接表，每轮按当前索引重建
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0u);
+        for (uint32_t v : current) {
+            ++adjacencyOffsets[v + 1];
+        }
+        std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+        adjacency.resize(current.size());
+        {
+            std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+            for (size_t i = 0; i < current.size(); ++i) {
+                adjacency[fill[current[i]]++] = uint32_t(i / 3);
+            }
+        }
+
+        // 候选折叠：每条边上未锁定的端点折叠到另一端点，误差为两端二次误差在目标位置处的和
+        candidates.clear();
+        for (size_t i = 0; i < current.size(); i += 3) {
+            for (size_t k = 0; k < 3; ++k) {
+                const uint32_t a = current[i + k];
+                const uint32_t b = current[i + (k + 1) % 3];
+                if (remap[a] == remap[b]) {
+                    continue;
+                }
+                auto push = [&](uint32_t source, uint32_t target) {
+                    if (locked[source]) {
+                        return;
+                    }
+                    Quadric q = quadrics[remap[source]];
+                    q += quadrics[remap[target]];
+                    const double error = quadricError(q, loadPosition(positions, positionStride, target));
+                    if (error <= errorLimit) {
+                        candidates.push_back({ source, target, error });
+                    }
+                };
+                push(a, b);
+                push(b, a);
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& l, const Collapse& r) {
+            return l.error < r.error;
+        });
+
+        std::iota(collapseRemap.begin(), collapseRemap.end(), 0u);
+        std::fill(passLocked.begin(), passLocked.end(), uint8_t(0));
+
+        // 折叠后source的每个相邻三角形（不含被消去的）法线都不能翻转；同一轮中已折叠的顶点按collapseRemap取新位置
+        auto hasTriangleFlips = [&](uint32_t source, uint32_t target) {
+            const Vec3 ps = loadPosition(positions, positionStride, source);
+            const Vec3 pt = loadPosition(positions, positionStride, target);
+            for (uint32_t a = adjacencyOffsets[source]; a < adjacencyOffsets[source + 1]; ++a) {
+                const uint32_t* triangle = &current[adjacency[a] * 3];
+                uint32_t others[2];
+                uint32_t otherCount = 0;
+                bool collapsed = false;
+                for (size_t k = 0; k < 3; ++k) {
+                    const uint32_t v = collapseRemap[triangle[k]];
+                    if (triangle[k] == source) {
+                        continue;
+                    }
+                    if (v == target || v == source) {
+                        collapsed = true;
+                    }
+                    else if (otherCount < 2) {
+                        others[otherCount++] = v;
+                    }
+                }
+                if (collapsed || otherCount < 2) {
+                    continue;
+                }
+                const Vec3 p1 = loadPosition(positions, positionStride, others[0]);
+                const Vec3 p2 = loadPosition(positions, positionStride, others[1]);
+                const Vec3 before = cross(p1 - ps, p2 - ps);
+                const Vec3 after = cross(p1 - pt, p2 - pt);
+                if (dot(before, after) <= 0.0f) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        // 每次折叠大约消去两个三角形；只接受一轮内互不相交的折叠，剩余的留到下一轮按更新后的误差重新排序
+        const size_t trianglesToRemove = (current.size() - targetIndexCount) / 3;
+        size_t removed = 0;
+        size_t collapses = 0;
+        for (const Collapse& collapse : candidates) {
+            if (removed >= trianglesToRemove) {
+                break;
+            }
+            if (passLocked[collapse.source] || passLocked[collapse.target]) {
+                continue;
+            }
+            if (hasTriangleFlips(collapse.source, collapse.target)) {
+                continue;
+            }
+            collapseRemap[collapse.source] = collapse.target;
+            quadrics[remap[collapse.target]] += quadrics[remap[collapse.source]];
+            passLocked[collapse.source] = 1;
+            passLocked[collapse.target] = 1;
+            maxError = std::max(maxError, collapse.error);
+            removed += 2;
+            ++collapses;
+        }
+        if (collapses == 0) {
+            break;
+        }
+
+        // 应用折叠并丢弃退化三角形
+        size_t write = 0;
+        for (size_t i = 0; i < current.size(); i += 3) {
+            const uint32_t a = collapseRemap[current[i + 0]];
+            const uint32_t b = collapseRemap[current[i + 1]];
+            const uint32_t c = collapseRemap[current[i + 2]];
+            if (a != b && b != c && a != c) {
+                current[write++] = a;
+                current[write++] = b;
+                current[write++] = c;
+            }
+        }
+        current.resize(write);
+    }
+
+    std::copy(current.begin(), current.end(), destination);
+    if (resultError) {
+        *resultError = static_cast<float>(std::sqrt(maxError));
+    }
+    return current.size();
+}
+
+void buildLodChain(std::vector<uint32_t>& lodIndices, std::vector<MeshLodLevel>& levels,
+                   const uint32_t* indices, size_t indexCount,
+                   const float* positions, size_t vertexCount, size_t positionStride,
+                   float targetError, size_t maxLevels) {
+    indexCount = indexCount / 3 * 3;
+    lodIndices.assign(indices, indices + indexCount);
+    levels.clear();
+    levels.push_back({ 0, static_cast<uint32_t>(indexCount), 0.0f });
+
+    std::vector<uint32_t> previous(indices, indices + indexCount);
+    std::vector<uint32_t> simplified(indexCount);
+    std::vector<uint32_t> optimized(indexCount);
+    float error = 0.0f;
+    while (levels.size() < maxLevels) {
+        const size_t targetIndexCount = previous.size() / 6 * 3;
+        float levelError = 0.0f;
+        const size_t count = simplifyMesh(simplified.data(), previous.data(), previous.size(),
+                                          positions, vertexCount, positionStride,
+                                          targetIndexCount, targetError, &levelError);
+        if (count == 0 || float(count) > float(previous.size()) * MESH_LOD_MIN_REDUCTION) {
+            break;
+        }
+
+        // 简化打乱了原有的三角形顺序，每一级单独重新做顶点缓存优化
+        optimizeVertexCache(optimized.data(), simplified.data(), count, vertexCount);
+
+        // 每级以上一级为输入，误差累加得到相对LOD0的保守估计
+        error += levelError;
+        levels.push_back({ static_cast<uint32_t>(lodIndices.size()), static_cast<uint32_t>(count), error });
+        lodIndices.insert(lodIndices.end(), optimized.begin(), optimized.begin() + count);
+        previous.assign(optimized.begin(), optimized.begin() + count);
+    }
+}
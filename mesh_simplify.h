@@ -0,0 +1,32 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr size_t MESH_LOD_MAX_LEVELS = 6;      // 包括LOD0
+constexpr float  MESH_LOD_MIN_REDUCTION = 0.8f; // 某一级简化后三角形数仍超过上一级的80%时，认为已无法继续简化
+
+// 基于二次误差度量（QEM, Garland & Heckbert 1997）的边折叠简化，只折叠到已有顶点，不移动、不新增顶点。
+// 网格边界与纹理接缝（同一位置有多个顶点）上的顶点被锁定，只能作为折叠目标，保证简化后不出现裂缝。
+// 简化在三角形数降到targetIndexCount或继续折叠的误差超过targetError（与顶点位置同单位）时停止。
+// 返回destination中的索引数量，resultError返回实际产生的最大几何误差
+size_t simplifyMesh(uint32_t* destination, const uint32_t* indices, size_t indexCount,
+                    const float* positions, size_t vertexCount, size_t positionStride,
+                    size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+// LOD链中的一级：lodIndices中的一段索引，error为相对LOD0的累计几何误差
+struct MeshLodLevel {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float    error;
+};
+
+// 生成LOD链：LOD0为原始索引，之后每一级以上一级为输入、目标为一半的三角形，所有级别共用同一个顶点数组
+void buildLodChain(std::vector<uint32_t>& lodIndices, std::vector<MeshLodLevel>& levels,
+                   const uint32_t* indices, size_t indexCount,
+                   const float* positions, size_t vertexCount, size_t positionStride,
+                   float targetError, size_t maxLevels = MESH_LOD_MAX_LEVELS);
+
+#endif // MESH_SIMPLIFY_H
@@ -0,0 +1,96 @@
+#include "mesh_split.h"
+
+void splitMeshIndex16(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                      std::vector<uint32_t>& vertexSource, std::vector<uint16_t>& chunkIndices,
+                      std::vector<MeshChunk>& chunks, uint32_t maxVertices) {
+    const uint32_t partIndexCount = static_cast<uint32_t>(indexCount);
+    std::vector<uint32_t> partFirstChunk;
+    splitMeshIndex16(indices, &partIndexCount, 1, vertexCount, vertexSource, chunkIndices, chunks, partFirstChunk, maxVertices);
+}
+
+void splitMeshIndex16(const uint32_t* indices, const uint32_t* partIndexCounts, size_t partCount, size_t vertexCount,
+                      std::vector<uint32_t>& vertexSource, std::vector<uint16_t>& chunkIndices,
+                      std::vector<MeshChunk>& chunks, std::vector<uint32_t>& partFirstChunk, uint32_t maxVertices) {
+    size_t indexCount = 0;
+    for (size_t p = 0; p < partCount; ++p) {
+        indexCount += partIndexCounts[p] / 3 * 3;
+    }
+    vertexSource.clear();
+    chunkIndices.resize(indexCount);
+    chunks.clear();
+    partFirstChunk.assign(partCount + 1, 0);
+
+    // 整个网格放得下时直接收窄索引，保持顶点顺序不变，所有部分共用同一份顶点
+    if (vertexCount <= maxVertices) {
+        vertexSource.resize(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v) {
+            vertexSource[v] = static_cast<uint32_t>(v);
+        }
+        size_t src = 0;
+        size_t dst = 0;
+        for (size_t p = 0; p < partCount; ++p) {
+            partFirstChunk[p] = static_cast<uint32_t>(chunks.size());
+            const size_t count = partIndexCounts[p] / 3 * 3;
+            for (size_t i = 0; i < count; ++i) {
+                chunkIndices[dst + i] = static_cast<uint16_t>(indices[src + i]);
+            }
+            if (count > 0) {
+                chunks.push_back({ static_cast<uint32_t>(dst), static_cast<uint32_t>(count), 0, static_cast<uint32_t>(vertexCount) });
+            }
+            src += partIndexCounts[p];
+            dst += count;
+        }
+        partFirstChunk[partCount] = static_cast<uint32_t>(chunks.size());
+        return;
+    }
+
+    // localIds[v]只在chunkStamps[v]等于当前块编号时有效，换块时无需清空
+    std::vector<uint32_t> localIds(vertexCount, 0);
+    std::vector<uint32_t> chunkStamps(vertexCount, UINT32_MAX);
+    vertexSource.reserve(vertexCount + vertexCount / 8);
+
+    uint32_t stamp = 0;
+    size_t   src = 0;
+    size_t   dst = 0;
+    for (size_t p = 0; p < partCount; ++p) {
+        partFirstChunk[p] = static_cast<uint32_t>(chunks.size());
+        const size_t faceCount = partIndexCounts[p] / 3;
+
+        // 块不跨越部分边界，每个部分从新块开始
+        MeshChunk chunk{ static_cast<uint32_t>(dst), 0, static_cast<int32_t>(vertexSource.size()), 0 };
+        ++stamp;
+        for (size_t face = 0; face < faceCount; ++face) {
+            const uint32_t* triangle = indices + src + face * 3;
+            uint32_t newVertices = 0;
+            for (size_t k = 0; k < 3; ++k) {
+                // 退化三角形可能重复引用同一顶点，只计一次
+                const bool seen = chunkStamps[triangle[k]] == stamp ||
+                    (k > 0 && triangle[k] == triangle[0]) || (k > 1 && triangle[k] == triangle[1]);
+                newVertices += seen ? 0 : 1;
+            }
+
+            if (chunk.vertexCount + newVertices > maxVertices) {
+                chunks.push_back(chunk);
+                chunk = { static_cast<uint32_t>(dst), 0, static_cast<int32_t>(vertexSource.size()), 0 };
+                ++stamp;
+            }
+
+            for (size_t k = 0; k < 3; ++k) {
+                const uint32_t v = triangle[k];
+                if (chunkStamps[v] != stamp) {
+                    chunkStamps[v] = stamp;
+                    localIds[v] = chunk.vertexCount++;
+                    vertexSource.push_back(v);
+                }
+                chunkIndices[dst + k] = static_cast<uint16_t>(localIds[v]);
+            }
+            chunk.indexCount += 3;
+            dst += 3;
+        }
+        if (chunk.indexCount > 0) {
+            chunks.push_back(chunk);
+        }
+        src += partIndexCounts[p];
+    }
+    partFirstChunk[partCount] = static_cast<uint32_t>(chunks.size());
+}
@@ -0,0 +1,61 @@
+#ifndef MESH_SPLIT_H
+#define MESH_SPLIT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+constexpr uint32_t MESH_CHUNK_MAX_VERTICES = 1u << 16; // 16位索引能寻址的顶点数（未开启图元重启，0xFFFF可用）
+
+// 使用16位索引的一段网格，对应一次 vkCmdDrawIndexed(indexCount, 1, firstIndex, vertexOffset, 0)
+struct MeshChunk {
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t  vertexOffset;
+    uint32_t vertexCount;
+};
+
+// 按三角形顺序把网格切成唯一顶点数不超过maxVertices的块，每块的顶点在输出中连续存放，索引改写为块内编号。
+// 顶点数本来就不超过maxVertices时只生成一块，不复制任何顶点；否则块边界上的共享顶点会在相邻块中各存一份。
+// vertexSource[i] 是输出第i个顶点在原顶点数组中的编号
+void splitMeshIndex16(const uint32_t* indices, size_t indexCount, size_t vertexCount,
+                      std::vector<uint32_t>& vertexSource, std::vector<uint16_t>& chunkIndices,
+                      std::vector<MeshChunk>& chunks, uint32_t maxVertices = MESH_CHUNK_MAX_VERTICES);
+
+// 多个部分（如各级LOD）依次存放在indices中并共用一个顶点数组，第p部分有partIndexCounts[p]个索引。
+// 块不会跨越部分边界，第p部分的块为 chunks[partFirstChunk[p], partFirstChunk[p + 1])
+void splitMeshIndex16(const uint32_t* indices, const uint32_t* partIndexCounts, size_t partCount, size_t vertexCount,
+                      std::vector<uint32_t>& vertexSource, std::vector<uint16_t>& chunkIndices,
+                      std::vector<MeshChunk>& chunks, std::vector<uint32_t>& partFirstChunk,
+                      uint32_t maxVertices = MESH_CHUNK_MAX_VERTICES);
+
+template <typename VertexT>
+void splitMeshIndex16(const std::vector<VertexT>& vertices, const std::vector<uint32_t>& indices,
+                      std::vector<VertexT>& chunkVertices, std::vector<uint16_t>& chunkIndices,
+                      std::vector<MeshChunk>& chunks, uint32_t maxVertices = MESH_CHUNK_MAX_VERTICES) {
+    std::vector<uint32_t> vertexSource;
+    splitMeshIndex16(indices.data(), indices.size(), vertices.size(), vertexSource, chunkIndices, chunks, maxVertices);
+
+    chunkVertices.resize(vertexSource.size());
+    for (size_t i = 0; i < vertexSource.size(); ++i) {
+        chunkVertices[i] = vertices[vertexSource[i]];
+    }
+}
+
+template <typename VertexT>
+void splitMeshIndex16(const std::vector<VertexT>& vertices, const std::vector<uint32_t>& indices,
+                      const std::vector<uint32_t>& partIndexCounts,
+                      std::vector<VertexT>& chunkVertices, std::vector<uint16_t>& chunkIndices,
+                      std::vector<MeshChunk>& chunks, std::vector<uint32_t>& partFirstChunk,
+                      uint32_t maxVertices = MESH_CHUNK_MAX_VERTICES) {
+    std::vector<uint32_t> vertexSource;
+    splitMeshIndex16(indices.data(), partIndexCounts.data(), partIndexCounts.size(), vertices.size(),
+                     vertexSource, chunkIndices, chunks, partFirstChunk, maxVertices);
+
+    chunkVertices.resize(vertexSource.size());
+    for (size_t i = 0; i < vertexSource.size(); ++i) {
+        chunkVertices[i] = vertices[vertexSource[i]];
+    }
+}
+
+#endif // MESH_SPLIT_H
@@ -0,0 +1,122 @@
+#include "parallel_recorder.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "cpu_profiler.h"
+
+void ParallelRecorder::create(VkDevice device, const VolkDeviceTable& deviceTable, uint32_t queueFamilyIdx, uint32_t frameCount,
+    JobSystem& jobs, uint32_t maxSegments) {
+    m_device = device;
+    m_deviceTable = &deviceTable;
+    m_jobs = &jobs;
+    m_threadCount = std::max(1u, maxSegments);
+    m_threadLimit = m_threadCount;
+
+    // 池只会整体重置，不需要RESET_COMMAND_BUFFER_BIT；命令缓冲区每帧重新录制，标记为TRANSIENT
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamilyIdx;
+
+    m_frames.resize(frameCount);
+    for (Frame& frame : m_frames) {
+        frame.pools.resize(m_threadCount, VK_NULL_HANDLE);
+        frame.commandBuffers.resize(m_threadCount, VK_NULL_HANDLE);
+        for (uint32_t segment = 0; segment < m_threadCount; ++segment) {
+            if (m_deviceTable->vkCreateCommandPool(m_device, &poolInfo, nullptr, &frame.pools[segment]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create secondary command pool!");
+            }
+            VkCommandBufferAllocateInfo allocInfo{};
+            allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+            allocInfo.commandPool = frame.pools[segment];
+            allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+            allocInfo.commandBufferCount = 1;
+            if (m_deviceTable->vkAllocateCommandBuffers(m_device, &allocInfo, &frame.commandBuffers[segment]) != VK_SUCCESS) {
+                throw std::runtime_error("failed to allocate secondary command buffers!");
+            }
+        }
+    }
+}
+
+void ParallelRecorder::setThreadLimit(uint32_t threadLimit) {
+    m_threadLimit = std::clamp(threadLimit, 1u, m_threadCount);
+}
+
+void ParallelRecorder::destroy() {
+    // 销毁池时同时释放从中分配的命令缓冲区
+    for (Frame& frame : m_frames) {
+        for (VkCommandPool pool : frame.pools) {
+            if (pool != VK_NULL_HANDLE) {
+                m_deviceTable->vkDestroyCommandPool(m_device, pool, nullptr);
+            }
+        }
+    }
+    m_frames.clear();
+    m_currentFrame = nullptr;
+    m_recorded.clear();
+}
+
+void ParallelRecorder::beginFrame(uint32_t frameIndex) {
+    m_currentFrame = &m_frames[frameIndex];
+    for (uint32_t segment = 0; segment < m_currentFrame->usedCount; ++segment) {
+        m_deviceTable->vkResetCommandPool(m_device, m_currentFrame->pools[segment], 0);
+    }
+    m_currentFrame->usedCount = 0;
+}
+
+const std::vector<VkCommandBuffer>& ParallelRecorder::record(const VkCommandBufferInheritanceRenderingInfo& renderingInfo,
+    uint32_t itemCount, uint32_t minItemsPerThread, const RecordRange& recordRange) {
+    m_recorded.clear();
+    if (itemCount == 0) {
+        return m_recorded;
+    }
+    const uint32_t segmentCount = std::clamp((itemCount + minItemsPerThread - 1) / std::max(1u, minItemsPerThread), 1u, m_threadLimit);
+    // 录制失败时已开始录制的池也需要在下一次beginFrame()时重置
+    m_currentFrame->usedCount = segmentCount;
+    m_segmentCount = segmentCount;
+    m_itemCount = itemCount;
+    m_renderingInfo = &renderingInfo;
+    m_recordRange = &recordRange;
+
+    if (segmentCount == 1) {
+        recordSegment(0);
+    } else {
+        // 每段一个任务；调用线程在wait()中录制自己队列里的段，其余段被工作线程窃取。wait()在所有段结束后才重新抛出异常
+        JobCounter counter;
+        m_jobs->parallelFor(segmentCount, 1, [this](uint32_t first, uint32_t count) {
+            for (uint32_t segment = first; segment < first + count; ++segment) {
+                recordSegment(segment);
+            }
+        }, counter);
+        m_jobs->wait(counter);
+    }
+
+    m_recorded.assign(m_currentFrame->commandBuffers.begin(), m_currentFrame->commandBuffers.begin() + segmentCount);
+    return m_recorded;
+}
+
+void ParallelRecorder::recordSegment(uint32_t segment) {
+    CpuZone zone("recordSecondary");
+    const uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(m_itemCount) * segment / m_segmentCount);
+    const uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(m_itemCount) * (segment + 1) / m_segmentCount);
+    VkCommandBuffer commandBuffer = m_currentFrame->commandBuffers[segment];
+
+    // 动态渲染的附件格式与采样数由VkCommandBufferInheritanceRenderingInfo给出
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.pNext = m_renderingInfo;
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+    if (m_deviceTable->vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording secondary command buffer!");
+    }
+    (*m_recordRange)(commandBuffer, first, end - first);
+    if (m_deviceTable->vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record secondary command buffer!");
+    }
+}
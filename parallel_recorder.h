@@ -0,0 +1,63 @@
+#ifndef PARALLEL_RECORDER_H
+#define PARALLEL_RECORDER_H
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <vk_api.h>
+
+#include "job_system.h"
+
+// 多线程录制二级命令缓冲区：每个并行帧、每段一个命令池，每个池预先分配一个二级命令缓冲区。
+// beginFrame()用vkResetCommandPool整体重置该帧槽位上一次record()用过的池（调用方已经等待过该帧槽位的栅栏），不逐个重置命令缓冲区。
+// record()把[0, itemCount)分成连续的段，用任务系统的parallelFor分给工作线程，调用线程在wait()中边等待边录制。
+// 命令池要求外部同步：每段只在一个任务中使用自己的池，不同段可以在任意线程上录制。
+// 返回按段顺序排列的二级命令缓冲区，由主命令缓冲区在VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT的动态渲染中
+// 用vkCmdExecuteCommands执行。二级命令缓冲区不继承状态，每段都要重新绑定管线、缓冲区与描述符集。
+// 除create()/destroy()外只在录制主命令缓冲区的线程（创建jobs的线程）上调用
+class ParallelRecorder {
+public:
+    // 录制[first, first + count)，同一次record()中不同段在不同线程上并行调用
+    using RecordRange = std::function<void(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count)>;
+
+    // 最多分成maxSegments段，每帧预先创建maxSegments个命令池
+    void create(VkDevice device, const VolkDeviceTable& deviceTable, uint32_t queueFamilyIdx, uint32_t frameCount, JobSystem& jobs,
+        uint32_t maxSegments);
+    void destroy();
+
+    uint32_t threadCount() const { return m_threadCount; }
+    // 限制之后record()使用的段数（1..threadCount()），用于测量录制时间随线程数的变化
+    void setThreadLimit(uint32_t threadLimit);
+
+    void beginFrame(uint32_t frameIndex);
+    // 每段至少minItemsPerThread项，项数少时只分成一段，在调用线程上录制。任一段抛出异常时等待其余段结束后在调用线程上重新抛出
+    const std::vector<VkCommandBuffer>& record(const VkCommandBufferInheritanceRenderingInfo& renderingInfo, uint32_t itemCount,
+        uint32_t minItemsPerThread, const RecordRange& recordRange);
+
+private:
+    struct Frame {
+        std::vector<VkCommandPool>   pools;          // 每段一个
+        std::vector<VkCommandBuffer> commandBuffers; // 每段一个，从同一段的池中分配
+        uint32_t                     usedCount { 0 }; // 上一次record()录制过的池数，beginFrame()只重置这些池
+    };
+
+    void recordSegment(uint32_t segment);
+
+    VkDevice                     m_device { VK_NULL_HANDLE };
+    const VolkDeviceTable*       m_deviceTable { nullptr };
+    JobSystem*                   m_jobs { nullptr };
+    std::vector<Frame>           m_frames;
+    Frame*                       m_currentFrame { nullptr };
+    uint32_t                     m_threadCount { 0 };
+    uint32_t                     m_threadLimit { 0 };
+    std::vector<VkCommandBuffer> m_recorded; // 本次record()录制的二级命令缓冲区
+
+    // 本次record()的参数，在提交任务之前写入
+    uint32_t                                       m_segmentCount { 0 };
+    uint32_t                                       m_itemCount { 0 };
+    const VkCommandBufferInheritanceRenderingInfo* m_renderingInfo { nullptr };
+    const RecordRange*                             m_recordRange { nullptr };
+};
+
+#endif // PARALLEL_RECORDER_H
@@ -0,0 +1,131 @@
+#include "pipeline_cache.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "mesh_cache.h"
+
+void PipelineCache::create(VkPhysicalDevice physicalDevice, VkDevice device, const VolkDeviceTable& deviceTable, const std::string& path) {
+    m_device = device;
+    m_deviceTable = &deviceTable;
+    m_path = path;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    // 映射文件只在创建期间使用，驱动会拷贝初始数据
+    MappedFile file;
+    std::string reason = "no cache file";
+    bool valid = file.open(path) && validateHeader(properties, file.data(), file.size(), reason);
+
+    VkPipelineCacheCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = valid ? file.size() : 0;
+    createInfo.pInitialData = valid ? file.data() : nullptr;
+    VkResult result = m_deviceTable->vkCreatePipelineCache(m_device, &createInfo, nullptr, &m_cache);
+    if (result != VK_SUCCESS && valid) {
+        // 数据头正确但内容被驱动拒绝，退回空缓存
+        reason = "rejected by driver";
+        valid = false;
+        createInfo.initialDataSize = 0;
+        createInfo.pInitialData = nullptr;
+        result = m_deviceTable->vkCreatePipelineCache(m_device, &createInfo, nullptr, &m_cache);
+    }
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+
+    if (valid) {
+        fmt::println("pipeline cache: loaded {} bytes from {}", file.size(), path);
+    } else {
+        fmt::println("pipeline cache: {}, starting empty ({})", reason, path);
+    }
+}
+
+void PipelineCache::destroy() {
+    if (m_cache == VK_NULL_HANDLE) {
+        return;
+    }
+    size_t size = 0;
+    std::vector<uint8_t> data;
+    if (m_deviceTable->vkGetPipelineCacheData(m_device, m_cache, &size, nullptr) == VK_SUCCESS && size > 0) {
+        data.resize(size);
+        // 两次调用之间没有其他线程创建管线，大小不会变化
+        if (m_deviceTable->vkGetPipelineCacheData(m_device, m_cache, &size, data.data()) == VK_SUCCESS) {
+            data.resize(size);
+            if (writeFileAtomically(m_path, data.data(), data.size())) {
+                fmt::println("pipeline cache: wrote {} bytes to {}", data.size(), m_path);
+            } else {
+                fmt::println("failed to write pipeline cache: {}", m_path);
+            }
+        }
+    }
+    m_deviceTable->vkDestroyPipelineCache(m_device, m_cache, nullptr);
+    m_cache = VK_NULL_HANDLE;
+    m_device = VK_NULL_HANDLE;
+    m_deviceTable = nullptr;
+}
+
+bool PipelineCache::validateHeader(const VkPhysicalDeviceProperties& properties, const uint8_t* data, size_t size, std::string& reason) {
+    // 数据头按小端存放的uint32字段，映射内存不保证对齐，拷贝出来再比较
+    VkPipelineCacheHeaderVersionOne header;
+    if (size < sizeof(header)) {
+        reason = "cache file too small";
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.headerSize < sizeof(header) || header.headerSize > size) {
+        reason = "invalid header size";
+        return false;
+    }
+    if (header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE) {
+        reason = fmt::format("unknown header version {}", static_cast<uint32_t>(header.headerVersion));
+        return false;
+    }
+    if (header.vendorID != properties.vendorID || header.deviceID != properties.deviceID) {
+        reason = fmt::format("device mismatch (cache {:04x}:{:04x}, device {:04x}:{:04x})",
+            header.vendorID, header.deviceID, properties.vendorID, properties.deviceID);
+        return false;
+    }
+    if (memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        reason = "pipeline cache UUID mismatch (driver changed)";
+        return false;
+    }
+    return true;
+}
+
+PipelineCreationFeedback::PipelineCreationFeedback(uint32_t stageCount)
+    : m_stages(stageCount) {
+    m_createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+    m_createInfo.pPipelineCreationFeedback = &m_pipeline;
+    m_createInfo.pipelineStageCreationFeedbackCount = stageCount;
+    m_createInfo.pPipelineStageCreationFeedbacks = m_stages.data();
+}
+
+const void* PipelineCreationFeedback::chain(const void* next) {
+    m_createInfo.pNext = next;
+    return &m_createInfo;
+}
+
+void PipelineCreationFeedback::print(const char* pipelineName) const {
+    // 驱动可以不提供反馈，此时VALID位为0
+    if ((m_pipeline.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) == 0) {
+        fmt::println("pipeline {}: no creation feedback", pipelineName);
+        return;
+    }
+    const bool hit = (m_pipeline.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) != 0;
+    std::string stages;
+    for (size_t i = 0; i < m_stages.size(); ++i) {
+        const VkPipelineCreationFeedback& stage = m_stages[i];
+        if ((stage.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) == 0) {
+            stages += fmt::format(", stage {} n/a", i);
+            continue;
+        }
+        stages += fmt::format(", stage {} {} {:.3f} ms", i,
+            (stage.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) != 0 ? "hit" : "miss",
+            stage.duration / 1e6);
+    }
+    fmt::println("pipeline {}: cache {}, {:.3f} ms{}", pipelineName, hit ? "hit" : "miss", m_pipeline.duration / 1e6, stages);
+}
@@ -0,0 +1,49 @@
+#ifndef PIPELINE_CACHE_H
+#define PIPELINE_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <vk_api.h>
+
+// 持久化的VkPipelineCache：create()时从磁盘加载，destroy()时先写入临时文件再重命名写回。
+// 文件开头的VkPipelineCacheHeaderVersionOne中vendorID、deviceID、pipelineCacheUUID必须与当前设备一致，
+// 否则（换了显卡或更新了驱动）丢弃旧数据，从空缓存开始。
+// VkPipelineCache由驱动内部同步，可以在多个线程上同时创建管线
+class PipelineCache {
+public:
+    void create(VkPhysicalDevice physicalDevice, VkDevice device, const VolkDeviceTable& deviceTable, const std::string& path);
+    void destroy();
+
+    VkPipelineCache handle() const { return m_cache; }
+
+private:
+    // 校验缓存数据头，不匹配时返回false并在reason中说明原因
+    static bool validateHeader(const VkPhysicalDeviceProperties& properties, const uint8_t* data, size_t size, std::string& reason);
+
+    VkDevice               m_device { VK_NULL_HANDLE };
+    const VolkDeviceTable* m_deviceTable { nullptr };
+    VkPipelineCache        m_cache { VK_NULL_HANDLE };
+    std::string            m_path;
+};
+
+// 管线创建反馈（VK_EXT_pipeline_creation_feedback，Vulkan 1.3核心）：接在管线创建信息的pNext链上，
+// 创建后打印整条管线和各着色器阶段是否命中管线缓存以及编译耗时，用于确认热启动确实命中了缓存
+class PipelineCreationFeedback {
+public:
+    explicit PipelineCreationFeedback(uint32_t stageCount);
+    PipelineCreationFeedback(const PipelineCreationFeedback&) = delete;
+    PipelineCreationFeedback& operator=(const PipelineCreationFeedback&) = delete;
+
+    // 把反馈结构插入到next之前，返回新的pNext链头
+    const void* chain(const void* next);
+    void print(const char* pipelineName) const;
+
+private:
+    VkPipelineCreationFeedback              m_pipeline {};
+    std::vector<VkPipelineCreationFeedback> m_stages;
+    VkPipelineCreationFeedbackCreateInfo    m_createInfo {};
+};
+
+#endif // PIPELINE_CACHE_H
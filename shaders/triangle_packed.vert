@@ -0,0 +1,33 @@
+#version 450
+
+// 配合PackedVertexLayout：位置为相对包围盒的[0,1]坐标，反量化已合并到draw.model中
+layout(binding = 0) uniform UniformBufferObject {
+    mat4 view;
+    mat4 proj;
+} ubo;
+
+// 每次绘制的矩阵，与main.cpp中的DrawConstants一致
+layout(push_constant) uniform DrawConstants {
+    mat4 model;
+} draw;
+
+// 实例的模型矩阵，gl_InstanceIndex包含间接绘制命令的firstInstance
+struct Instance {
+    mat4 model;
+};
+
+layout(std430, binding = 2) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout(location = 0) in vec3 inPosition; // R16G16B16A16_UNORM
+layout(location = 2) in vec2 inTexCoord; // R16G16_SFLOAT
+
+layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+void main() {
+    gl_Position = ubo.proj * ubo.view * instances[gl_InstanceIndex].model * draw.model * vec4(inPosition, 1.0);
+    fragColor = vec3(1.0);
+    fragTexCoord = inTexCoord;
+}
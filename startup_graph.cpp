@@ -0,0 +1,217 @@
+#include "startup_graph.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include "cpu_profiler.h"
+#include "job_system.h"
+
+StartupGraph::TaskId StartupGraph::addTask(const std::string& name, std::vector<TaskId> dependencies, Work work) {
+    return add(name, std::move(dependencies), std::move(work), false);
+}
+
+StartupGraph::TaskId StartupGraph::addMainThreadTask(const std::string& name, std::vector<TaskId> dependencies, Work work) {
+    return add(name, std::move(dependencies), std::move(work), true);
+}
+
+StartupGraph::TaskId StartupGraph::add(const std::string& name, std::vector<TaskId> dependencies, Work work, bool mainThread) {
+    const TaskId id = static_cast<TaskId>(m_tasks.size());
+    for (TaskId dependency : dependencies) {
+        if (dependency >= id) {
+            throw std::runtime_error("startup task depends on a task added after it!");
+        }
+        m_tasks[dependency].dependents.push_back(id);
+    }
+    Task task{};
+    task.name = name;
+    task.zoneName = CpuProfiler::internName(name);
+    task.work = std::move(work);
+    task.dependencies = std::move(dependencies);
+    task.mainThread = mainThread;
+    m_tasks.push_back(std::move(task));
+    return id;
+}
+
+void StartupGraph::run(JobSystem& jobs) {
+    const bool useWorkers = jobs.workerCount() > 0;
+    m_workerCount = jobs.workerCount();
+    m_runStart = std::chrono::high_resolution_clock::now();
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::deque<TaskId> mainReady;
+    size_t remaining = m_tasks.size();
+    std::exception_ptr error;
+    JobCounter workerTasks;
+
+    auto elapsedMs = [this]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - m_runStart).count();
+    };
+
+    // 执行一个任务，完成后把依赖已满足的主线程任务放入mainReady、普通任务提交到jobs。调用时不持有mutex
+    std::function<void(TaskId)> spawnTask;
+    auto execute = [&](TaskId id) {
+        Task& task = m_tasks[id];
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (error) {
+                return;
+            }
+            task.thread = jobs.currentQueue();
+            task.startMs = elapsedMs();
+        }
+
+        std::exception_ptr taskError;
+        try {
+            CpuZone zone(task.zoneName);
+            task.work();
+        } catch (...) {
+            taskError = std::current_exception();
+        }
+
+        std::vector<TaskId> spawned;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task.endMs = elapsedMs();
+            if (taskError) {
+                if (!error) {
+                    error = taskError;
+                }
+            } else {
+                --remaining;
+                for (TaskId dependent : task.dependents) {
+                    if (--m_tasks[dependent].pendingCount == 0) {
+                        if (m_tasks[dependent].mainThread || !useWorkers) {
+                            mainReady.push_back(dependent);
+                        } else {
+                            spawned.push_back(dependent);
+                        }
+                    }
+                }
+            }
+        }
+        condition.notify_all();
+        for (TaskId dependent : spawned) {
+            spawnTask(dependent);
+        }
+    };
+    spawnTask = [&](TaskId id) {
+        jobs.spawn([&execute, id]() { execute(id); }, &workerTasks);
+    };
+
+    std::vector<TaskId> spawned;
+    for (TaskId id = 0; id < m_tasks.size(); ++id) {
+        m_tasks[id].pendingCount = static_cast<uint32_t>(m_tasks[id].dependencies.size());
+        if (m_tasks[id].pendingCount == 0) {
+            if (m_tasks[id].mainThread || !useWorkers) {
+                mainReady.push_back(id);
+            } else {
+                spawned.push_back(id);
+            }
+        }
+    }
+    for (TaskId id : spawned) {
+        spawnTask(id);
+    }
+
+    // 主线程只执行主线程任务，没有就绪的任务时等待工作线程完成依赖，不去窃取可能耗时很长的普通任务
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        condition.wait(lock, [&]() { return !mainReady.empty() || remaining == 0 || error; });
+        if (remaining == 0 || error) {
+            break;
+        }
+        const TaskId id = mainReady.front();
+        mainReady.pop_front();
+        lock.unlock();
+        execute(id);
+        lock.lock();
+    }
+    lock.unlock();
+
+    // 出错时已提交的任务直接返回，等它们全部结束后才能释放局部状态
+    jobs.wait(workerTasks);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+std::vector<StartupGraph::TaskId> StartupGraph::criticalPath() const {
+    std::vector<TaskId> path;
+    if (m_tasks.empty()) {
+        return path;
+    }
+    auto endsBefore = [this](TaskId a, TaskId b) { return m_tasks[a].endMs < m_tasks[b].endMs; };
+
+    TaskId last = 0;
+    for (TaskId id = 1; id < m_tasks.size(); ++id) {
+        if (endsBefore(last, id)) {
+            last = id;
+        }
+    }
+    // 一个任务的开始时间取决于最后完成的依赖
+    for (TaskId id = last;;) {
+        path.push_back(id);
+        const std::vector<TaskId>& dependencies = m_tasks[id].dependencies;
+        if (dependencies.empty()) {
+            break;
+        }
+        id = *std::max_element(dependencies.begin(), dependencies.end(), endsBefore);
+    }
+    std::reverse(path.begin(), path.end());
+    return path;
+}
+
+void StartupGraph::printTimeline() const {
+    constexpr int BAR_WIDTH = 48;
+
+    const std::vector<TaskId> path = criticalPath();
+    if (path.empty()) {
+        return;
+    }
+    const double totalMs = m_tasks[path.back()].endMs;
+    const double scale = totalMs > 0.0 ? BAR_WIDTH / totalMs : 0.0;
+
+    std::vector<bool> critical(m_tasks.size(), false);
+    for (TaskId id : path) {
+        critical[id] = true;
+    }
+    size_t nameWidth = 0;
+    for (const Task& task : m_tasks) {
+        nameWidth = std::max(nameWidth, task.name.size());
+    }
+
+    // 按开始时间排列，*标记关键路径上的任务
+    std::vector<TaskId> order(m_tasks.size());
+    for (TaskId id = 0; id < order.size(); ++id) {
+        order[id] = id;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](TaskId a, TaskId b) { return m_tasks[a].startMs < m_tasks[b].startMs; });
+
+    fmt::println("startup timeline ({} worker threads, {:.3f} ms):", m_workerCount, totalMs);
+    for (TaskId id : order) {
+        const Task& task = m_tasks[id];
+        const int begin = std::min(BAR_WIDTH - 1, static_cast<int>(task.startMs * scale));
+        const int end = std::max(begin + 1, std::min(BAR_WIDTH, static_cast<int>(task.endMs * scale + 0.5)));
+        const std::string bar = std::string(begin, ' ') + std::string(end - begin, '#') + std::string(BAR_WIDTH - end, ' ');
+        const std::string thread = task.thread == 0 ? std::string("main") : fmt::format("w{}", task.thread);
+        fmt::println("  {} {:<{}} {:>4} |{}| {:9.3f} .. {:9.3f} ms ({:.3f} ms)", critical[id] ? '*' : ' ', task.name, nameWidth,
+            thread, bar, task.startMs, task.endMs, task.endMs - task.startMs);
+    }
+
+    // 关键路径上任务之间的空隙是等待调度或等待主线程空闲的时间
+    double busyMs = 0.0;
+    std::string chain;
+    for (TaskId id : path) {
+        busyMs += m_tasks[id].endMs - m_tasks[id].startMs;
+        chain += chain.empty() ? m_tasks[id].name : " -> " + m_tasks[id].name;
+    }
+    fmt::println("critical path: {}", chain);
+    fmt::println("critical path busy {:.3f} ms of {:.3f} ms", busyMs, totalMs);
+}
@@ -0,0 +1,54 @@
+#ifndef STARTUP_GRAPH_H
+#define STARTUP_GRAPH_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+// 启动依赖图：每个任务在它依赖的任务全部完成后执行。普通任务提交到任务系统，由它的工作线程执行，
+// 主线程任务只在调用run()的线程上按就绪顺序执行（窗口创建、Vulkan对象创建与上传录制等要求单线程的步骤）。
+// 依赖必须是先添加的任务，因此图中不会有环。
+// run()记录每个任务的开始/结束时间，printTimeline()打印启动时间线与关键路径；每个任务同时记录为一个CPU分区
+class StartupGraph {
+public:
+    using TaskId = uint32_t;
+    using Work = std::function<void()>;
+
+    TaskId addTask(const std::string& name, std::vector<TaskId> dependencies, Work work);
+    TaskId addMainThreadTask(const std::string& name, std::vector<TaskId> dependencies, Work work);
+
+    // 在创建jobs的线程上调用。普通任务用jobs的工作线程执行，jobs没有工作线程时全部任务在调用线程上执行。
+    // 任一任务抛出异常后不再开始新的任务，等待已开始的任务结束后重新抛出第一个异常
+    void run(JobSystem& jobs);
+
+    void printTimeline() const;
+
+private:
+    struct Task {
+        std::string          name;
+        const char*          zoneName;     // name的驻留副本，CPU分区在程序结束前都引用它
+        Work                 work;
+        std::vector<TaskId>  dependencies;
+        std::vector<TaskId>  dependents;
+        bool                 mainThread;
+        uint32_t             pendingCount; // run()中尚未完成的依赖数量
+        uint32_t             thread;       // 执行任务的队列编号：0为主线程，1..N为工作线程
+        double               startMs;      // 相对run()开始的时间
+        double               endMs;
+    };
+
+    TaskId add(const std::string& name, std::vector<TaskId> dependencies, Work work, bool mainThread);
+    // 结束时间最晚的任务，沿结束最晚的依赖回溯得到的任务链（从起点到终点）
+    std::vector<TaskId> criticalPath() const;
+
+    std::vector<Task>                              m_tasks;
+    std::chrono::high_resolution_clock::time_point m_runStart;
+    uint32_t                                       m_workerCount { 0 };
+};
+
+#endif // STARTUP_GRAPH_H
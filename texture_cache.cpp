@@ -0,0 +1,369 @@
+#include "texture_cache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    constexpr uint32_t KTX2_TEXEL_SIZE = 4; // RGBA8
+
+    // 支持的格式：RGBA8每个texel为一块，BC格式每4x4个texel为一块
+    struct Ktx2FormatInfo {
+        uint32_t blockDimension;
+        uint32_t blockBytes;
+        uint32_t colorModel;
+        bool     srgb;
+    };
+
+    constexpr uint32_t KHR_DF_MODEL_RGBSDA = 1;
+    constexpr uint32_t KHR_DF_MODEL_BC1A = 128;
+    constexpr uint32_t KHR_DF_MODEL_BC7 = 134;
+
+    bool getFormatInfo(uint32_t vkFormat, Ktx2FormatInfo& info) {
+        switch (vkFormat) {
+        case KTX2_FORMAT_R8G8B8A8_UNORM: info = { 1, KTX2_TEXEL_SIZE, KHR_DF_MODEL_RGBSDA, false }; return true;
+        case KTX2_FORMAT_R8G8B8A8_SRGB:  info = { 1, KTX2_TEXEL_SIZE, KHR_DF_MODEL_RGBSDA, true }; return true;
+        case KTX2_FORMAT_BC1_RGB_UNORM:  info = { 4, 8, KHR_DF_MODEL_BC1A, false }; return true;
+        case KTX2_FORMAT_BC1_RGB_SRGB:   info = { 4, 8, KHR_DF_MODEL_BC1A, true }; return true;
+        case KTX2_FORMAT_BC7_UNORM:      info = { 4, 16, KHR_DF_MODEL_BC7, false }; return true;
+        case KTX2_FORMAT_BC7_SRGB:       info = { 4, 16, KHR_DF_MODEL_BC7, true }; return true;
+        default: return false;
+        }
+    }
+
+    uint64_t levelSize(const Ktx2FormatInfo& info, uint32_t width, uint32_t height) {
+        return uint64_t((width + info.blockDimension - 1) / info.blockDimension) *
+            ((height + info.blockDimension - 1) / info.blockDimension) * info.blockBytes;
+    }
+
+    // KTX2文件头，紧跟在12字节标识符之后
+    struct Ktx2Header {
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+    };
+    static_assert(sizeof(Ktx2Header) == 36, "Ktx2Header must match the KTX2 file layout");
+
+    // 数据格式描述符、键值数据与超压缩全局数据的位置，紧跟在文件头之后
+    struct Ktx2Index {
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+    static_assert(sizeof(Ktx2Index) == 32, "Ktx2Index must match the KTX2 file layout");
+
+    struct Ktx2LevelIndex {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    constexpr const char* KEY_ORIENTATION = "KTXorientation";
+    constexpr const char* KEY_WRITER = "KTXwriter";
+    constexpr const char* KEY_SOURCE_HASH = "bakeSourceHash";
+    constexpr const char* KEY_VERSION = "bakeVersion";
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    // 基本数据格式描述符（Khronos Data Format 1.3）。RGBA8每个通道一个sample，sRGB时alpha标记为线性；
+    // BC格式整块只有一个sample
+    std::vector<uint32_t> makeDfd(const Ktx2FormatInfo& info) {
+        constexpr uint32_t KHR_DF_PRIMARIES_BT709 = 1;
+        constexpr uint32_t KHR_DF_TRANSFER_LINEAR = 1;
+        constexpr uint32_t KHR_DF_TRANSFER_SRGB = 2;
+        constexpr uint32_t KHR_DF_SAMPLE_DATATYPE_LINEAR = 0x10;
+        constexpr uint32_t RGBA_CHANNELS[4] = { 0, 1, 2, 15 }; // R G B A
+
+        const bool     blockCompressed = info.colorModel != KHR_DF_MODEL_RGBSDA;
+        const uint32_t sampleCount = blockCompressed ? 1 : 4;
+        const uint32_t blockSize = 24 + 16 * sampleCount;
+        const uint32_t dimension = info.blockDimension - 1;
+
+        std::vector<uint32_t> dfd;
+        dfd.push_back(4 + blockSize); // dfdTotalSize
+        dfd.push_back(0);             // vendorId = Khronos, descriptorType = basic
+        dfd.push_back(2 | (blockSize << 16));
+        dfd.push_back(info.colorModel | (KHR_DF_PRIMARIES_BT709 << 8) |
+            ((info.srgb ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR) << 16));
+        dfd.push_back(dimension | (dimension << 8)); // texelBlockDimension
+        dfd.push_back(info.blockBytes);              // bytesPlane0
+        dfd.push_back(0);
+        if (blockCompressed) {
+            dfd.push_back(((info.blockBytes * 8 - 1) << 16)); // channel 0 = COLOR，覆盖整块
+            dfd.push_back(0);
+            dfd.push_back(0);
+            dfd.push_back(UINT32_MAX);
+            return dfd;
+        }
+        for (uint32_t i = 0; i < sampleCount; ++i) {
+            uint32_t channelType = RGBA_CHANNELS[i];
+            if (info.srgb && RGBA_CHANNELS[i] == 15) {
+                channelType |= KHR_DF_SAMPLE_DATATYPE_LINEAR;
+            }
+            dfd.push_back((i * 8) | (7u << 16) | (channelType << 24));
+            dfd.push_back(0);   // samplePosition
+            dfd.push_back(0);   // sampleLower
+            dfd.push_back(255); // sampleUpper
+        }
+        return dfd;
+    }
+
+    void appendKeyValue(std::vector<uint8_t>& kvd, const char* key, const std::string& value) {
+        const uint32_t length = static_cast<uint32_t>(strlen(key) + 1 + value.size() + 1);
+        const uint8_t* lengthBytes = reinterpret_cast<const uint8_t*>(&length);
+        kvd.insert(kvd.end(), lengthBytes, lengthBytes + sizeof(length));
+        kvd.insert(kvd.end(), key, key + strlen(key) + 1);
+        kvd.insert(kvd.end(), value.begin(), value.end());
+        kvd.push_back(0);
+        kvd.resize(alignUp(kvd.size(), 4), 0);
+    }
+
+    // 查找键对应的值（不含结尾的NUL），找不到时返回false
+    bool findKeyValue(const uint8_t* kvd, uint32_t size, const char* key, std::string& value) {
+        const size_t keyLength = strlen(key) + 1;
+        uint32_t offset = 0;
+        while (offset + sizeof(uint32_t) <= size) {
+            uint32_t length = 0;
+            memcpy(&length, kvd + offset, sizeof(length));
+            offset += sizeof(uint32_t);
+            if (length > size - offset) {
+                return false;
+            }
+            const char* entry = reinterpret_cast<const char*>(kvd + offset);
+            if (length >= keyLength && memcmp(entry, key, keyLength) == 0) {
+                value.assign(entry + keyLength, length - keyLength);
+                if (!value.empty() && value.back() == '\0') {
+                    value.pop_back();
+                }
+                return true;
+            }
+            offset = static_cast<uint32_t>(alignUp(offset + length, 4));
+        }
+        return false;
+    }
+
+    std::string toHex(uint64_t value) {
+        static const char digits[] = "0123456789abcdef";
+        std::string text(16, '0');
+        for (int i = 15; i >= 0; --i, value >>= 4) {
+            text[i] = digits[value & 0xF];
+        }
+        return text;
+    }
+
+    float srgbToLinear(float c) {
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    float linearToSrgb(float c) {
+        return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+    }
+}
+
+void generateMipChainRGBA8(const uint8_t* pixels, uint32_t width, uint32_t height, bool srgb,
+                           std::vector<uint8_t>& data, std::vector<TextureLevel>& levels) {
+    levels.clear();
+    data.clear();
+    if (width == 0 || height == 0) {
+        return;
+    }
+
+    const uint32_t levelCount = static_cast<uint32_t>(std::floor(std::log2(std::max(width, height)))) + 1;
+    uint64_t totalSize = 0;
+    for (uint32_t i = 0, w = width, h = height; i < levelCount; ++i) {
+        levels.push_back({ w, h, totalSize, uint64_t(w) * h * KTX2_TEXEL_SIZE });
+        totalSize += levels.back().size;
+        w = std::max(1u, w / 2);
+        h = std::max(1u, h / 2);
+    }
+    data.resize(static_cast<size_t>(totalSize));
+    memcpy(data.data(), pixels, static_cast<size_t>(levels[0].size));
+
+    // 颜色通道按sRGB解码后平均；alpha始终是线性的
+    float toLinear[256];
+    for (int i = 0; i < 256; ++i) {
+        toLinear[i] = srgb ? srgbToLinear(i / 255.0f) : i / 255.0f;
+    }
+    auto encode = [srgb](float c) {
+        const float v = srgb ? linearToSrgb(c) : c;
+        return static_cast<uint8_t>(std::clamp(v * 255.0f + 0.5f, 0.0f, 255.0f));
+    };
+
+    for (uint32_t i = 1; i < levelCount; ++i) {
+        const TextureLevel& src = levels[i - 1];
+        const TextureLevel& dst = levels[i];
+        const uint8_t* s = data.data() + src.offset;
+        uint8_t* d = data.data() + dst.offset;
+        for (uint32_t y = 0; y < dst.height; ++y) {
+            const uint32_t y0 = std::min(y * 2, src.height - 1);
+            const uint32_t y1 = std::min(y * 2 + 1, src.height - 1);
+            for (uint32_t x = 0; x < dst.width; ++x) {
+                const uint32_t x0 = std::min(x * 2, src.width - 1);
+                const uint32_t x1 = std::min(x * 2 + 1, src.width - 1);
+                const uint8_t* p[4] = {
+                    s + (size_t(y0) * src.width + x0) * 4, s + (size_t(y0) * src.width + x1) * 4,
+                    s + (size_t(y1) * src.width + x0) * 4, s + (size_t(y1) * src.width + x1) * 4,
+                };
+                uint8_t* out = d + (size_t(y) * dst.width + x) * 4;
+                for (int c = 0; c < 3; ++c) {
+                    out[c] = encode((toLinear[p[0][c]] + toLinear[p[1][c]] + toLinear[p[2][c]] + toLinear[p[3][c]]) * 0.25f);
+                }
+                out[3] = static_cast<uint8_t>((p[0][3] + p[1][3] + p[2][3] + p[3][3] + 2) / 4);
+            }
+        }
+    }
+}
+
+bool Ktx2Texture::open(const std::string& path, uint32_t vkFormat, uint64_t sourceHash) {
+    close();
+    if (!m_file.open(path)) {
+        return false;
+    }
+    return parse(m_file.data(), m_file.size(), vkFormat, &sourceHash);
+}
+
+bool Ktx2Texture::openMemory(const uint8_t* data, size_t size, uint32_t vkFormat, const uint64_t* sourceHash) {
+    close();
+    return parse(data, size, vkFormat, sourceHash);
+}
+
+bool Ktx2Texture::parse(const uint8_t* file, size_t size, uint32_t vkFormat, const uint64_t* sourceHash) {
+    const uint64_t fileSize = size;
+    const uint64_t levelIndexOffset = sizeof(KTX2_IDENTIFIER) + sizeof(Ktx2Header) + sizeof(Ktx2Index);
+    Ktx2FormatInfo info{};
+    Ktx2Header header{};
+    Ktx2Index  sections{};
+    if (fileSize < levelIndexOffset || memcmp(file, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        close();
+        return false;
+    }
+    memcpy(&header, file + sizeof(KTX2_IDENTIFIER), sizeof(header));
+    memcpy(&sections, file + sizeof(KTX2_IDENTIFIER) + sizeof(header), sizeof(sections));
+
+    if (header.vkFormat != vkFormat || !getFormatInfo(vkFormat, info) || header.typeSize != 1 ||
+        header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth != 0 ||
+        header.layerCount != 0 || header.faceCount != 1 || header.supercompressionScheme != 0 ||
+        header.levelCount == 0 || header.levelCount > 32 ||
+        levelIndexOffset + uint64_t(header.levelCount) * sizeof(Ktx2LevelIndex) > fileSize ||
+        uint64_t(sections.kvdByteOffset) + sections.kvdByteLength > fileSize) {
+        close();
+        return false;
+    }
+
+    // 源文件或烘焙流程变化后旧文件失效
+    std::string value;
+    const uint8_t* kvd = file + sections.kvdByteOffset;
+    if ((sourceHash != nullptr && (!findKeyValue(kvd, sections.kvdByteLength, KEY_SOURCE_HASH, value) || value != toHex(*sourceHash))) ||
+        !findKeyValue(kvd, sections.kvdByteLength, KEY_VERSION, value) || value != std::to_string(TEXTURE_CACHE_VERSION)) {
+        close();
+        return false;
+    }
+
+    std::vector<Ktx2LevelIndex> index(header.levelCount);
+    memcpy(index.data(), file + levelIndexOffset, sizeof(Ktx2LevelIndex) * index.size());
+
+    uint64_t begin = fileSize;
+    uint64_t end = 0;
+    uint32_t w = header.pixelWidth;
+    uint32_t h = header.pixelHeight;
+    for (uint32_t i = 0; i < header.levelCount; ++i) {
+        if (index[i].byteLength != levelSize(info, w, h) || index[i].byteOffset % info.blockBytes != 0 ||
+            index[i].byteOffset > fileSize || index[i].byteLength > fileSize - index[i].byteOffset) {
+            close();
+            return false;
+        }
+        begin = std::min(begin, index[i].byteOffset);
+        end = std::max(end, index[i].byteOffset + index[i].byteLength);
+        w = std::max(1u, w / 2);
+        h = std::max(1u, h / 2);
+    }
+
+    m_data = file;
+    m_width = header.pixelWidth;
+    m_height = header.pixelHeight;
+    m_levelDataOffset = begin;
+    m_levelDataSize = end - begin;
+    w = m_width;
+    h = m_height;
+    for (uint32_t i = 0; i < header.levelCount; ++i) {
+        m_levels.push_back({ w, h, index[i].byteOffset - begin, index[i].byteLength });
+        w = std::max(1u, w / 2);
+        h = std::max(1u, h / 2);
+    }
+    return true;
+}
+
+void Ktx2Texture::close() {
+    m_data = nullptr;
+    m_levels.clear();
+    m_width = 0;
+    m_height = 0;
+    m_levelDataOffset = 0;
+    m_levelDataSize = 0;
+    m_file.close();
+}
+
+bool writeKtx2(const std::string& path, uint32_t vkFormat, uint32_t width, uint32_t height,
+               const uint8_t* data, const std::vector<TextureLevel>& levels, uint64_t sourceHash) {
+    Ktx2FormatInfo info{};
+    if (!getFormatInfo(vkFormat, info) || levels.empty()) {
+        return false;
+    }
+
+    const std::vector<uint32_t> dfd = makeDfd(info);
+
+    // 键按字节序排列；图像数据第一行是纹理的底边（加载时做了垂直翻转）
+    std::vector<uint8_t> kvd;
+    appendKeyValue(kvd, KEY_ORIENTATION, "ru");
+    appendKeyValue(kvd, KEY_WRITER, "khronos_vulkan_tutorial texture baker");
+    appendKeyValue(kvd, KEY_SOURCE_HASH, toHex(sourceHash));
+    appendKeyValue(kvd, KEY_VERSION, std::to_string(TEXTURE_CACHE_VERSION));
+
+    Ktx2Header header{};
+    header.vkFormat = vkFormat;
+    header.typeSize = 1;
+    header.pixelWidth = width;
+    header.pixelHeight = height;
+    header.faceCount = 1;
+    header.levelCount = static_cast<uint32_t>(levels.size());
+
+    const uint64_t levelIndexOffset = sizeof(KTX2_IDENTIFIER) + sizeof(Ktx2Header) + sizeof(Ktx2Index);
+    Ktx2Index sections{};
+    sections.dfdByteOffset = static_cast<uint32_t>(levelIndexOffset + sizeof(Ktx2LevelIndex) * levels.size());
+    sections.dfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+    sections.kvdByteOffset = sections.dfdByteOffset + sections.dfdByteLength;
+    sections.kvdByteLength = static_cast<uint32_t>(kvd.size());
+
+    // 规范要求级别数据从最小的一级开始存放，每级按块大小与4的最小公倍数对齐（这里的块大小都是4的倍数）
+    std::vector<Ktx2LevelIndex> index(levels.size());
+    uint64_t offset = sections.kvdByteOffset + sections.kvdByteLength;
+    for (size_t i = levels.size(); i-- > 0;) {
+        offset = alignUp(offset, info.blockBytes);
+        index[i] = { offset, levels[i].size, levels[i].size };
+        offset += levels[i].size;
+    }
+
+    std::vector<uint8_t> file(static_cast<size_t>(offset), 0);
+    memcpy(file.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    memcpy(file.data() + sizeof(KTX2_IDENTIFIER), &header, sizeof(header));
+    memcpy(file.data() + sizeof(KTX2_IDENTIFIER) + sizeof(header), &sections, sizeof(sections));
+    memcpy(file.data() + levelIndexOffset, index.data(), sizeof(Ktx2LevelIndex) * index.size());
+    memcpy(file.data() + sections.dfdByteOffset, dfd.data(), sections.dfdByteLength);
+    memcpy(file.data() + sections.kvdByteOffset, kvd.data(), kvd.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        memcpy(file.data() + index[i].byteOffset, data + levels[i].offset, static_cast<size_t>(levels[i].size));
+    }
+    return writeFileAtomically(path, file.data(), file.size());
+}
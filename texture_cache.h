@@ -0,0 +1,71 @@
+#ifndef TEXTURE_CACHE_H
+#define TEXTURE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mesh_cache.h"
+
+// 与VkFormat取值一致，本模块不依赖Vulkan头文件
+constexpr uint32_t KTX2_FORMAT_R8G8B8A8_UNORM = 37;
+constexpr uint32_t KTX2_FORMAT_R8G8B8A8_SRGB = 43;
+constexpr uint32_t KTX2_FORMAT_BC1_RGB_UNORM = 131;
+constexpr uint32_t KTX2_FORMAT_BC1_RGB_SRGB = 132;
+constexpr uint32_t KTX2_FORMAT_BC7_UNORM = 145;
+constexpr uint32_t KTX2_FORMAT_BC7_SRGB = 146;
+
+// 烘焙流程（滤波方式等）改变时必须递增，使旧的KTX2文件失效
+constexpr uint32_t TEXTURE_CACHE_VERSION = 1;
+
+// mip链中的一级，offset相对于所有级别数据的起点
+struct TextureLevel {
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+// 在CPU上生成完整的RGBA8 mip链，每级为上一级的2x2盒式滤波（奇数尺寸时末行/末列被丢弃，与vkCmdBlitImage一致）。
+// srgb为true时在线性空间求平均再转换回sRGB。data中按级别从大到小连续存放
+void generateMipChainRGBA8(const uint8_t* pixels, uint32_t width, uint32_t height, bool srgb,
+                           std::vector<uint8_t>& data, std::vector<TextureLevel>& levels);
+
+// 只读的KTX2纹理（未超压缩、单层、单面的二维RGBA8/BC1/BC7纹理），级别数据直接指向映射内存
+class Ktx2Texture {
+public:
+    // 映射文件并校验格式、尺寸与烘焙时记录的源文件哈希、版本，任一不匹配都视为未命中
+    bool open(const std::string& path, uint32_t vkFormat, uint64_t sourceHash);
+    // 使用调用方持有的内存（资源归档中的纹理），校验内容与open()相同；sourceHash为nullptr时（源文件不存在）不校验哈希
+    bool openMemory(const uint8_t* data, size_t size, uint32_t vkFormat, const uint64_t* sourceHash);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    uint32_t width() const { return m_width; }
+    uint32_t height() const { return m_height; }
+
+    // 所有级别数据所在的连续内存，levels()中的offset相对于它
+    const uint8_t* levelData() const { return m_data + m_levelDataOffset; }
+    uint64_t levelDataSize() const { return m_levelDataSize; }
+    const std::vector<TextureLevel>& levels() const { return m_levels; }
+
+private:
+    // sourceHash为nullptr时不校验源文件哈希
+    bool parse(const uint8_t* data, size_t size, uint32_t vkFormat, const uint64_t* sourceHash);
+
+    MappedFile                m_file;
+    const uint8_t*            m_data { nullptr }; // 指向m_file或调用方的内存
+    uint32_t                  m_width { 0 };
+    uint32_t                  m_height { 0 };
+    uint64_t                  m_levelDataOffset { 0 };
+    uint64_t                  m_levelDataSize { 0 };
+    std::vector<TextureLevel> m_levels;
+};
+
+// 写出KTX2文件：级别数据按规范从小到大存放，键值数据中记录源文件哈希与烘焙版本。
+// 先写入临时文件再重命名；只支持上面列出的格式
+bool writeKtx2(const std::string& path, uint32_t vkFormat, uint32_t width, uint32_t height,
+               const uint8_t* data, const std::vector<TextureLevel>& levels, uint64_t sourceHash);
+
+#endif // TEXTURE_CACHE_H
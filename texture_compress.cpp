@@ -0,0 +1,436 @@
+#include "texture_compress.h"
+
+#include "job_system.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TEXTURE_COMPRESS_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace {
+    // 一个4x4块，按通道分开存放（SoA），SIMD一次处理同一通道的4个texel
+    struct Block {
+        alignas(16) float channels[4][16];
+    };
+
+    void loadBlock(Block& block, const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY) {
+        for (uint32_t y = 0; y < BC_BLOCK_DIMENSION; ++y) {
+            const uint32_t sy = std::min(blockY * BC_BLOCK_DIMENSION + y, height - 1);
+            for (uint32_t x = 0; x < BC_BLOCK_DIMENSION; ++x) {
+                const uint32_t sx = std::min(blockX * BC_BLOCK_DIMENSION + x, width - 1);
+                const uint8_t* p = pixels + (size_t(sy) * width + sx) * 4;
+                for (uint32_t c = 0; c < 4; ++c) {
+                    block.channels[c][y * BC_BLOCK_DIMENSION + x] = p[c];
+                }
+            }
+        }
+    }
+
+    // 为每个texel选择调色板中误差最小的一项，返回整块的平方误差之和；channelCount为3时忽略alpha
+    float selectIndices(const Block& block, const float (*palette)[4], uint32_t paletteSize, uint32_t channelCount,
+                        uint8_t indices[16]) {
+#ifdef TEXTURE_COMPRESS_USE_SSE2
+        __m128 total = _mm_setzero_ps();
+        for (uint32_t group = 0; group < 16; group += 4) {
+            __m128 texel[4];
+            for (uint32_t c = 0; c < channelCount; ++c) {
+                texel[c] = _mm_load_ps(&block.channels[c][group]);
+            }
+            __m128  best = _mm_set1_ps(FLT_MAX);
+            __m128i bestIndex = _mm_setzero_si128();
+            for (uint32_t i = 0; i < paletteSize; ++i) {
+                __m128 distance = _mm_setzero_ps();
+                for (uint32_t c = 0; c < channelCount; ++c) {
+                    const __m128 d = _mm_sub_ps(texel[c], _mm_set1_ps(palette[i][c]));
+                    distance = _mm_add_ps(distance, _mm_mul_ps(d, d));
+                }
+                const __m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+                bestIndex = _mm_or_si128(_mm_and_si128(closer, _mm_set1_epi32(static_cast<int>(i))),
+                                         _mm_andnot_si128(closer, bestIndex));
+                best = _mm_min_ps(distance, best);
+            }
+            alignas(16) int32_t selected[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(selected), bestIndex);
+            for (uint32_t k = 0; k < 4; ++k) {
+                indices[group + k] = static_cast<uint8_t>(selected[k]);
+            }
+            total = _mm_add_ps(total, best);
+        }
+        alignas(16) float sums[4];
+        _mm_store_ps(sums, total);
+        return sums[0] + sums[1] + sums[2] + sums[3];
+#else
+        float total = 0.0f;
+        for (uint32_t t = 0; t < 16; ++t) {
+            float best = FLT_MAX;
+            for (uint32_t i = 0; i < paletteSize; ++i) {
+                float distance = 0.0f;
+                for (uint32_t c = 0; c < channelCount; ++c) {
+                    const float d = block.channels[c][t] - palette[i][c];
+                    distance += d * d;
+                }
+                if (distance < best) {
+                    best = distance;
+                    indices[t] = static_cast<uint8_t>(i);
+                }
+            }
+            total += best;
+        }
+        return total;
+#endif
+    }
+
+    // 沿块内颜色分布的主轴（协方差矩阵幂迭代）取投影最远的两点作为初始端点
+    void principalEndpoints(const Block& block, uint32_t channelCount, float e0[4], float e1[4]) {
+        float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        for (uint32_t c = 0; c < channelCount; ++c) {
+            for (uint32_t t = 0; t < 16; ++t) {
+                mean[c] += block.channels[c][t];
+            }
+            mean[c] /= 16.0f;
+        }
+
+        float covariance[4][4] = {};
+        for (uint32_t t = 0; t < 16; ++t) {
+            for (uint32_t i = 0; i < channelCount; ++i) {
+                for (uint32_t j = i; j < channelCount; ++j) {
+                    covariance[i][j] += (block.channels[i][t] - mean[i]) * (block.channels[j][t] - mean[j]);
+                }
+            }
+        }
+        for (uint32_t i = 0; i < channelCount; ++i) {
+            for (uint32_t j = 0; j < i; ++j) {
+                covariance[i][j] = covariance[j][i];
+            }
+        }
+
+        float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 8; ++iteration) {
+            float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            float largest = 0.0f;
+            for (uint32_t i = 0; i < channelCount; ++i) {
+                for (uint32_t j = 0; j < channelCount; ++j) {
+                    next[i] += covariance[i][j] * axis[j];
+                }
+                largest = std::max(largest, std::fabs(next[i]));
+            }
+            if (largest <= 0.0f) {
+                break;
+            }
+            for (uint32_t i = 0; i < channelCount; ++i) {
+                axis[i] = next[i] / largest;
+            }
+        }
+
+        float axisLength = 0.0f;
+        for (uint32_t c = 0; c < channelCount; ++c) {
+            axisLength += axis[c] * axis[c];
+        }
+        axisLength = std::sqrt(axisLength);
+        float tMin = 0.0f;
+        float tMax = 0.0f;
+        if (axisLength > 0.0f) {
+            tMin = FLT_MAX;
+            tMax = -FLT_MAX;
+            for (uint32_t c = 0; c < channelCount; ++c) {
+                axis[c] /= axisLength;
+            }
+            for (uint32_t t = 0; t < 16; ++t) {
+                float projection = 0.0f;
+                for (uint32_t c = 0; c < channelCount; ++c) {
+                    projection += (block.channels[c][t] - mean[c]) * axis[c];
+                }
+                tMin = std::min(tMin, projection);
+                tMax = std::max(tMax, projection);
+            }
+        }
+        for (uint32_t c = 0; c < 4; ++c) {
+            const float a = c < channelCount ? axis[c] : 0.0f;
+            e0[c] = std::clamp(mean[c] + tMin * a, 0.0f, 255.0f);
+            e1[c] = std::clamp(mean[c] + tMax * a, 0.0f, 255.0f);
+        }
+        if (channelCount < 4) {
+            e0[3] = e1[3] = 255.0f;
+        }
+    }
+
+    // 已知每个texel在两端点之间的插值权重时，用最小二乘求两端点
+    bool leastSquaresEndpoints(const Block& block, const float weights[16], uint32_t channelCount, float e0[4], float e1[4]) {
+        float a = 0.0f, b = 0.0f, c = 0.0f;
+        float rhs0[4] = {}, rhs1[4] = {};
+        for (uint32_t t = 0; t < 16; ++t) {
+            const float w = weights[t];
+            a += (1.0f - w) * (1.0f - w);
+            b += (1.0f - w) * w;
+            c += w * w;
+            for (uint32_t k = 0; k < channelCount; ++k) {
+                rhs0[k] += (1.0f - w) * block.channels[k][t];
+                rhs1[k] += w * block.channels[k][t];
+            }
+        }
+        const float determinant = a * c - b * b;
+        if (std::fabs(determinant) < 1e-6f) {
+            return false;
+        }
+        for (uint32_t k = 0; k < channelCount; ++k) {
+            e0[k] = std::clamp((c * rhs0[k] - b * rhs1[k]) / determinant, 0.0f, 255.0f);
+            e1[k] = std::clamp((a * rhs1[k] - b * rhs0[k]) / determinant, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    uint16_t packRGB565(const float color[4]) {
+        const uint32_t r = static_cast<uint32_t>(color[0] * 31.0f / 255.0f + 0.5f);
+        const uint32_t g = static_cast<uint32_t>(color[1] * 63.0f / 255.0f + 0.5f);
+        const uint32_t b = static_cast<uint32_t>(color[2] * 31.0f / 255.0f + 0.5f);
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    void unpackRGB565(uint16_t value, float color[4]) {
+        const uint32_t r = (value >> 11) & 31;
+        const uint32_t g = (value >> 5) & 63;
+        const uint32_t b = value & 31;
+        color[0] = static_cast<float>((r << 3) | (r >> 2));
+        color[1] = static_cast<float>((g << 2) | (g >> 4));
+        color[2] = static_cast<float>((b << 3) | (b >> 2));
+        color[3] = 255.0f;
+    }
+
+    // BC1四色模式：color0 > color1，调色板为 c0, c1, (2c0+c1)/3, (c0+2c1)/3
+    float encodeBC1(const Block& block, const float e0[4], const float e1[4], uint8_t out[BC1_BLOCK_BYTES],
+                    float weights[16]) {
+        uint16_t c0 = packRGB565(e0);
+        uint16_t c1 = packRGB565(e1);
+        if (c0 < c1) {
+            std::swap(c0, c1);
+        }
+
+        float palette[4][4];
+        unpackRGB565(c0, palette[0]);
+        unpackRGB565(c1, palette[1]);
+        for (uint32_t c = 0; c < 4; ++c) {
+            palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+            palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+        }
+
+        uint8_t indices[16];
+        float error = selectIndices(block, palette, c0 == c1 ? 1 : 4, 3, indices);
+
+        static constexpr float INDEX_WEIGHTS[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        uint32_t bits = 0;
+        for (uint32_t t = 0; t < 16; ++t) {
+            bits |= static_cast<uint32_t>(indices[t]) << (t * 2);
+            weights[t] = INDEX_WEIGHTS[indices[t]];
+        }
+        out[0] = static_cast<uint8_t>(c0);
+        out[1] = static_cast<uint8_t>(c0 >> 8);
+        out[2] = static_cast<uint8_t>(c1);
+        out[3] = static_cast<uint8_t>(c1 >> 8);
+        memcpy(out + 4, &bits, sizeof(bits));
+        return error;
+    }
+
+    void compressBlockBC1(const Block& block, uint8_t out[BC1_BLOCK_BYTES]) {
+        float e0[4], e1[4], weights[16];
+        principalEndpoints(block, 3, e0, e1);
+        float error = encodeBC1(block, e0, e1, out, weights);
+
+        // 按选出的索引做一次最小二乘细化，误差更小时采用
+        float palette0[4], palette1[4];
+        unpackRGB565(static_cast<uint16_t>(out[0] | (out[1] << 8)), palette0);
+        unpackRGB565(static_cast<uint16_t>(out[2] | (out[3] << 8)), palette1);
+        if (leastSquaresEndpoints(block, weights, 3, palette0, palette1)) {
+            uint8_t refined[BC1_BLOCK_BYTES];
+            if (encodeBC1(block, palette0, palette1, refined, weights) < error) {
+                memcpy(out, refined, BC1_BLOCK_BYTES);
+            }
+        }
+    }
+
+    constexpr uint32_t BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    // 按LSB在前的顺序写入128位的BC7块
+    struct BitWriter {
+        uint8_t* out;
+        uint32_t position;
+
+        void write(uint32_t value, uint32_t bitCount) {
+            for (uint32_t i = 0; i < bitCount; ++i, ++position) {
+                out[position >> 3] |= static_cast<uint8_t>(((value >> i) & 1u) << (position & 7));
+            }
+        }
+    };
+
+    // BC7模式6：RGBA端点各7位加每端点一位p位，16项4位索引。依次尝试四种p位组合，取误差最小的一种
+    float encodeBC7Mode6(const Block& block, const float e0[4], const float e1[4], uint8_t out[BC7_BLOCK_BYTES],
+                         float weights[16]) {
+        float   bestError = FLT_MAX;
+        uint32_t bestQ[2][4] = {};
+        uint32_t bestP[2] = {};
+        uint8_t bestIndices[16] = {};
+        for (uint32_t p0 = 0; p0 < 2; ++p0) {
+            for (uint32_t p1 = 0; p1 < 2; ++p1) {
+                uint32_t q[2][4];
+                float endpoints[2][4];
+                for (uint32_t c = 0; c < 4; ++c) {
+                    q[0][c] = static_cast<uint32_t>(std::clamp((e0[c] - p0) * 0.5f + 0.5f, 0.0f, 127.0f));
+                    q[1][c] = static_cast<uint32_t>(std::clamp((e1[c] - p1) * 0.5f + 0.5f, 0.0f, 127.0f));
+                    endpoints[0][c] = static_cast<float>((q[0][c] << 1) | p0);
+                    endpoints[1][c] = static_cast<float>((q[1][c] << 1) | p1);
+                }
+                float palette[16][4];
+                for (uint32_t i = 0; i < 16; ++i) {
+                    for (uint32_t c = 0; c < 4; ++c) {
+                        const uint32_t v = ((64 - BC7_WEIGHTS4[i]) * static_cast<uint32_t>(endpoints[0][c]) +
+                            BC7_WEIGHTS4[i] * static_cast<uint32_t>(endpoints[1][c]) + 32) >> 6;
+                        palette[i][c] = static_cast<float>(v);
+                    }
+                }
+                uint8_t indices[16];
+                const float error = selectIndices(block, palette, 16, 4, indices);
+                if (error < bestError) {
+                    bestError = error;
+                    memcpy(bestQ, q, sizeof(q));
+                    bestP[0] = p0;
+                    bestP[1] = p1;
+                    memcpy(bestIndices, indices, sizeof(indices));
+                }
+            }
+        }
+
+        // 第一个texel的索引最高位隐含为0，不满足时交换两端点并翻转所有索引
+        if (bestIndices[0] >= 8) {
+            std::swap(bestQ[0], bestQ[1]);
+            std::swap(bestP[0], bestP[1]);
+            for (uint8_t& index : bestIndices) {
+                index = static_cast<uint8_t>(15 - index);
+            }
+        }
+
+        memset(out, 0, BC7_BLOCK_BYTES);
+        BitWriter writer{ out, 0 };
+        writer.write(1u << 6, 7);
+        for (uint32_t c = 0; c < 4; ++c) {
+            writer.write(bestQ[0][c], 7);
+            writer.write(bestQ[1][c], 7);
+        }
+        writer.write(bestP[0], 1);
+        writer.write(bestP[1], 1);
+        writer.write(bestIndices[0], 3);
+        for (uint32_t t = 1; t < 16; ++t) {
+            writer.write(bestIndices[t], 4);
+        }
+
+        for (uint32_t t = 0; t < 16; ++t) {
+            weights[t] = BC7_WEIGHTS4[bestIndices[t]] / 64.0f;
+        }
+        return bestError;
+    }
+
+    void compressBlockBC7(const Block& block, uint8_t out[BC7_BLOCK_BYTES]) {
+        float e0[4], e1[4], weights[16];
+        principalEndpoints(block, 4, e0, e1);
+        const float error = encodeBC7Mode6(block, e0, e1, out, weights);
+        if (error == 0.0f) {
+            return;
+        }
+
+        // 端点可能因锚点规则被交换过，权重始终相对于写入的端点0，直接对它们做最小二乘
+        float r0[4], r1[4];
+        if (leastSquaresEndpoints(block, weights, 4, r0, r1)) {
+            uint8_t refined[BC7_BLOCK_BYTES];
+            if (encodeBC7Mode6(block, r0, r1, refined, weights) < error) {
+                memcpy(out, refined, BC7_BLOCK_BYTES);
+            }
+        }
+    }
+}
+
+const char* textureCompressionName(TextureCompression compression) {
+    switch (compression) {
+    case TextureCompression::BC1: return "bc1";
+    case TextureCompression::BC7: return "bc7";
+    default: return "rgba8";
+    }
+}
+
+uint32_t textureBlockDimension(TextureCompression compression) {
+    return compression == TextureCompression::None ? 1 : BC_BLOCK_DIMENSION;
+}
+
+uint32_t textureBlockBytes(TextureCompression compression) {
+    switch (compression) {
+    case TextureCompression::BC1: return BC1_BLOCK_BYTES;
+    case TextureCompression::BC7: return BC7_BLOCK_BYTES;
+    default: return 4;
+    }
+}
+
+uint64_t compressedLevelSize(TextureCompression compression, uint32_t width, uint32_t height) {
+    const uint64_t blocks = uint64_t((width + BC_BLOCK_DIMENSION - 1) / BC_BLOCK_DIMENSION) *
+        ((height + BC_BLOCK_DIMENSION - 1) / BC_BLOCK_DIMENSION);
+    switch (compression) {
+    case TextureCompression::BC1: return blocks * BC1_BLOCK_BYTES;
+    case TextureCompression::BC7: return blocks * BC7_BLOCK_BYTES;
+    default: return uint64_t(width) * height * 4;
+    }
+}
+
+bool isOpaqueRGBA8(const uint8_t* pixels, size_t texelCount) {
+    for (size_t i = 0; i < texelCount; ++i) {
+        if (pixels[i * 4 + 3] != 255) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void compressImage(TextureCompression compression, const uint8_t* pixels, uint32_t width, uint32_t height,
+                   uint8_t* destination, JobSystem& jobs) {
+    if (compression == TextureCompression::None) {
+        memcpy(destination, pixels, size_t(width) * height * 4);
+        return;
+    }
+
+    const uint32_t blocksX = (width + BC_BLOCK_DIMENSION - 1) / BC_BLOCK_DIMENSION;
+    const uint32_t blocksY = (height + BC_BLOCK_DIMENSION - 1) / BC_BLOCK_DIMENSION;
+    const size_t blockBytes = compression == TextureCompression::BC1 ? BC1_BLOCK_BYTES : BC7_BLOCK_BYTES;
+    JobCounter counter;
+    jobs.parallelFor(blocksY, TEXTURE_COMPRESS_ROWS_PER_JOB,
+        [&](uint32_t first, uint32_t count) {
+            Block block;
+            for (size_t by = first; by < first + count; ++by) {
+                for (uint32_t bx = 0; bx < blocksX; ++bx) {
+                    loadBlock(block, pixels, width, height, bx, static_cast<uint32_t>(by));
+                    uint8_t* out = destination + (by * blocksX + bx) * blockBytes;
+                    if (compression == TextureCompression::BC1) {
+                        compressBlockBC1(block, out);
+                    } else {
+                        compressBlockBC7(block, out);
+                    }
+                }
+            }
+        }, counter);
+    jobs.wait(counter);
+}
+
+void compressMipChain(TextureCompression compression, const uint8_t* data, const std::vector<TextureLevel>& levels,
+                      std::vector<uint8_t>& compressed, std::vector<TextureLevel>& compressedLevels, JobSystem& jobs) {
+    compressedLevels.clear();
+    uint64_t totalSize = 0;
+    for (const TextureLevel& level : levels) {
+        const uint64_t size = compressedLevelSize(compression, level.width, level.height);
+        compressedLevels.push_back({ level.width, level.height, totalSize, size });
+        totalSize += size;
+    }
+    compressed.resize(static_cast<size_t>(totalSize));
+    for (size_t i = 0; i < levels.size(); ++i) {
+        compressImage(compression, data + levels[i].offset, levels[i].width, levels[i].height,
+            compressed.data() + compressedLevels[i].offset, jobs);
+    }
+}
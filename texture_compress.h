@@ -0,0 +1,45 @@
+#ifndef TEXTURE_COMPRESS_H
+#define TEXTURE_COMPRESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "texture_cache.h"
+
+class JobSystem;
+
+// 块压缩格式：BC1为4bpp（只用不透明的四色模式），BC7为8bpp（只用模式6：单分区RGBA、7位端点+p位、4位索引）
+enum class TextureCompression {
+    None,
+    BC1,
+    BC7,
+};
+
+constexpr uint32_t BC_BLOCK_DIMENSION = 4;
+constexpr size_t   BC1_BLOCK_BYTES = 8;
+constexpr size_t   BC7_BLOCK_BYTES = 16;
+constexpr uint32_t TEXTURE_COMPRESS_ROWS_PER_JOB = 4; // 每个压缩任务的块行数，任务较小以便工作线程之间均衡负载
+
+const char* textureCompressionName(TextureCompression compression);
+
+// 拷贝时的块尺寸与每块字节数，未压缩格式的块即单个texel
+uint32_t textureBlockDimension(TextureCompression compression);
+uint32_t textureBlockBytes(TextureCompression compression);
+
+// 压缩后一级纹理的字节数，不足4x4的边缘按整块计
+uint64_t compressedLevelSize(TextureCompression compression, uint32_t width, uint32_t height);
+
+// 所有texel的alpha都是255时返回true，此时可以使用不带alpha的BC1
+bool isOpaqueRGBA8(const uint8_t* pixels, size_t texelCount);
+
+// 把一级RGBA8图像压缩为BC1/BC7块，每TEXTURE_COMPRESS_ROWS_PER_JOB个块行一个任务，在jobs上执行，调用线程在wait()中帮忙；
+// 边缘不足4x4的块复制最后一行/列补齐。误差在sRGB编码后的数值上计算，两种格式的索引选择都用SSE2一次处理4个texel
+void compressImage(TextureCompression compression, const uint8_t* pixels, uint32_t width, uint32_t height,
+                   uint8_t* destination, JobSystem& jobs);
+
+// 压缩整条mip链，输出的levels与输入一一对应
+void compressMipChain(TextureCompression compression, const uint8_t* data, const std::vector<TextureLevel>& levels,
+                      std::vector<uint8_t>& compressed, std::vector<TextureLevel>& compressedLevels, JobSystem& jobs);
+
+#endif // TEXTURE_COMPRESS_H
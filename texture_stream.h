@@ -0,0 +1,138 @@
+#ifndef TEXTURE_STREAM_H
+#define TEXTURE_STREAM_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// 逐页读取一段内存（通常位于映射文件中），让缺页与磁盘读取发生在调用线程上。返回值只用于防止读取被优化掉
+inline uint64_t prefetchPages(const uint8_t* data, size_t size) {
+    constexpr size_t PAGE_SIZE = 4096;
+    uint64_t sum = 0;
+    for (size_t offset = 0; offset < size; offset += PAGE_SIZE) {
+        sum += static_cast<const volatile uint8_t*>(data)[offset];
+    }
+    return sum;
+}
+
+// mip流式加载：后台线程按从粗到细的顺序逐级调用loadLevel预读数据（例如用prefetchPages让映射文件的缺页发生在后台线程），
+// 渲染线程每帧通过poll()非阻塞地取走已就绪的级别，自行上传。
+// 就绪队列最多保存maxPending个级别，渲染线程来不及消费时后台线程会等待，预读不会远远领先于上传
+template <typename Upload>
+class MipStreamer {
+public:
+    using LoadLevel = std::function<Upload(uint32_t level)>;
+    using ReadyLevel = std::pair<uint32_t, Upload>;
+
+    MipStreamer() = default;
+    MipStreamer(const MipStreamer&) = delete;
+    MipStreamer& operator=(const MipStreamer&) = delete;
+
+    // 析构时未取走的上传数据直接丢弃，持有资源时应先调用stop()自行释放
+    ~MipStreamer() {
+        std::vector<ReadyLevel> discarded;
+        stop(discarded);
+    }
+
+    // 依次加载级别endLevel-1, endLevel-2, ..., firstLevel
+    void start(uint32_t firstLevel, uint32_t endLevel, size_t maxPending, LoadLevel loadLevel) {
+        std::vector<ReadyLevel> discarded;
+        stop(discarded);
+
+        m_stopRequested = false;
+        m_error = nullptr;
+        m_remaining = endLevel > firstLevel ? endLevel - firstLevel : 0;
+        m_maxPending = std::max<size_t>(1, maxPending);
+        if (m_remaining == 0) {
+            return;
+        }
+        m_thread = std::thread([this, firstLevel, endLevel, loadLevel = std::move(loadLevel)]() {
+            for (uint32_t level = endLevel; level-- > firstLevel;) {
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]() { return m_stopRequested || m_ready.size() < m_maxPending; });
+                    if (m_stopRequested) {
+                        return;
+                    }
+                }
+                try {
+                    Upload upload = loadLevel(level);
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_ready.emplace_back(level, std::move(upload));
+                } catch (...) {
+                    // 异常留到渲染线程的poll()中重新抛出
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_error = std::current_exception();
+                    return;
+                }
+            }
+        });
+    }
+
+    // 所有级别都已被poll()取走
+    bool finished() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_remaining == 0;
+    }
+
+    // 取出已就绪的级别追加到ready（按从粗到细的顺序），全部取走后回收后台线程
+    void poll(std::vector<ReadyLevel>& ready) {
+        std::exception_ptr error;
+        bool done = false;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_remaining -= m_ready.size();
+            for (ReadyLevel& level : m_ready) {
+                ready.push_back(std::move(level));
+            }
+            m_ready.clear();
+            error = m_error;
+            done = m_remaining == 0;
+        }
+        m_condition.notify_one();
+        if ((done || error) && m_thread.joinable()) {
+            m_thread.join();
+        }
+        if (error) {
+            m_error = nullptr;
+            m_remaining = 0;
+            std::rethrow_exception(error);
+        }
+    }
+
+    // 请求停止并等待后台线程退出；已加载但未取走的级别追加到pending，由调用方释放
+    void stop(std::vector<ReadyLevel>& pending) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopRequested = true;
+        }
+        m_condition.notify_one();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        for (ReadyLevel& level : m_ready) {
+            pending.push_back(std::move(level));
+        }
+        m_ready.clear();
+        m_remaining = 0;
+    }
+
+private:
+    mutable std::mutex       m_mutex;
+    std::condition_variable  m_condition;
+    std::thread              m_thread;
+    std::vector<ReadyLevel>  m_ready;
+    std::exception_ptr       m_error;
+    size_t                   m_remaining { 0 };
+    size_t                   m_maxPending { 1 };
+    bool                     m_stopRequested { false };
+};
+
+#endif // TEXTURE_STREAM_H
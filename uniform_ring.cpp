@@ -0,0 +1,72 @@
+#include "uniform_ring.h"
+
+#include <stdexcept>
+
+namespace {
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+void UniformRing::create(VmaAllocator allocator, VkPhysicalDevice physicalDevice, VkDeviceSize frameSize, uint32_t frameCount) {
+    m_allocator = allocator;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    m_alignment = properties.limits.minUniformBufferOffsetAlignment;
+    // 每一段的起点也要满足动态偏移的对齐
+    m_frameSize = alignUp(frameSize, m_alignment);
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = m_frameSize * frameCount;
+    bufferInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+
+    VmaAllocationInfo allocationInfo{};
+    if (vmaCreateBuffer(m_allocator, &bufferInfo, &allocInfo, &m_buffer, &m_allocation, &allocationInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create uniform ring buffer!");
+    }
+    m_data = static_cast<uint8_t*>(allocationInfo.pMappedData);
+    m_frameBegin = 0;
+    m_head = 0;
+    m_flushed = 0;
+}
+
+void UniformRing::destroy() {
+    if (m_buffer == VK_NULL_HANDLE) {
+        return;
+    }
+    vmaDestroyBuffer(m_allocator, m_buffer, m_allocation);
+    m_buffer = VK_NULL_HANDLE;
+    m_allocation = VK_NULL_HANDLE;
+    m_data = nullptr;
+}
+
+void UniformRing::beginFrame(uint32_t frameIndex) {
+    m_frameBegin = m_frameSize * frameIndex;
+    m_head = m_frameBegin;
+    m_flushed = m_frameBegin;
+}
+
+UniformRing::Allocation UniformRing::allocate(VkDeviceSize size) {
+    const VkDeviceSize offset = alignUp(m_head, m_alignment);
+    if (offset + size > m_frameBegin + m_frameSize) {
+        throw std::runtime_error("failed to allocate from uniform ring!");
+    }
+    m_head = offset + size;
+    return { m_data + offset, static_cast<uint32_t>(offset) };
+}
+
+void UniformRing::flush() {
+    if (m_head > m_flushed) {
+        vmaFlushAllocation(m_allocator, m_allocation, m_flushed, m_head - m_flushed);
+        m_flushed = m_head;
+    }
+}
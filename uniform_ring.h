@@ -0,0 +1,50 @@
+#ifndef UNIFORM_RING_H
+#define UNIFORM_RING_H
+
+#include <cstdint>
+#include <cstring>
+
+#include <vk_api.h>
+
+// 每帧常量的线性分配器：一个持久映射的缓冲区按并行帧分成frameCount段，beginFrame()时该帧的段从头开始使用
+// （调用方已经等待过该帧槽位的栅栏，GPU不再读取这一段）。allocate()只递增偏移，按minUniformBufferOffsetAlignment对齐，
+// 返回的偏移用作VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC的动态偏移：描述符只在创建时写一次，之后每次绑定只传偏移。
+// 只能在录制命令的线程中使用
+class UniformRing {
+public:
+    struct Allocation {
+        void*    data;
+        uint32_t offset; // 相对缓冲区起点，即绑定时的动态偏移
+    };
+
+    void create(VmaAllocator allocator, VkPhysicalDevice physicalDevice, VkDeviceSize frameSize, uint32_t frameCount);
+    void destroy();
+
+    VkBuffer buffer() const { return m_buffer; }
+    VmaAllocation allocation() const { return m_allocation; }
+
+    void beginFrame(uint32_t frameIndex);
+    // 当前帧的段用完时抛出异常
+    Allocation allocate(VkDeviceSize size);
+    template<typename T>
+    uint32_t push(const T& value) {
+        const Allocation allocation = allocate(sizeof(T));
+        memcpy(allocation.data, &value, sizeof(T));
+        return allocation.offset;
+    }
+    // 提交前调用，内存不是HOST_COHERENT时刷新本帧写入的范围
+    void flush();
+
+private:
+    VmaAllocator  m_allocator { VK_NULL_HANDLE };
+    VkBuffer      m_buffer { VK_NULL_HANDLE };
+    VmaAllocation m_allocation { VK_NULL_HANDLE };
+    uint8_t*      m_data { nullptr };
+    VkDeviceSize  m_alignment { 0 };
+    VkDeviceSize  m_frameSize { 0 };
+    VkDeviceSize  m_frameBegin { 0 };
+    VkDeviceSize  m_head { 0 };      // 当前帧已分配的结束位置
+    VkDeviceSize  m_flushed { 0 };   // 当前帧已刷新的结束位置
+};
+
+#endif // UNIFORM_RING_H
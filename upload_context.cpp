@@ -0,0 +1,453 @@
+#include "upload_context.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// 暂存分配的对齐：满足vkCmdCopyBufferToImage对bufferOffset的要求（4字节且为texel块大小的整数倍）
+constexpr VkDeviceSize STAGING_ALIGNMENT = 16;
+
+VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+} // namespace
+
+void UploadContext::create(VkDevice device, const VolkDeviceTable& deviceTable, VmaAllocator allocator,
+                           uint32_t graphicsQueueFamilyIdx, VkQueue graphicsQueue,
+                           uint32_t transferQueueFamilyIdx, VkQueue transferQueue, VkDeviceSize stagingSize) {
+    m_device = device;
+    m_deviceTable = &deviceTable;
+    m_allocator = allocator;
+    m_graphicsQueueFamilyIdx = graphicsQueueFamilyIdx;
+    m_graphicsQueue = graphicsQueue;
+    m_transferQueueFamilyIdx = transferQueueFamilyIdx;
+    m_transferQueue = transferQueue;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = m_transferQueueFamilyIdx;
+    if (m_deviceTable->vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_transferCommandPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload command pool!");
+    }
+    if (usesTransferQueue()) {
+        poolInfo.queueFamilyIndex = m_graphicsQueueFamilyIdx;
+        if (m_deviceTable->vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_graphicsCommandPool) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create upload command pool!");
+        }
+    }
+
+    VkSemaphoreTypeCreateInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &timelineInfo;
+    if (m_deviceTable->vkCreateSemaphore(m_device, &semaphoreInfo, nullptr, &m_semaphore) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create upload timeline semaphore!");
+    }
+    m_lastValue = 0;
+
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = stagingSize;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+    VmaAllocationCreateInfo allocInfo{};
+    allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+
+    VmaAllocationInfo stagingInfo{};
+    if (vmaCreateBuffer(m_allocator, &bufferInfo, &allocInfo, &m_stagingBuffer, &m_stagingAllocation, &stagingInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create staging ring buffer!");
+    }
+    m_stagingData = static_cast<uint8_t*>(stagingInfo.pMappedData);
+    m_stagingSize = stagingSize;
+    m_stagingHead = 0;
+    m_stagingTail = 0;
+}
+
+void UploadContext::destroy() {
+    if (m_device == VK_NULL_HANDLE) {
+        return;
+    }
+    // 录制了但未提交的命令直接丢弃
+    if (m_commandBuffer != VK_NULL_HANDLE) {
+        m_deviceTable->vkFreeCommandBuffers(m_device, m_transferCommandPool, 1, &m_commandBuffer);
+        m_commandBuffer = VK_NULL_HANDLE;
+    }
+    m_bufferBarriers.clear();
+    m_imageBarriers.clear();
+    m_bufferAcquireBarriers.clear();
+    m_imageAcquireBarriers.clear();
+
+    wait(m_lastValue);
+    collect();
+
+    vmaDestroyBuffer(m_allocator, m_stagingBuffer, m_stagingAllocation);
+    m_stagingBuffer = VK_NULL_HANDLE;
+    m_stagingAllocation = VK_NULL_HANDLE;
+    m_stagingData = nullptr;
+
+    m_deviceTable->vkDestroySemaphore(m_device, m_semaphore, nullptr);
+    m_semaphore = VK_NULL_HANDLE;
+    m_deviceTable->vkDestroyCommandPool(m_device, m_graphicsCommandPool, nullptr);
+    m_graphicsCommandPool = VK_NULL_HANDLE;
+    m_deviceTable->vkDestroyCommandPool(m_device, m_transferCommandPool, nullptr);
+    m_transferCommandPool = VK_NULL_HANDLE;
+    m_device = VK_NULL_HANDLE;
+}
+
+VkCommandBuffer UploadContext::allocateCommandBuffer(VkCommandPool commandPool) {
+    VkCommandBufferAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    allocInfo.commandPool = commandPool;
+    allocInfo.commandBufferCount = 1;
+
+    VkCommandBuffer commandBuffer;
+    if (m_deviceTable->vkAllocateCommandBuffers(m_device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to allocate upload command buffer!");
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (m_deviceTable->vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin recording upload command buffer!");
+    }
+    return commandBuffer;
+}
+
+VkCommandBuffer UploadContext::recordingCommandBuffer() {
+    if (m_commandBuffer == VK_NULL_HANDLE) {
+        m_commandBuffer = allocateCommandBuffer(m_transferCommandPool);
+    }
+    return m_commandBuffer;
+}
+
+bool UploadContext::fitsStaging(VkDeviceSize& head, VkDeviceSize size) const {
+    VkDeviceSize begin = alignUp(head, STAGING_ALIGNMENT);
+    const VkDeviceSize offset = begin % m_stagingSize;
+    if (offset + size > m_stagingSize) {
+        begin += m_stagingSize - offset; // 不跨越缓冲末尾，从下一圈的起点分配
+    }
+    if (begin + size - m_stagingTail > m_stagingSize) {
+        return false;
+    }
+    head = begin + size;
+    return true;
+}
+
+VkDeviceSize UploadContext::allocateStaging(VkDeviceSize size) {
+    for (;;) {
+        VkDeviceSize head = m_stagingHead;
+        if (fitsStaging(head, size)) {
+            m_stagingHead = head;
+            return (head - size) % m_stagingSize;
+        }
+
+        // 空间不足：当前批次占用的空间要等它提交并完成后才能回收
+        if (m_commandBuffer != VK_NULL_HANDLE) {
+            flush();
+        }
+        if (m_inFlight.empty()) {
+            throw std::runtime_error("staging allocation is larger than the staging ring!");
+        }
+        wait(m_inFlight.front().ticket);
+        collect();
+    }
+}
+
+void UploadContext::addBufferBarrier(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+                                     VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask) {
+    VkBufferMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2;
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.buffer = buffer;
+    barrier.offset = offset;
+    barrier.size = size;
+    if (usesTransferQueue()) {
+        // 传输队列释放所有权，图形队列以相同的参数获取
+        barrier.srcQueueFamilyIndex = m_transferQueueFamilyIdx;
+        barrier.dstQueueFamilyIndex = m_graphicsQueueFamilyIdx;
+        m_bufferBarriers.push_back(barrier);
+
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barrier.dstStageMask = dstStageMask;
+        barrier.dstAccessMask = dstAccessMask;
+        m_bufferAcquireBarriers.push_back(barrier);
+    } else {
+        barrier.dstStageMask = dstStageMask;
+        barrier.dstAccessMask = dstAccessMask;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        m_bufferBarriers.push_back(barrier);
+    }
+}
+
+void UploadContext::addImageBarrier(VkImage image, uint32_t baseMipLevel, uint32_t levelCount, VkImageLayout oldLayout,
+                                    VkImageLayout finalLayout, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask) {
+    // 布局转换包含在所有权转移中：释放与获取两侧的oldLayout/newLayout必须一致
+    VkImageMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    if (oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL) {
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+        barrier.srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    } else {
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+    }
+    barrier.oldLayout = oldLayout;
+    barrier.newLayout = finalLayout;
+    barrier.image = image;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, baseMipLevel, levelCount, 0, 1 };
+    if (usesTransferQueue()) {
+        barrier.dstStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.dstAccessMask = VK_ACCESS_2_NONE;
+        barrier.srcQueueFamilyIndex = m_transferQueueFamilyIdx;
+        barrier.dstQueueFamilyIndex = m_graphicsQueueFamilyIdx;
+        m_imageBarriers.push_back(barrier);
+
+        barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+        barrier.srcAccessMask = VK_ACCESS_2_NONE;
+        barrier.dstStageMask = dstStageMask;
+        barrier.dstAccessMask = dstAccessMask;
+        m_imageAcquireBarriers.push_back(barrier);
+    } else {
+        barrier.dstStageMask = dstStageMask;
+        barrier.dstAccessMask = dstAccessMask;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        m_imageBarriers.push_back(barrier);
+    }
+}
+
+void UploadContext::uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size,
+                                 VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask) {
+    const VkDeviceSize chunkLimit = m_stagingSize / 2;
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (VkDeviceSize copied = 0; copied < size;) {
+        const VkDeviceSize chunkSize = std::min(size - copied, chunkLimit);
+        const VkDeviceSize stagingOffset = allocateStaging(chunkSize);
+        memcpy(m_stagingData + stagingOffset, bytes + copied, static_cast<size_t>(chunkSize));
+        vmaFlushAllocation(m_allocator, m_stagingAllocation, stagingOffset, chunkSize);
+
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = stagingOffset;
+        copyRegion.dstOffset = dstOffset + copied;
+        copyRegion.size = chunkSize;
+        m_deviceTable->vkCmdCopyBuffer(recordingCommandBuffer(), m_stagingBuffer, dstBuffer, 1, &copyRegion);
+        copied += chunkSize;
+    }
+    // 中途提交过的分块在同一队列上更早执行，也在这个屏障的第一个同步范围内
+    addBufferBarrier(dstBuffer, dstOffset, size, dstStageMask, dstAccessMask);
+}
+
+void UploadContext::uploadImage(VkImage image, uint32_t baseMipLevel, uint32_t levelCount, const uint8_t* data, const TextureLevel* levels,
+                                uint32_t blockDimension, uint32_t blockBytes,
+                                VkImageLayout finalLayout, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask) {
+    VkImageMemoryBarrier2 barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+    barrier.srcStageMask = VK_PIPELINE_STAGE_2_NONE;
+    barrier.srcAccessMask = VK_ACCESS_2_NONE;
+    barrier.dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT;
+    barrier.dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, baseMipLevel, levelCount, 0, 1 };
+
+    VkDependencyInfo dependencyInfo{};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.imageMemoryBarrierCount = 1;
+    dependencyInfo.pImageMemoryBarriers = &barrier;
+    m_deviceTable->vkCmdPipelineBarrier2(recordingCommandBuffer(), &dependencyInfo);
+
+    const VkDeviceSize chunkLimit = m_stagingSize / 2;
+    for (uint32_t i = 0; i < levelCount; ++i) {
+        const TextureLevel& level = levels[i];
+        const uint32_t blockRows = (level.height + blockDimension - 1) / blockDimension;
+        const VkDeviceSize rowSize = VkDeviceSize((level.width + blockDimension - 1) / blockDimension) * blockBytes;
+        const uint32_t rowsPerChunk = static_cast<uint32_t>(std::max<VkDeviceSize>(1, chunkLimit / rowSize));
+
+        for (uint32_t row = 0; row < blockRows; row += rowsPerChunk) {
+            const uint32_t rowCount = std::min(rowsPerChunk, blockRows - row);
+            const VkDeviceSize chunkSize = rowSize * rowCount;
+            const VkDeviceSize stagingOffset = allocateStaging(chunkSize);
+            memcpy(m_stagingData + stagingOffset, data + level.offset + rowSize * row, static_cast<size_t>(chunkSize));
+            vmaFlushAllocation(m_allocator, m_stagingAllocation, stagingOffset, chunkSize);
+
+            // 按块行拆分时高度必须是块尺寸的整数倍，或者到达图像边缘
+            VkBufferImageCopy region{};
+            region.bufferOffset = stagingOffset;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = baseMipLevel + i;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = { 0, static_cast<int32_t>(row * blockDimension), 0 };
+            region.imageExtent = { level.width, std::min(rowCount * blockDimension, level.height - row * blockDimension), 1 };
+            m_deviceTable->vkCmdCopyBufferToImage(recordingCommandBuffer(), m_stagingBuffer, image,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+        }
+    }
+    addImageBarrier(image, baseMipLevel, levelCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, finalLayout, dstStageMask, dstAccessMask);
+}
+
+bool UploadContext::tryUploadImage(VkImage image, uint32_t baseMipLevel, uint32_t levelCount, const uint8_t* data, const TextureLevel* levels,
+                                   uint32_t blockDimension, uint32_t blockBytes,
+                                   VkImageLayout finalLayout, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask) {
+    collect();
+    if (!m_inFlight.empty() || m_commandBuffer != VK_NULL_HANDLE) {
+        // 按uploadImage()的分块方式模拟分配，任何一块需要等待时都不上传
+        const VkDeviceSize chunkLimit = m_stagingSize / 2;
+        VkDeviceSize head = m_stagingHead;
+        for (uint32_t i = 0; i < levelCount; ++i) {
+            const TextureLevel& level = levels[i];
+            const uint32_t blockRows = (level.height + blockDimension - 1) / blockDimension;
+            const VkDeviceSize rowSize = VkDeviceSize((level.width + blockDimension - 1) / blockDimension) * blockBytes;
+            const uint32_t rowsPerChunk = static_cast<uint32_t>(std::max<VkDeviceSize>(1, chunkLimit / rowSize));
+            for (uint32_t row = 0; row < blockRows; row += rowsPerChunk) {
+                if (!fitsStaging(head, rowSize * std::min(rowsPerChunk, blockRows - row))) {
+                    return false;
+                }
+            }
+        }
+    }
+    uploadImage(image, baseMipLevel, levelCount, data, levels, blockDimension, blockBytes, finalLayout, dstStageMask, dstAccessMask);
+    return true;
+}
+
+void UploadContext::initializeImage(VkImage image, uint32_t baseMipLevel, uint32_t levelCount, VkImageLayout layout,
+                                    VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask) {
+    recordingCommandBuffer();
+    addImageBarrier(image, baseMipLevel, levelCount, VK_IMAGE_LAYOUT_UNDEFINED, layout, dstStageMask, dstAccessMask);
+}
+
+UploadContext::Ticket UploadContext::flush() {
+    if (m_commandBuffer == VK_NULL_HANDLE) {
+        return m_lastValue;
+    }
+
+    VkDependencyInfo dependencyInfo{};
+    dependencyInfo.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+    dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(m_bufferBarriers.size());
+    dependencyInfo.pBufferMemoryBarriers = m_bufferBarriers.data();
+    dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(m_imageBarriers.size());
+    dependencyInfo.pImageMemoryBarriers = m_imageBarriers.data();
+    m_deviceTable->vkCmdPipelineBarrier2(m_commandBuffer, &dependencyInfo);
+    if (m_deviceTable->vkEndCommandBuffer(m_commandBuffer) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record upload command buffer!");
+    }
+
+    Batch batch{};
+    batch.transferCommandBuffer = m_commandBuffer;
+    batch.acquireCommandBuffer = VK_NULL_HANDLE;
+    batch.stagingEnd = m_stagingHead;
+
+    VkCommandBufferSubmitInfo commandBufferInfo{};
+    commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+    commandBufferInfo.commandBuffer = m_commandBuffer;
+
+    VkSemaphoreSubmitInfo signalInfo{};
+    signalInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+    signalInfo.semaphore = m_semaphore;
+    signalInfo.value = m_lastValue + 1;
+    signalInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+    VkSubmitInfo2 submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+    submitInfo.commandBufferInfoCount = 1;
+    submitInfo.pCommandBufferInfos = &commandBufferInfo;
+    submitInfo.signalSemaphoreInfoCount = 1;
+    submitInfo.pSignalSemaphoreInfos = &signalInfo;
+    if (m_deviceTable->vkQueueSubmit2(m_transferQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit upload command buffer!");
+    }
+    ++m_lastValue;
+
+    // 图形队列等待传输完成后获取所有权，再signal下一个值
+    if (!m_bufferAcquireBarriers.empty() || !m_imageAcquireBarriers.empty()) {
+        VkCommandBuffer acquireCommandBuffer = allocateCommandBuffer(m_graphicsCommandPool);
+        dependencyInfo.bufferMemoryBarrierCount = static_cast<uint32_t>(m_bufferAcquireBarriers.size());
+        dependencyInfo.pBufferMemoryBarriers = m_bufferAcquireBarriers.data();
+        dependencyInfo.imageMemoryBarrierCount = static_cast<uint32_t>(m_imageAcquireBarriers.size());
+        dependencyInfo.pImageMemoryBarriers = m_imageAcquireBarriers.data();
+        m_deviceTable->vkCmdPipelineBarrier2(acquireCommandBuffer, &dependencyInfo);
+        if (m_deviceTable->vkEndCommandBuffer(acquireCommandBuffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record upload command buffer!");
+        }
+        batch.acquireCommandBuffer = acquireCommandBuffer;
+
+        VkSemaphoreSubmitInfo waitInfo = signalInfo;
+        signalInfo.value = m_lastValue + 1;
+        commandBufferInfo.commandBuffer = acquireCommandBuffer;
+        submitInfo.waitSemaphoreInfoCount = 1;
+        submitInfo.pWaitSemaphoreInfos = &waitInfo;
+        if (m_deviceTable->vkQueueSubmit2(m_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+            throw std::runtime_error("failed to submit upload command buffer!");
+        }
+        ++m_lastValue;
+    }
+
+    batch.ticket = m_lastValue;
+    m_inFlight.push_back(std::move(batch));
+
+    m_commandBuffer = VK_NULL_HANDLE;
+    m_bufferBarriers.clear();
+    m_imageBarriers.clear();
+    m_bufferAcquireBarriers.clear();
+    m_imageAcquireBarriers.clear();
+    return m_lastValue;
+}
+
+bool UploadContext::isComplete(Ticket ticket) const {
+    uint64_t value = 0;
+    if (m_deviceTable->vkGetSemaphoreCounterValue(m_device, m_semaphore, &value) != VK_SUCCESS) {
+        throw std::runtime_error("failed to query upload timeline semaphore!");
+    }
+    return value >= ticket;
+}
+
+void UploadContext::wait(Ticket ticket) const {
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &m_semaphore;
+    waitInfo.pValues = &ticket;
+    if (m_deviceTable->vkWaitSemaphores(m_device, &waitInfo, UINT64_MAX) != VK_SUCCESS) {
+        throw std::runtime_error("failed to wait for upload timeline semaphore!");
+    }
+}
+
+void UploadContext::collect() {
+    if (m_inFlight.empty()) {
+        return;
+    }
+    uint64_t value = 0;
+    if (m_deviceTable->vkGetSemaphoreCounterValue(m_device, m_semaphore, &value) != VK_SUCCESS) {
+        throw std::runtime_error("failed to query upload timeline semaphore!");
+    }
+    // 批次按ticket递增的顺序完成
+    size_t completed = 0;
+    while (completed < m_inFlight.size() && m_inFlight[completed].ticket <= value) {
+        Batch& batch = m_inFlight[completed];
+        m_deviceTable->vkFreeCommandBuffers(m_device, m_transferCommandPool, 1, &batch.transferCommandBuffer);
+        if (batch.acquireCommandBuffer != VK_NULL_HANDLE) {
+            m_deviceTable->vkFreeCommandBuffers(m_device, m_graphicsCommandPool, 1, &batch.acquireCommandBuffer);
+        }
+        m_stagingTail = batch.stagingEnd;
+        ++completed;
+    }
+    m_inFlight.erase(m_inFlight.begin(), m_inFlight.begin() + completed);
+}
@@ -0,0 +1,108 @@
+#ifndef UPLOAD_CONTEXT_H
+#define UPLOAD_CONTEXT_H
+
+#include <cstdint>
+#include <vector>
+
+#include <vk_api.h>
+
+#include "texture_cache.h"
+
+// 批量上传：多次拷贝与布局转换录制到同一个命令缓冲区，flush()时一次提交并signal时间线信号量，不再vkQueueWaitIdle。
+// 设备有专用传输队列族时拷贝在传输队列上执行，再在图形队列上获取资源的所有权（队列族所有权转移屏障）。
+// 调用方拿到的ticket是时间线信号量的值，信号量达到该值时本批次的资源可以在图形队列上使用。
+//
+// 源数据经过一个持久映射的暂存环形缓冲：按提交顺序线性分配，批次完成（时间线信号量达到其ticket）后回收。
+// 单次上传不超过环形缓冲的一半时不会阻塞；更大的上传被拆成多块，空间不足时先提交当前批次，再等待最早的批次完成。
+// 只能在一个线程中使用
+class UploadContext {
+public:
+    using Ticket = uint64_t;
+
+    // transferQueueFamilyIdx与graphicsQueueFamilyIdx相同时只使用图形队列
+    void create(VkDevice device, const VolkDeviceTable& deviceTable, VmaAllocator allocator,
+                uint32_t graphicsQueueFamilyIdx, VkQueue graphicsQueue,
+                uint32_t transferQueueFamilyIdx, VkQueue transferQueue, VkDeviceSize stagingSize);
+    // 等待所有已提交的批次完成后释放全部资源
+    void destroy();
+
+    bool usesTransferQueue() const { return m_transferQueueFamilyIdx != m_graphicsQueueFamilyIdx; }
+    VkSemaphore semaphore() const { return m_semaphore; }
+    // 暂存环形缓冲的分配，用于显存统计
+    VmaAllocation stagingAllocation() const { return m_stagingAllocation; }
+
+    // 把data拷贝到dstBuffer的[dstOffset, dstOffset + size)，dstStageMask/dstAccessMask为之后在图形队列上首次使用时的阶段与访问方式
+    void uploadBuffer(VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* data, VkDeviceSize size,
+                      VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask);
+    // 图像的[baseMipLevel, baseMipLevel + levelCount)级从UNDEFINED转换为TRANSFER_DST_OPTIMAL，逐级拷贝后转换为finalLayout。
+    // levels[i]描述第baseMipLevel + i级在data中的位置；放不进一块的级别按块行拆分，blockDimension/blockBytes为格式的块尺寸
+    void uploadImage(VkImage image, uint32_t baseMipLevel, uint32_t levelCount, const uint8_t* data, const TextureLevel* levels,
+                     uint32_t blockDimension, uint32_t blockBytes,
+                     VkImageLayout finalLayout, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask);
+    // 与uploadImage()相同，但暂存空间不足、需要等待之前的批次完成时不录制任何命令并返回false，调用方可以留到之后再上传。
+    // 没有未完成的批次时（环形缓冲放不下整个图像）与uploadImage()一样分块上传并等待
+    bool tryUploadImage(VkImage image, uint32_t baseMipLevel, uint32_t levelCount, const uint8_t* data, const TextureLevel* levels,
+                        uint32_t blockDimension, uint32_t blockBytes,
+                        VkImageLayout finalLayout, VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask);
+    // 不上传数据，只把图像的若干级从UNDEFINED转换为layout（内容未定义）
+    void initializeImage(VkImage image, uint32_t baseMipLevel, uint32_t levelCount, VkImageLayout layout,
+                         VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask);
+
+    // 提交当前批次并返回它的ticket；没有待提交的命令时返回上一批次的ticket
+    Ticket flush();
+    bool isComplete(Ticket ticket) const;
+    void wait(Ticket ticket) const;
+    // 回收已完成批次的命令缓冲区与暂存空间
+    void collect();
+
+private:
+    struct Batch {
+        Ticket          ticket;
+        VkCommandBuffer transferCommandBuffer;
+        VkCommandBuffer acquireCommandBuffer; // 只在使用专用传输队列时有效
+        VkDeviceSize    stagingEnd;           // 本批次之前（含本批次）分配的暂存空间的结束位置
+    };
+
+    VkCommandBuffer allocateCommandBuffer(VkCommandPool commandPool);
+    VkCommandBuffer recordingCommandBuffer();
+    // 从head开始分配size字节不需要等待时把head推进到分配的结束位置并返回true
+    bool fitsStaging(VkDeviceSize& head, VkDeviceSize size) const;
+    // 在环形缓冲中分配size字节，返回相对缓冲起点的偏移
+    VkDeviceSize allocateStaging(VkDeviceSize size);
+    // 拷贝完成后的屏障，专用传输队列时拆成释放与获取两半
+    void addBufferBarrier(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+                          VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask);
+    void addImageBarrier(VkImage image, uint32_t baseMipLevel, uint32_t levelCount, VkImageLayout oldLayout, VkImageLayout finalLayout,
+                         VkPipelineStageFlags2 dstStageMask, VkAccessFlags2 dstAccessMask);
+
+    VkDevice                            m_device { VK_NULL_HANDLE };
+    const VolkDeviceTable*              m_deviceTable { nullptr };
+    VmaAllocator                        m_allocator { VK_NULL_HANDLE };
+    uint32_t                            m_graphicsQueueFamilyIdx { 0 };
+    uint32_t                            m_transferQueueFamilyIdx { 0 };
+    VkQueue                             m_graphicsQueue { VK_NULL_HANDLE };
+    VkQueue                             m_transferQueue { VK_NULL_HANDLE };
+    VkCommandPool                       m_transferCommandPool { VK_NULL_HANDLE };
+    VkCommandPool                       m_graphicsCommandPool { VK_NULL_HANDLE };
+    VkSemaphore                         m_semaphore { VK_NULL_HANDLE };
+    Ticket                              m_lastValue { 0 };     // 最后一次提交signal的值
+
+    // 暂存环形缓冲，m_stagingHead/m_stagingTail是单调递增的字节位置，对缓冲大小取模得到偏移
+    VkBuffer                            m_stagingBuffer { VK_NULL_HANDLE };
+    VmaAllocation                       m_stagingAllocation { VK_NULL_HANDLE };
+    uint8_t*                            m_stagingData { nullptr };
+    VkDeviceSize                        m_stagingSize { 0 };
+    VkDeviceSize                        m_stagingHead { 0 };
+    VkDeviceSize                        m_stagingTail { 0 };
+
+    // 正在录制的批次：拷贝后的屏障在flush()时一起录制
+    VkCommandBuffer                     m_commandBuffer { VK_NULL_HANDLE };
+    std::vector<VkBufferMemoryBarrier2> m_bufferBarriers;
+    std::vector<VkImageMemoryBarrier2>  m_imageBarriers;
+    std::vector<VkBufferMemoryBarrier2> m_bufferAcquireBarriers;
+    std::vector<VkImageMemoryBarrier2>  m_imageAcquireBarriers;
+
+    std::vector<Batch>                  m_inFlight;
+};
+
+#endif // UPLOAD_CONTEXT_H
@@ -0,0 +1,44 @@
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+#include <array>
+#include <cstdint>
+
+#include <vk_api.h>
+
+// 顶点格式中的一个属性：着色器location、VkFormat以及在顶点结构体中的偏移
+struct VertexAttribute {
+    uint32_t location;
+    VkFormat format;
+    uint32_t offset;
+};
+
+// 由顶点布局在编译期生成管线的顶点输入描述。Layout需要提供：
+//   using VertexType = ...;                                    // 顶点缓冲区中的顶点结构体
+//   static constexpr std::array<VertexAttribute, N> ATTRIBUTES; // 所有属性
+template <typename Layout>
+struct VertexInputDescription {
+    static constexpr uint32_t BINDING = 0; // vkCmdBindVertexBuffers绑定的绑定点
+    static constexpr size_t   ATTRIBUTE_COUNT = Layout::ATTRIBUTES.size();
+
+    static constexpr VkVertexInputBindingDescription getBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = BINDING;
+        bindingDescription.stride = static_cast<uint32_t>(sizeof(typename Layout::VertexType));
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescription;
+    }
+
+    static constexpr std::array<VkVertexInputAttributeDescription, ATTRIBUTE_COUNT> getAttributeDescriptions() {
+        std::array<VkVertexInputAttributeDescription, ATTRIBUTE_COUNT> attributeDescriptions{};
+        for (size_t i = 0; i < ATTRIBUTE_COUNT; ++i) {
+            attributeDescriptions[i].location = Layout::ATTRIBUTES[i].location;
+            attributeDescriptions[i].binding = BINDING;
+            attributeDescriptions[i].format = Layout::ATTRIBUTES[i].format;
+            attributeDescriptions[i].offset = Layout::ATTRIBUTES[i].offset;
+        }
+        return attributeDescriptions;
+    }
+};
+
+#endif // VERTEX_LAYOUT_H
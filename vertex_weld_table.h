@@ -0,0 +1,168 @@
+#ifndef VERTEX_WELD_TABLE_H
+#define VERTEX_WELD_TABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERTEX_WELD_USE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+// 64x64->128位乘法后高低位异或（wyhash的核心混合函数），每次混合16字节输入
+inline uint64_t weldMultiplyMix(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    uint64_t hi;
+    uint64_t lo = _umul128(a, b, &hi);
+    return lo ^ hi;
+#else
+    uint64_t ha = a >> 32, la = a & 0xFFFFFFFFULL;
+    uint64_t hb = b >> 32, lb = b & 0xFFFFFFFFULL;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+    return lo ^ hi;
+#endif
+}
+
+// 由float组成的顶点的哈希：先把-0.0规范化为+0.0（两者operator==相等，哈希也必须相等），再按16字节一组混合
+template <typename T>
+uint64_t hashFloatVertex(const T& key) {
+    static_assert(sizeof(T) % sizeof(float) == 0, "vertex must consist of 32-bit floats");
+    constexpr size_t WORD_COUNT = (sizeof(T) + 7) / 8;
+    uint64_t words[WORD_COUNT + 1] = {};
+    memcpy(words, &key, sizeof(T));
+
+#ifdef VERTEX_WELD_USE_SSE2
+    const __m128 zero = _mm_setzero_ps();
+    for (size_t i = 0; i + 2 <= WORD_COUNT; i += 2) {
+        __m128 v = _mm_loadu_ps(reinterpret_cast<const float*>(&words[i]));
+        v = _mm_and_ps(v, _mm_cmpneq_ps(v, zero)); // ±0 -> +0，其余（包括NaN）保持原值
+        _mm_storeu_ps(reinterpret_cast<float*>(&words[i]), v);
+    }
+    constexpr size_t SCALAR_BEGIN = WORD_COUNT & ~size_t{ 1 };
+#else
+    constexpr size_t SCALAR_BEGIN = 0;
+#endif
+    for (size_t i = SCALAR_BEGIN; i < WORD_COUNT; ++i) {
+        uint32_t lanes[2];
+        memcpy(lanes, &words[i], sizeof(lanes));
+        for (auto& lane : lanes) {
+            if (lane == 0x80000000u) {
+                lane = 0;
+            }
+        }
+        memcpy(&words[i], lanes, sizeof(lanes));
+    }
+
+    constexpr uint64_t SECRET0 = 0xa0761d6478bd642fULL;
+    constexpr uint64_t SECRET1 = 0xe7037ed1a0b428dbULL;
+    uint64_t h = sizeof(T) ^ SECRET0;
+    for (size_t i = 0; i < WORD_COUNT; i += 2) {
+        h = weldMultiplyMix(words[i] ^ SECRET0 ^ h, words[i + 1] ^ SECRET1);
+    }
+    return weldMultiplyMix(h ^ SECRET1, sizeof(T) ^ SECRET0);
+}
+
+template <typename T>
+struct FloatVertexHash {
+    uint64_t operator()(const T& key) const { return hashFloatVertex(key); }
+};
+
+// 面向顶点焊接的开放寻址哈希表（线性探测）。
+// 表内只存放 {哈希标签, 值}，键本身保存在调用者的数组中，通过 keyAt(value) 取回用于比较；
+// 因此插入不会为每个唯一顶点单独分配内存，一次探测即可完成“查找或插入”。
+class VertexWeldTable {
+public:
+    static constexpr uint32_t EMPTY = 0xFFFFFFFFu;
+
+    // 按预计的唯一顶点数量一次性分配，保证负载因子不超过 3/4
+    void reserve(size_t expectedCount) {
+        size_t capacity = 16;
+        while (capacity * 3 / 4 < expectedCount) {
+            capacity *= 2;
+        }
+        if (capacity > m_slots.size()) {
+            m_slots.assign(capacity, Slot{ 0, EMPTY });
+            m_size = 0;
+        }
+    }
+
+    void clear() {
+        std::fill(m_slots.begin(), m_slots.end(), Slot{ 0, EMPTY });
+        m_size = 0;
+    }
+
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_slots.size(); }
+
+    // 查找与key相等的条目；不存在时以newValue插入。返回 {条目的值, 是否新插入}
+    // keyAt(value) 必须返回与 value 对应的键，hasher 仅在扩容重排时使用
+    template <typename Key, typename KeyAt, typename Hasher>
+    std::pair<uint32_t, bool> findOrInsert(const Key& key, uint64_t hash, uint32_t newValue,
+                                           const KeyAt& keyAt, const Hasher& hasher) {
+        if ((m_size + 1) * 4 > m_slots.size() * 3) {
+            grow(keyAt, hasher);
+        }
+
+        const size_t mask = m_slots.size() - 1;
+        const uint32_t tag = static_cast<uint32_t>(hash >> 32);
+        size_t slot = static_cast<size_t>(hash) & mask;
+        for (;;) {
+            Slot& entry = m_slots[slot];
+            if (entry.value == EMPTY) {
+                entry.tag = tag;
+                entry.value = newValue;
+                ++m_size;
+                return { newValue, true };
+            }
+            if (entry.tag == tag && keyAt(entry.value) == key) {
+                return { entry.value, false };
+            }
+            slot = (slot + 1) & mask;
+        }
+    }
+
+private:
+    struct Slot {
+        uint32_t tag;
+        uint32_t value;
+    };
+
+    template <typename KeyAt, typename Hasher>
+    void grow(const KeyAt& keyAt, const Hasher& hasher) {
+        std::vector<Slot> old = std::move(m_slots);
+        m_slots.assign(old.empty() ? 16 : old.size() * 2, Slot{ 0, EMPTY });
+        const size_t mask = m_slots.size() - 1;
+        for (const Slot& entry : old) {
+            if (entry.value == EMPTY) {
+                continue;
+            }
+            const uint64_t hash = hasher(keyAt(entry.value));
+            size_t slot = static_cast<size_t>(hash) & mask;
+            while (m_slots[slot].value != EMPTY) {
+                slot = (slot + 1) & mask;
+            }
+            m_slots[slot] = entry;
+        }
+    }
+
+    std::vector<Slot> m_slots;
+    size_t            m_size { 0 };
+};
+
+#endif // VERTEX_WELD_TABLE_H